@@ -8,7 +8,7 @@ INCLUDEPATH += \
 
 QMAKE_CXX = ccache g++
 #QMAKE_CXX = g++
-QMAKE_CXXFLAGS += -std=c++0x -fopenmp -march=native -mtune=native -DEIGEN_NO_DEBUG
+QMAKE_CXXFLAGS += -std=c++0x -fopenmp -march=native -mtune=native -DEIGEN_NO_DEBUG -DGL_GLEXT_PROTOTYPES
 
 OBJECTS_DIR += tmp
 
@@ -34,6 +34,14 @@ HEADERS += \
     $${TGL_LIB}/tglCore/Renderer2D.h \
     $${TGL_LIB}/tglCore/Renderer3D.h \
     $${TGL_LIB}/tglCore/TextRenderer.h \
+    $${TGL_LIB}/tglCore/FontRegistry.h \
+    $${TGL_LIB}/tglCore/UnitCircleTable.h \
+    $${TGL_LIB}/tglCore/UnitPrimitiveMeshes.h \
+    $${TGL_LIB}/tglCore/DepthReadback.h \
+    $${TGL_LIB}/tglCore/TriangleMesh.h \
+    $${TGL_LIB}/tglCore/VertexQuantization.h \
+    $${TGL_LIB}/tglCore/CompactPointCloud.h \
+    $${TGL_LIB}/tglCore/ResourceLoader.h \
     $${TGL_LIB}/tglCore/SphericalCamera.h \
     $${TGL_LIB}/tglCore/StandardCamera.h \
     $${TGL_LIB}/tglCore/GraphicsDriver.h
@@ -48,6 +56,14 @@ SOURCES += \
     $${TGL_LIB}/tglCore/Renderer2D.cpp \
     $${TGL_LIB}/tglCore/Renderer3D.cpp \
     $${TGL_LIB}/tglCore/TextRenderer.cpp \
+    $${TGL_LIB}/tglCore/FontRegistry.cpp \
+    $${TGL_LIB}/tglCore/UnitCircleTable.cpp \
+    $${TGL_LIB}/tglCore/UnitPrimitiveMeshes.cpp \
+    $${TGL_LIB}/tglCore/DepthReadback.cpp \
+    $${TGL_LIB}/tglCore/TriangleMesh.cpp \
+    $${TGL_LIB}/tglCore/VertexQuantization.cpp \
+    $${TGL_LIB}/tglCore/CompactPointCloud.cpp \
+    $${TGL_LIB}/tglCore/ResourceLoader.cpp \
     $${TGL_LIB}/tglCore/SphericalCamera.cpp \
     $${TGL_LIB}/tglCore/StandardCamera.cpp \
     $${TGL_LIB}/tglCore/GraphicsDriver.cpp
@@ -71,11 +87,22 @@ SOURCES += \
 HEADERS += \
     $${TGL_LIB}/tglUtil/SE3.h \
     $${TGL_LIB}/tglUtil/EigenUtil.h \
-    $${TGL_LIB}/tglUtil/Intersection.h
+    $${TGL_LIB}/tglUtil/Intersection.h \
+    $${TGL_LIB}/tglUtil/BatchIntersection.h \
+    $${TGL_LIB}/tglUtil/RectQuadTree.h \
+    $${TGL_LIB}/tglUtil/SE3Group.h \
+    $${TGL_LIB}/tglUtil/TransformPool.h \
+    $${TGL_LIB}/tglUtil/ThreadPool.h \
+    $${TGL_LIB}/tglUtil/ChangeNotifier.h
     
 SOURCES += \
     $${TGL_LIB}/tglUtil/EigenUtil.cpp \
-    $${TGL_LIB}/tglUtil/Intersection.cpp
+    $${TGL_LIB}/tglUtil/Intersection.cpp \
+    $${TGL_LIB}/tglUtil/BatchIntersection.cpp \
+    $${TGL_LIB}/tglUtil/RectQuadTree.cpp \
+    $${TGL_LIB}/tglUtil/SE3Group.cpp \
+    $${TGL_LIB}/tglUtil/TransformPool.cpp \
+    $${TGL_LIB}/tglUtil/ThreadPool.cpp
     
 # tglHandle
 HEADERS += \
@@ -86,6 +113,23 @@ SOURCES += \
     $${TGL_LIB}/tglHandle/RotateHandle.cpp \
     $${TGL_LIB}/tglHandle/TranslateHandle.cpp
     
+# tglMesh
+HEADERS += \
+    $${TGL_LIB}/tglMesh/MeshLoader.h \
+    $${TGL_LIB}/tglMesh/MeshSimplifier.h \
+    $${TGL_LIB}/tglMesh/MeshLod.h \
+    $${TGL_LIB}/tglMesh/MeshOptimizer.h \
+    $${TGL_LIB}/tglMesh/MeshResource.h \
+    $${TGL_LIB}/tglMesh/MeshItem.h
+    
+SOURCES += \
+    $${TGL_LIB}/tglMesh/MeshLoader.cpp \
+    $${TGL_LIB}/tglMesh/MeshSimplifier.cpp \
+    $${TGL_LIB}/tglMesh/MeshLod.cpp \
+    $${TGL_LIB}/tglMesh/MeshOptimizer.cpp \
+    $${TGL_LIB}/tglMesh/MeshResource.cpp \
+    $${TGL_LIB}/tglMesh/MeshItem.cpp
+    
 LIBS += \
     -lboost_filesystem \
     -lboost_system \
@@ -19,6 +19,9 @@ public:
 		color_ = {{1,0,0,1}};
 		pressCount_ = 0;
 		setName("Item");
+		setAcceptHoverEvents(true);
+		setAcceptMouseEvents(true);
+		setSelectPicking2D(false);	// drawn in 3D only
 
 		std::random_device rd;
 		std::mt19937 mt(rd());
@@ -2,10 +2,14 @@
  * Camera.cpp
  */
 
+#include <cmath>
+#include <algorithm>
 #include <GL/gl.h>
 #include <GL/glu.h>
+#include <Eigen/LU>
 
 #include "tglUtil/EigenUtil.h"
+#include "DepthReadback.h"
 #include "Camera.h"
 #include "InputEvent.h"
 
@@ -18,6 +22,14 @@ Camera::Camera() {
 	p_.setZero();
 	R_.setIdentity();
 	Rt_.setIdentity();
+
+	view_.setIdentity();
+	projection_.setIdentity();
+	viewport_ = {{0, 0, 1, 1}};
+
+	damping_ = 3.0;
+	velocity_[0] = velocity_[1] = 0.0;
+	moveTime_ = std::chrono::steady_clock::now();
 }
 
 Camera::~Camera() {
@@ -34,21 +46,91 @@ void Camera::initializeConfiguration()
 
 void Camera::update()
 {
-	glMatrixMode (GL_MODELVIEW);
-	glLoadIdentity();
+	// Rz(90) Ry(90) Rx(-roll) Ry(-pitch) Rz(-yaw) T(-p)
+	Eigen::Vector3d rpy = tgl::rpyFromRot(R_);
 
-	glRotatef (90, 0,0,1);
-	glRotatef (90, 0,1,0);
+	Eigen::Matrix3d R = rotationZ(M_PI/2) * rotationY(M_PI/2)
+			* rotationX(-rpy[0]) * rotationY(-rpy[1]) * rotationZ(-rpy[2]);
 
-	Eigen::Vector3d rpy = tgl::rpyFromRot(R_);
+	setViewMatrix(R, -R * p_);
+	loadViewMatrix();
+}
+
+void Camera::setViewMatrix(const Eigen::Matrix3d& R, const Eigen::Vector3d& t)
+{
+	view_.setIdentity();
+	view_.topLeftCorner<3,3>() = R;
+	view_.topRightCorner<3,1>() = t;
+}
+
+void Camera::loadViewMatrix() const
+{
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixd(view_.data());
+}
 
-	double r2d = 180/M_PI;
-	glRotatef (-rpy[0]*r2d, 1,0,0);
-	glRotatef (-rpy[1]*r2d, 0,1,0);
-	glRotatef (-rpy[2]*r2d, 0,0,1);
+void Camera::setViewport(int x, int y, int width, int height)
+{
+	viewport_ = {{x, y, width, height}};
+}
 
-	glTranslatef (-p_[0], -p_[1], -p_[2]);
+// same as gluPerspective
+void Camera::setPerspective(double fovy, double aspect, double znear, double zfar)
+{
+	const double f = 1.0 / tan(fovy * M_PI / 360.0);
+
+	projection_.setZero();
+	projection_(0,0) = f / aspect;
+	projection_(1,1) = f;
+	projection_(2,2) = (zfar + znear) / (znear - zfar);
+	projection_(2,3) = 2.0 * zfar * znear / (znear - zfar);
+	projection_(3,2) = -1.0;
+}
 
+void Camera::beginThrow()
+{
+	velocity_[0] = velocity_[1] = 0.0;
+	moveTime_ = std::chrono::steady_clock::now();
+}
+
+void Camera::trackThrow(double dx, double dy)
+{
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double dt = std::chrono::duration<double>(now - moveTime_).count();
+	moveTime_ = now;
+
+	// events may come in bursts, average them
+	dt = std::max(dt, 1.0/240.0);
+	velocity_[0] = 0.5 * velocity_[0] + 0.5 * dx / dt;
+	velocity_[1] = 0.5 * velocity_[1] + 0.5 * dy / dt;
+}
+
+bool Camera::endThrow()
+{
+	// the pointer stopped before the release
+	const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - moveTime_).count();
+	if (dt > 0.1) {
+		velocity_[0] = velocity_[1] = 0.0;
+		return false;
+	}
+	return velocity_[0] != 0.0 || velocity_[1] != 0.0;
+}
+
+bool Camera::dampThrow(double dt)
+{
+	const double decay = exp(-damping_ * dt);
+	velocity_[0] *= decay;
+	velocity_[1] *= decay;
+
+	// below 1 pixel per second
+	return velocity_[0]*velocity_[0] + velocity_[1]*velocity_[1] > 1.0;
+}
+
+double Camera::smoothStep(double t)
+{
+	if (t <= 0.0) return 0.0;
+	if (t >= 1.0) return 1.0;
+	return t * t * (3.0 - 2.0 * t);
 }
 
 void Camera::mousePressEvent(MouseEvent* /* e */)
@@ -74,7 +156,7 @@ void Camera::wheelEvent(WheelEvent* /* e */)
 void Camera::updateProject()
 {
 	//モデルビュー行列取得
-	glGetDoublev(GL_MODELVIEW_MATRIX, modelview_.data());
+	glGetDoublev(GL_MODELVIEW_MATRIX, view_.data());
 
 	//透視投影行列取得
 	glGetDoublev(GL_PROJECTION_MATRIX, projection_.data());
@@ -84,11 +166,13 @@ void Camera::updateProject()
 }
 
 // object -> window
-Eigen::Vector3d Camera::project(double x, double y, double z)
+Eigen::Vector3d Camera::project(double x, double y, double z) const
 {
-	double winX, winY, winZ;//ウィンドウ座標格納用
+	Eigen::Vector4d clip = projection_ * (view_ * Eigen::Vector4d(x, y, z, 1.0));
+	if (clip(3) == 0.0) return Eigen::Vector3d::Zero();
 
-	gluProject(x, y, z, modelview_.data(), projection_.data(), viewport_.data(), &winX, &winY, &winZ); //座標変換の計算
+	double winX = viewport_[0] + viewport_[2] * (clip(0) / clip(3) + 1.0) * 0.5;
+	double winY = viewport_[1] + viewport_[3] * (clip(1) / clip(3) + 1.0) * 0.5;
 
 	return Eigen::Vector3d(winX, winY, 0.0);
 }
@@ -101,21 +185,21 @@ Eigen::Vector3d Camera::unProject(int x, int y)
 	double objY;
 	double objZ;
 
-	glReadPixels(x, y, 1,1,GL_DEPTH_COMPONENT,GL_FLOAT,&z);
-	gluUnProject(x, y, z,modelview_.data(), projection_.data(), viewport_.data(), &objX, &objY, &objZ);
+	if (!depthReadback_ || !depthReadback_->depth(x, y, z)) {
+		glReadPixels(x, y, 1,1,GL_DEPTH_COMPONENT,GL_FLOAT,&z);
+	}
+	gluUnProject(x, y, z, view_.data(), projection_.data(), viewport_.data(), &objX, &objY, &objZ);
 
 	return Eigen::Vector3d(objX, objY, objZ);
 }
 
 // object -> window
-Eigen::Vector3d Camera::project2D(double x, double y, double z)
+Eigen::Vector3d Camera::project2D(double x, double y, double z) const
 {
-	double winX, winY, winZ;//ウィンドウ座標格納用
-
-	gluProject(x, y, z, modelview_.data(), projection_.data(), viewport_.data(), &winX, &winY, &winZ); //座標変換の計算
+	Eigen::Vector3d win = project(x, y, z);
 
 	int h = viewport_[3];
-	return Eigen::Vector3d(winX, h - winY, 0.0);
+	return Eigen::Vector3d(win(0), h - win(1), 0.0);
 }
 
 // window -> object
@@ -128,11 +212,63 @@ Eigen::Vector3d Camera::unProject2D(int x, int y)
 	double objY;
 	double objZ;
 
-	glReadPixels(x, y, 1,1,GL_DEPTH_COMPONENT,GL_FLOAT,&z);
+	if (!depthReadback_ || !depthReadback_->depth(x, y, z)) {
+		glReadPixels(x, y, 1,1,GL_DEPTH_COMPONENT,GL_FLOAT,&z);
+	}
 
-	gluUnProject(x, y, z,modelview_.data(), projection_.data(), viewport_.data(), &objX, &objY, &objZ);
+	gluUnProject(x, y, z, view_.data(), projection_.data(), viewport_.data(), &objX, &objY, &objZ);
 
 	return Eigen::Vector3d(objX, objY, objZ);
 }
 
+void Camera::unProjectRay(int x, int y, Eigen::Vector3d& origin, Eigen::Vector3d& direction) const
+{
+	Eigen::Matrix2Xd window(2, 1);
+	window << x, y;
+
+	Eigen::Matrix3Xd origins, directions;
+	unprojectRays(window, origins, directions);
+
+	origin = origins.col(0);
+	direction = directions.col(0);
+}
+
+void Camera::projectMany(const Eigen::Matrix3Xd& points, Eigen::Matrix3Xd& windows) const
+{
+	const Eigen::Matrix4d M = projection_ * view_;
+
+	// clip coordinates of all points at once
+	Eigen::Matrix4Xd clip = M.leftCols<3>() * points;
+	clip.colwise() += M.col(3);
+
+	const Eigen::ArrayXXd w = clip.row(3).array().inverse();
+	windows.resize(3, points.cols());
+	windows.row(0) = viewport_[0] + viewport_[2] * (clip.row(0).array() * w + 1.0) * 0.5;
+	windows.row(1) = viewport_[3] - (viewport_[1] + viewport_[3] * (clip.row(1).array() * w + 1.0) * 0.5);
+	windows.row(2) = (clip.row(2).array() * w + 1.0) * 0.5;
+}
+
+void Camera::unprojectRays(const Eigen::Matrix2Xd& windows, Eigen::Matrix3Xd& origins, Eigen::Matrix3Xd& directions) const
+{
+	const Eigen::Matrix4d inv = (projection_ * view_).inverse();
+	// normalized device coordinates
+	Eigen::Matrix4Xd ndc(4, windows.cols());
+	ndc.row(0) = (windows.row(0).array() - viewport_[0]) * (2.0 / viewport_[2]) - 1.0;
+	ndc.row(1) = (viewport_[3] - windows.row(1).array() - viewport_[1]) * (2.0 / viewport_[3]) - 1.0;
+	ndc.row(3).setOnes();
+
+	// near and far planes
+	ndc.row(2).setConstant(-1.0);
+	Eigen::Matrix4Xd nearPoints = inv * ndc;
+	ndc.row(2).setConstant(1.0);
+	Eigen::Matrix4Xd farPoints = inv * ndc;
+
+	origins = nearPoints.topRows<3>().array().rowwise() / nearPoints.row(3).array();
+	directions = farPoints.topRows<3>().array().rowwise() / farPoints.row(3).array();
+	directions -= origins;
+	for (int i = 0; i < directions.cols(); ++i) {
+		directions.col(i).normalize();
+	}
+}
+
 } /* namespace tgl */
@@ -7,18 +7,22 @@
 
 #include <memory>
 #include <array>
+#include <chrono>
 #include <Eigen/Core>
 
 namespace tgl {
 
 class MouseEvent;
 class WheelEvent;
+class DepthReadback;
 
 class Camera;
 typedef std::shared_ptr<Camera> CameraPtr;
 
 class Camera {
 public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 	Camera();
 	virtual ~Camera();
 
@@ -33,36 +37,92 @@ public:
 	const Eigen::Matrix3d& inverseRotation() const { return Rt_; }
 
 	// object -> window
-	Eigen::Vector3d project(double x, double y, double z);
+	Eigen::Vector3d project(double x, double y, double z) const;
 
-	// window -> object
+	// window -> object at the depth of the scene
 	Eigen::Vector3d unProject(int x, int y);
 
 	// object -> window
-	Eigen::Vector3d project2D(double x, double y, double z);
+	Eigen::Vector3d project2D(double x, double y, double z) const;
 
-	// window -> object
+	// window -> object at the depth of the scene
 	Eigen::Vector3d unProject2D(int x, int y);
 
+	// window (x, y from the top left) -> ray from the near plane with a unit direction. reads no depth
+	void unProjectRay(int x, int y, Eigen::Vector3d& origin, Eigen::Vector3d& direction) const;
+
+	// depth of the previous frame for unProject. without it the depth is read synchronously
+	void setDepthReadback(const std::shared_ptr<DepthReadback>& depth) { depthReadback_ = depth; }
+
+	// batched, without GL
+	// object points (3 x n) -> window (x, y from the top left, depth [0, 1]) (3 x n)
+	void projectMany(const Eigen::Matrix3Xd& points, Eigen::Matrix3Xd& windows) const;
+
+	// window points (x, y from the top left) (2 x n) -> rays from the near plane, unit directions (3 x n)
+	void unprojectRays(const Eigen::Matrix2Xd& windows, Eigen::Matrix3Xd& origins, Eigen::Matrix3Xd& directions) const;
+
+	// matrices computed on the CPU
+	const Eigen::Matrix4d& viewMatrix() const { return view_; }
+	const Eigen::Matrix4d& projectionMatrix() const { return projection_; }
+	const std::array<int, 4>& viewport() const { return viewport_; }
+
+	void setViewport(int x, int y, int width, int height);
+	void setPerspective(double fovy, double aspect, double znear, double zfar);
+	void setProjectionMatrix(const Eigen::Matrix4d& projection) { projection_ = projection; }
+
+	// GL_MODELVIEW <- view matrix
+	void loadViewMatrix() const;
+
 	virtual void initializeConfiguration();
 
+	// updates the view matrix and loads it
 	virtual void update();
 
+	// time based animation (thrown motion, flyTo ...).
+	// called by GraphicsView before update() with the seconds since the last frame
+	virtual void advance(double /* dt */) {}
+
+	// true while the camera moves without input. the view keeps drawing meanwhile
+	virtual bool isAnimating() const { return false; }
+
+	// decay rate [1/s] of the thrown motion
+	void setDamping(double damping) { damping_ = damping; }
+	double damping() const { return damping_; }
+
 	virtual void mousePressEvent(MouseEvent* e);
 	virtual void mouseMoveEvent(MouseEvent* e);
 	virtual void mouseReleaseEvent(MouseEvent* e);
 	virtual void wheelEvent(WheelEvent* e);
 
+	// reads the matrices back from GL. only needed when they are set by other than the camera
 	void updateProject();
 
 protected:
+	// view_ = [R t; 0 1]
+	void setViewMatrix(const Eigen::Matrix3d& R, const Eigen::Vector3d& t);
+
+	// pointer velocity [pixels/s] for the thrown motion
+	void beginThrow();
+	void trackThrow(double dx, double dy);
+	bool endThrow();				// true if the pointer was still moving at the release
+	bool dampThrow(double dt);		// false when the motion has stopped
+
+	// 0 -> 1 with zero slope at both ends
+	static double smoothStep(double t);
+
 	Eigen::Vector3d p_;
 	Eigen::Matrix3d R_;
 	Eigen::Matrix3d Rt_;
 
-	std::array<double, 16> modelview_;
-	std::array<double, 16> projection_;
+	Eigen::Matrix4d view_;
+	Eigen::Matrix4d projection_;
 	std::array<int, 4> viewport_;
+
+	std::shared_ptr<DepthReadback> depthReadback_;
+
+	double damping_;
+	double velocity_[2];
+	std::chrono::steady_clock::time_point moveTime_;
 };
 
 } /* namespace tgl */
@@ -0,0 +1,169 @@
+/*
+ * CompactPointCloud.cpp
+ */
+
+#include <algorithm>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "VertexQuantization.h"
+#include "TriangleMesh.h"
+#include "CompactPointCloud.h"
+
+namespace tgl {
+
+const size_t CompactPointCloud::MaxChunkSize;	// bound to references by std::min
+
+CompactPointCloud::CompactPointCloud()
+{
+	numPoints_ = 0;
+	chunkSize_ = MaxChunkSize;
+	hasNormals_ = false;
+	hasColors_ = false;
+	revision_ = 0;
+}
+
+CompactPointCloud::~CompactPointCloud()
+{
+	for (const auto& entry : buffers_) {
+		TriangleMesh::releaseBuffers(entry.first, entry.second.contextSerial, entry.second.chunkBuffers);
+	}
+}
+
+void CompactPointCloud::setPoints(const double* positions, size_t n, const float* normals, const float* colors, size_t chunkSize)
+{
+	clear();
+	if (!positions || n == 0) return;
+
+	chunkSize_ = std::max<size_t>(1, std::min(chunkSize, MaxChunkSize));
+	hasNormals_ = normals != nullptr;
+	hasColors_ = colors != nullptr;
+	numPoints_ = n;
+
+	chunks_.resize((n + chunkSize_ - 1) / chunkSize_);
+	for (size_t c = 0; c < chunks_.size(); ++c) {
+		Chunk& chunk = chunks_[c];
+		const size_t begin = c * chunkSize_;
+		const size_t count = std::min(chunkSize_, n - begin);
+		const double* p = positions + 3 * begin;
+
+		Eigen::Map<const Eigen::Matrix3Xd> P(p, 3, count);
+		VertexQuantization::boxQuantization(P.rowwise().minCoeff(), P.rowwise().maxCoeff(), chunk.offset, chunk.scale);
+
+		chunk.positions.resize(3 * count);
+		VertexQuantization::quantizePositions(p, count, chunk.offset, chunk.scale, chunk.positions.data());
+		if (normals) {
+			chunk.normals.resize(2 * count);
+			VertexQuantization::encodeOctahedral(normals + 3 * begin, count, chunk.normals.data());
+		}
+		if (colors) {
+			chunk.colors.resize(4 * count);
+			VertexQuantization::packColors(colors + 4 * begin, count, chunk.colors.data());
+		}
+	}
+}
+
+void CompactPointCloud::clear()
+{
+	chunks_.clear();
+	numPoints_ = 0;
+	hasNormals_ = false;
+	hasColors_ = false;
+	++revision_;
+}
+
+Eigen::Vector3d CompactPointCloud::position(size_t i) const
+{
+	const Chunk& chunk = chunks_[i / chunkSize_];
+	const int16_t* q = &chunk.positions[3 * (i % chunkSize_)];
+	return chunk.offset + chunk.scale.cwiseProduct(Eigen::Vector3d(q[0], q[1], q[2]));
+}
+
+size_t CompactPointCloud::bytes() const
+{
+	size_t bytes = 0;
+	for (const Chunk& chunk : chunks_) {
+		bytes += chunk.positions.size() * sizeof(int16_t) + chunk.normals.size() + chunk.colors.size();
+	}
+	return bytes;
+}
+
+namespace {
+
+// blocks start on 4 bytes
+size_t positionBytes(size_t n)
+{
+	return (n * 3 * sizeof(int16_t) + 3) & ~size_t(3);
+}
+
+}
+
+// positions | normals x,y,z,0 | colors in one buffer
+void CompactPointCloud::uploadChunk(const Chunk& chunk) const
+{
+	const size_t n = chunk.size();
+	const size_t normalOffset = positionBytes(n);
+	const size_t colorOffset = normalOffset + (hasNormals_ ? 4 * n : 0);
+	glBufferData(GL_ARRAY_BUFFER, colorOffset + (hasColors_ ? 4 * n : 0), nullptr, GL_STATIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, n * 3 * sizeof(int16_t), chunk.positions.data());
+	if (hasNormals_) {
+		// GL has no octahedral normals, decoded once here
+		std::vector<int8_t> normals(4 * n);
+		VertexQuantization::decodeOctahedral(chunk.normals.data(), n, normals.data());
+		glBufferSubData(GL_ARRAY_BUFFER, normalOffset, normals.size(), normals.data());
+	}
+	if (hasColors_) {
+		glBufferSubData(GL_ARRAY_BUFFER, colorOffset, chunk.colors.size(), chunk.colors.data());
+	}
+}
+
+void CompactPointCloud::drawChunks(ContextKey context)
+{
+	if (chunks_.empty()) return;
+
+	const unsigned int serial = TriangleMesh::contextSerial(context);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	Buffers& buffers = buffers_[context];	// empty for a new context
+	if (buffers.chunkBuffers.empty() || buffers.contextSerial != serial || buffers.revision != revision_) {
+		if (!buffers.chunkBuffers.empty() && buffers.contextSerial == serial) {
+			glDeleteBuffers(static_cast<GLsizei>(buffers.chunkBuffers.size()), buffers.chunkBuffers.data());
+		}
+		buffers.chunkBuffers.assign(chunks_.size(), 0);
+		glGenBuffers(static_cast<GLsizei>(chunks_.size()), buffers.chunkBuffers.data());
+		for (size_t i = 0; i < chunks_.size(); ++i) {
+			glBindBuffer(GL_ARRAY_BUFFER, buffers.chunkBuffers[i]);
+			uploadChunk(chunks_[i]);
+		}
+		buffers.revision = revision_;
+		buffers.contextSerial = serial;
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if (hasNormals_) glEnableClientState(GL_NORMAL_ARRAY);
+	if (hasColors_) glEnableClientState(GL_COLOR_ARRAY);
+
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		const Chunk& chunk = chunks_[i];
+		const size_t n = chunk.size();
+		if (n == 0) continue;
+
+		const size_t normalOffset = positionBytes(n);
+		const size_t colorOffset = normalOffset + (hasNormals_ ? 4 * n : 0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, buffers.chunkBuffers[i]);
+		glVertexPointer(3, GL_SHORT, 0, nullptr);
+		if (hasNormals_) glNormalPointer(GL_BYTE, 4, reinterpret_cast<const GLvoid*>(normalOffset));
+		if (hasColors_) glColorPointer(4, GL_UNSIGNED_BYTE, 0, reinterpret_cast<const GLvoid*>(colorOffset));
+
+		// positions decoded in the vertex stage
+		glPushMatrix();
+		glTranslated(chunk.offset.x(), chunk.offset.y(), chunk.offset.z());
+		glScaled(chunk.scale.x(), chunk.scale.y(), chunk.scale.z());
+		glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(n));
+		glPopMatrix();
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+} /* namespace tgl */
@@ -0,0 +1,90 @@
+/*
+ * CompactPointCloud.h
+ */
+
+#ifndef TGL_CORE_COMPACTPOINTCLOUD_H_
+#define TGL_CORE_COMPACTPOINTCLOUD_H_
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <Eigen/Core>
+#include <GL/gl.h>
+
+namespace tgl {
+
+class CompactPointCloud;
+typedef std::shared_ptr<CompactPointCloud> CompactPointCloudPtr;
+
+// Points stored in quantized chunks (VertexQuantization), drawn by Renderer3D::drawPointCloud.
+// 6 bytes per position in the box of its chunk, 2 per normal and 4 per color:
+// 12 bytes a point instead of 24 for double x,y,z alone.
+// chunks follow the order of the points, scans in their order keep the boxes small.
+// the precision of a chunk is its largest extent / 65535.
+// each chunk is uploaded to a buffer object once per GL context group, on the first draw,
+// with its normals decoded. setting the points again uploads them again
+class CompactPointCloud {
+public:
+	typedef const void* ContextKey;
+
+	static const size_t MaxChunkSize = 65536;
+
+	struct Chunk {
+		size_t size() const { return positions.size() / 3; }
+
+		Eigen::Vector3d offset;			// x = offset + scale * q
+		Eigen::Vector3d scale;			// the same on all axes
+		std::vector<int16_t> positions;	// x,y,z
+		std::vector<int8_t> normals;	// octahedral, 2 per point. may be empty
+		std::vector<uint8_t> colors;	// r,g,b,a. may be empty
+	};
+
+	CompactPointCloud();
+	virtual ~CompactPointCloud();
+
+	// x,y,z per point. normals x,y,z and colors r,g,b,a (0..1) are optional (nullptr)
+	void setPoints(const double* positions, size_t n, const float* normals = nullptr, const float* colors = nullptr, size_t chunkSize = MaxChunkSize);
+	void clear();
+
+	size_t numPoints() const { return numPoints_; }
+	bool hasNormals() const { return hasNormals_; }
+	bool hasColors() const { return hasColors_; }
+	const std::vector<Chunk>& chunks() const { return chunks_; }
+
+	// x,y,z of a point, decoded
+	Eigen::Vector3d position(size_t i) const;
+
+	size_t bytes() const;
+
+	// GL, on the render thread of the context. sets the client arrays and draws every chunk
+	// with its offset and scale on the modelview, uploading if needed
+	void drawChunks(ContextKey context);
+
+private:
+	CompactPointCloud(const CompactPointCloud&) = delete;
+	CompactPointCloud& operator=(const CompactPointCloud&) = delete;
+
+	void uploadChunk(const Chunk& chunk) const;
+
+	std::vector<Chunk> chunks_;
+	size_t numPoints_;
+	size_t chunkSize_;
+	bool hasNormals_;
+	bool hasColors_;
+	unsigned int revision_;
+
+	struct Buffers {
+		std::vector<GLuint> chunkBuffers;
+		unsigned int revision;
+		unsigned int contextSerial;
+	};
+
+	std::mutex mutex_;
+	std::map<ContextKey, Buffers> buffers_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_COMPACTPOINTCLOUD_H_ */
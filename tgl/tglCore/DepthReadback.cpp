@@ -0,0 +1,126 @@
+/*
+ * DepthReadback.cpp
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "DepthReadback.h"
+
+namespace tgl {
+
+namespace {
+// pixels read around the asked ones, the cursor may move this far in a frame
+const int windowMargin = 32;
+}
+
+DepthReadback::DepthReadback()
+{
+	const Window empty = {0, 0, 0, 0};
+	for (int i = 0; i < 2; ++i) {
+		buffers_[i] = 0;
+		capacity_[i] = 0;
+		windows_[i] = empty;
+		pending_[i] = false;
+	}
+	index_ = 0;
+
+	depthWindow_ = empty;
+	window_ = empty;
+	requested_ = false;
+	requestMin_[0] = requestMin_[1] = 0;
+	requestMax_[0] = requestMax_[1] = 0;
+
+	maxIdleFrames_ = 60;
+	idleFrames_ = maxIdleFrames_;	// inactive until depth() is called
+}
+
+DepthReadback::~DepthReadback()
+{
+	// buffers are released with the GL context
+}
+
+void DepthReadback::read(int width, int height)
+{
+	const Window empty = {0, 0, 0, 0};
+	if (!isActive()) {
+		// drop the old values, they are not updated any more
+		pending_[0] = pending_[1] = false;
+		depthWindow_ = empty;
+		return;
+	}
+	++idleFrames_;
+
+	if (width <= 0 || height <= 0) return;
+
+	if (buffers_[0] == 0) {
+		glGenBuffers(2, buffers_);
+	}
+
+	// collect the read issued in the previous frame
+	const int prev = 1 - index_;
+	if (pending_[prev]) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[prev]);
+		const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+		if (data) {
+			depthWindow_ = windows_[prev];
+			depth_.resize(static_cast<size_t>(depthWindow_.width) * depthWindow_.height);
+			std::memcpy(depth_.data(), data, depth_.size() * sizeof(float));
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		pending_[prev] = false;
+	}
+
+	// window around the pixels asked since the last read, in the viewport
+	if (requested_) {
+		window_.x = requestMin_[0] - windowMargin;
+		window_.y = requestMin_[1] - windowMargin;
+		window_.width = requestMax_[0] - requestMin_[0] + 1 + 2 * windowMargin;
+		window_.height = requestMax_[1] - requestMin_[1] + 1 + 2 * windowMargin;
+		requested_ = false;
+	}
+	Window window;
+	window.x = std::max(0, window_.x);
+	window.y = std::max(0, window_.y);
+	window.width = std::min(width, window_.x + window_.width) - window.x;
+	window.height = std::min(height, window_.y + window_.height) - window.y;
+	if (window.width <= 0 || window.height <= 0) return;
+
+	// start reading this frame
+	const size_t bytes = static_cast<size_t>(window.width) * window.height * sizeof(float);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[index_]);
+	if (capacity_[index_] < bytes) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+		capacity_[index_] = bytes;
+	}
+	glReadPixels(window.x, window.y, window.width, window.height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	windows_[index_] = window;
+	pending_[index_] = true;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	index_ = prev;
+}
+
+bool DepthReadback::depth(int x, int y, float& z)
+{
+	idleFrames_ = 0;
+
+	if (requested_) {
+		requestMin_[0] = std::min(requestMin_[0], x);
+		requestMin_[1] = std::min(requestMin_[1], y);
+		requestMax_[0] = std::max(requestMax_[0], x);
+		requestMax_[1] = std::max(requestMax_[1], y);
+	} else {
+		requestMin_[0] = requestMax_[0] = x;
+		requestMin_[1] = requestMax_[1] = y;
+		requested_ = true;
+	}
+
+	if (!depthWindow_.contains(x, y)) return false;
+
+	z = depth_[static_cast<size_t>(y - depthWindow_.y) * depthWindow_.width + (x - depthWindow_.x)];
+	return true;
+}
+
+} /* namespace tgl */
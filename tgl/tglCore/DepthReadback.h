@@ -0,0 +1,66 @@
+/*
+ * DepthReadback.h
+ */
+
+#ifndef TGL_CORE_DEPTHREADBACK_H_
+#define TGL_CORE_DEPTHREADBACK_H_
+
+#include <memory>
+#include <vector>
+#include <GL/gl.h>
+
+namespace tgl {
+
+class DepthReadback;
+typedef std::shared_ptr<DepthReadback> DepthReadbackPtr;
+
+// Asynchronous copy of the depth buffer through two pixel buffer objects.
+// the depth read in a frame is mapped in the next frame, so depth() returns the
+// values of the previous frame without waiting for the GPU.
+// reading runs only while depth() is used, it stops after some idle frames.
+// only a window around the pixels asked since the last read is copied, not the whole frame
+class DepthReadback {
+public:
+	DepthReadback();
+	virtual ~DepthReadback();
+
+	// called by GraphicsView after the scene pass, while the depth buffer holds the scene
+	void read(int width, int height);
+
+	// depth at the window position (origin at the bottom left).
+	// returns false if there is no depth of the pixel yet, then it is read from the next frame
+	bool depth(int x, int y, float& z);
+
+	bool isActive() const { return idleFrames_ < maxIdleFrames_; }
+
+private:
+	DepthReadback(const DepthReadback&) = delete;
+	DepthReadback& operator=(const DepthReadback&) = delete;
+
+	struct Window {
+		int x, y, width, height;
+		bool contains(int px, int py) const { return px >= x && py >= y && px < x + width && py < y + height; }
+	};
+
+	GLuint buffers_[2];
+	size_t capacity_[2];	// bytes
+	Window windows_[2];
+	bool pending_[2];
+	int index_;
+
+	std::vector<float> depth_;
+	Window depthWindow_;	// of depth_
+
+	// pixels asked since the last read. the window is kept while none is asked
+	int requestMin_[2];
+	int requestMax_[2];
+	bool requested_;
+	Window window_;
+
+	unsigned int idleFrames_;
+	unsigned int maxIdleFrames_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_DEPTHREADBACK_H_ */
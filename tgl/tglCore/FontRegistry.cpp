@@ -0,0 +1,124 @@
+/*
+ * FontRegistry.cpp
+ */
+
+#include <fstream>
+#include <iostream>
+#include <boost/filesystem.hpp>
+#include <FTGL/ftgl.h>
+#include "FontRegistry.h"
+
+namespace tgl {
+
+FontRegistry& FontRegistry::instance()
+{
+	static FontRegistry registry;
+	return registry;
+}
+
+FontRegistry::FontRegistry()
+{
+
+}
+
+FontRegistry::~FontRegistry()
+{
+
+}
+
+FontRegistry::FaceDataPtr FontRegistry::loadFaceData(const std::string& path)
+{
+	boost::filesystem::path fpath(path);
+	if (!boost::filesystem::exists(fpath)) return nullptr;
+
+	std::ifstream ifs(path.c_str(), std::ios::in | std::ios::binary);
+	if (!ifs) return nullptr;
+
+	std::shared_ptr<std::vector<unsigned char>> data = std::make_shared<std::vector<unsigned char>>();
+	ifs.seekg(0, std::ios::end);
+	data->resize(static_cast<size_t>(ifs.tellg()));
+	ifs.seekg(0, std::ios::beg);
+	if (!data->empty()) {
+		ifs.read(reinterpret_cast<char*>(data->data()), data->size());
+	}
+
+	return data->empty() ? nullptr : data;
+}
+
+FontRegistry::FaceDataPtr FontRegistry::faceData(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	auto itr = faces_.find(path);
+	if (itr != faces_.end()) return itr->second;
+
+	FaceDataPtr data = loadFaceData(path);
+	faces_[path] = data;
+	return data;
+}
+
+FTFont* FontRegistry::font(ContextKey context, const std::string& path, int size)
+{
+	FaceDataPtr data = faceData(path);
+	if (!data) return nullptr;
+
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	ContextFonts& fonts = contexts_[context];
+	FontKey key(path, size);
+
+	auto itr = fonts.fonts.find(key);
+	if (itr != fonts.fonts.end()) return itr->second.font.get();
+
+	FontEntry& entry = fonts.fonts[key];
+	entry.data = data;
+	entry.font = std::shared_ptr<FTFont>(new FTExtrudeFont(data->data(), data->size()));
+	if (entry.font->Error()) {
+		entry.font.reset();	// keep the empty entry, do not retry every frame
+	} else {
+		entry.font->FaceSize(size);
+	}
+
+	return entry.font.get();
+}
+
+void FontRegistry::attachContext(ContextKey context)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	++contexts_[context].refCount;
+}
+
+void FontRegistry::detachContext(ContextKey context)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	auto itr = contexts_.find(context);
+	if (itr == contexts_.end()) return;
+
+	if (--itr->second.refCount <= 0) {
+		contexts_.erase(itr);
+	}
+}
+
+bool FontResource::loadData(std::string& error)
+{
+	if (FontRegistry::instance().faceData(path())) return true;
+	error = "can not read the font";
+	std::cerr << "error : FontResource " << error << " : " << path() << std::endl;
+	return false;
+}
+
+size_t FontRegistry::numFaces() const
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	return faces_.size();
+}
+
+size_t FontRegistry::numFonts(ContextKey context) const
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	auto itr = contexts_.find(context);
+	return itr != contexts_.end() ? itr->second.fonts.size() : 0;
+}
+
+} /* namespace tgl */
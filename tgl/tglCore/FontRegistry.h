@@ -0,0 +1,88 @@
+/*
+ * FontRegistry.h
+ */
+
+#ifndef TGL_CORE_FONTREGISTRY_H_
+#define TGL_CORE_FONTREGISTRY_H_
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include "ResourceLoader.h"
+
+class FTFont;
+
+namespace tgl {
+
+class FontResource;
+typedef std::shared_ptr<FontResource> FontResourcePtr;
+
+// Process-wide font cache.
+// The TTF file is read once per path and its bytes are shared by every context.
+// FTFont objects own GL resources (glyph display lists / textures), so they are
+// created per context group and per face size, on first use.
+class FontRegistry {
+public:
+	typedef const void* ContextKey;
+	typedef std::shared_ptr<const std::vector<unsigned char>> FaceDataPtr;
+
+	static FontRegistry& instance();
+
+	// call from the render thread of the context. returns nullptr if the font can not be loaded
+	FTFont* font(ContextKey context, const std::string& path, int size);
+
+	// immutable face data. nullptr if the file does not exist
+	FaceDataPtr faceData(const std::string& path);
+
+	// contexts sharing GL objects use the same key
+	void attachContext(ContextKey context);
+	void detachContext(ContextKey context);
+
+	size_t numFaces() const;
+	size_t numFonts(ContextKey context) const;
+
+private:
+	FontRegistry();
+	~FontRegistry();
+	FontRegistry(const FontRegistry&) = delete;
+	FontRegistry& operator=(const FontRegistry&) = delete;
+
+	FaceDataPtr loadFaceData(const std::string& path);
+
+	struct FontEntry {
+		FaceDataPtr data;	// keep face bytes alive while the font refers to them
+		std::shared_ptr<FTFont> font;
+	};
+
+	typedef std::pair<std::string, int> FontKey;
+
+	struct ContextFonts {
+		ContextFonts() : refCount(0) {}
+		int refCount;
+		std::map<FontKey, FontEntry> fonts;
+	};
+
+	mutable std::mutex mutex_;
+
+	// nullptr is stored for missing files so that they are not checked every frame
+	std::unordered_map<std::string, FaceDataPtr> faces_;
+	std::unordered_map<ContextKey, ContextFonts> contexts_;
+};
+
+// face data of a font, read on a worker thread by ResourceLoader into the registry.
+// FTFont objects are still created on first use, they own GL objects
+class FontResource : public Resource {
+public:
+	explicit FontResource(const std::string& path) : Resource(path, "font") {}
+
+protected:
+	virtual bool loadData(std::string& error);
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_FONTREGISTRY_H_ */
@@ -27,32 +27,44 @@ void GraphicsDriver::executeGraphicsViewRenderEvent()
 
 void GraphicsDriver::executeGraphicsViewResizeEvent(int width, int height)
 {
-	if (view_) view_->resizeEvent(width, height);
+	if (!view_) return;
+	view_->redrawRequested_ = true;	// input changes the scene
+	view_->resizeEvent(width, height);
 }
 
 void GraphicsDriver::executeGraphicsViewMousePressEvent(MouseEvent* e)
 {
-	if (view_) view_->mousePressEvent(e);
+	if (!view_) return;
+	view_->redrawRequested_ = true;	// input changes the scene
+	view_->mousePressEvent(e);
 }
 
 void GraphicsDriver::executeGraphicsViewMouseMoveEvent(MouseEvent* e)
 {
-	if (view_) view_->mouseMoveEvent(e);
+	if (!view_) return;
+	view_->redrawRequested_ = true;	// input changes the scene
+	view_->mouseMoveEvent(e);
 }
 
 void GraphicsDriver::executeGraphicsViewMouseReleaseEvent(MouseEvent* e)
 {
-	if (view_) view_->mouseReleaseEvent(e);
+	if (!view_) return;
+	view_->redrawRequested_ = true;	// input changes the scene
+	view_->mouseReleaseEvent(e);
 }
 
 void GraphicsDriver::executeGraphicsViewWheelEvent(WheelEvent* e)
 {
-	if (view_) view_->wheelEvent(e);
+	if (!view_) return;
+	view_->redrawRequested_ = true;	// input changes the scene
+	view_->wheelEvent(e);
 }
 
 void GraphicsDriver::executeGraphicsViewKeyPressEvent(KeyEvent* e)
 {
-	if (view_) view_->keyPressEvent(e);
+	if (!view_) return;
+	view_->redrawRequested_ = true;	// input changes the scene
+	view_->keyPressEvent(e);
 }
 
 MouseEvent* GraphicsDriver::getGraphicsViewMouseEvent()
@@ -43,6 +43,9 @@ protected:
 	virtual int height() const = 0;
 	virtual int frameRate() const = 0;
 
+	// wakes up a driver waiting for events, GraphicsView requested a frame. may be called from any thread
+	virtual void wakeUp() {}
+
 	void executeGraphicsViewInitializeEvent();
 	void executeGraphicsViewRenderEvent();
 	void executeGraphicsViewResizeEvent(int width, int height);
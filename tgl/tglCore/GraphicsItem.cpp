@@ -13,12 +13,22 @@ GraphicsItem::GraphicsItem() {
 	parent_ = nullptr;
 	graphicsView_ = nullptr;
 	visible_ = true;
+	selectPicking2D_ = true;
+	rayPicking_ = RayPicking::None;
+	acceptHoverEvents_ = false;
+	acceptMouseEvents_ = false;
+
+	localPosition_.setZero();
+	localAttitude_.setIdentity();
+	localIdentity_ = true;
+	worldDirty_ = true;
 }
 
 GraphicsItem::~GraphicsItem() {
 	for (auto ptr : children_) {
 		ptr->parent_ = nullptr;
 		ptr->graphicsView_ = nullptr;
+		ptr->invalidateWorldTransform();
 	}
 }
 
@@ -30,6 +40,9 @@ void GraphicsItem::addChild(GraphicsItemPtr item)
 	item->parent_ = this;
 	item->graphicsView_ = this->graphicsView_;
 	children_.push_back(item);
+	item->invalidateWorldTransform();
+
+	if (graphicsView_) graphicsView_->invalidatePicking();
 }
 
 void GraphicsItem::removeChild(GraphicsItemPtr item)
@@ -38,16 +51,87 @@ void GraphicsItem::removeChild(GraphicsItemPtr item)
 	if (itr != children_.end()) {
 		(*itr)->parent_ = nullptr;
 		(*itr)->graphicsView_ = nullptr;
+		(*itr)->invalidateWorldTransform();
 		children_.erase(itr);
+
+		if (graphicsView_) graphicsView_->invalidatePicking();
 	}
 }
 
 void GraphicsItem::setVisible(bool visible)
 {
+	// called every frame by layouts (DockWidget), picking is dropped only on a change.
+	// children are still set, each invalidates for itself
+	const bool changed = visible_ != visible;
 	visible_ = visible;
 	for (auto ptr : children_) {
 		ptr->setVisible(visible);
 	}
+
+	if (changed && graphicsView_) graphicsView_->invalidatePicking();
+}
+
+void GraphicsItem::update()
+{
+	if (!graphicsView_) return;
+
+	graphicsView_->invalidatePicking();
+	graphicsView_->requestRedraw();
+}
+
+void GraphicsItem::setLocalTransform(const Eigen::Vector3d& p, const Eigen::Matrix3d& R)
+{
+	localPosition_ = p;
+	localAttitude_ = R;
+	localIdentity_ = p.isZero(0.0) && R.isIdentity(0.0);
+	invalidateWorldTransform();
+
+	update();
+}
+
+void GraphicsItem::invalidateWorldTransform()
+{
+	if (worldDirty_) return;
+	worldDirty_ = true;
+	for (auto ptr : children_) {
+		ptr->invalidateWorldTransform();
+	}
+}
+
+void GraphicsItem::updateWorldTransform() const
+{
+	if (!worldDirty_) return;
+
+	const GraphicsItem* parent = parent_;
+	if (parent) parent->updateWorldTransform();
+
+	if (!parent || parent->worldIdentity_) {
+		worldPosition_ = localPosition_;
+		worldAttitude_ = localAttitude_;
+		worldIdentity_ = localIdentity_;
+	} else if (localIdentity_) {
+		worldPosition_ = parent->worldPosition_;
+		worldAttitude_ = parent->worldAttitude_;
+		worldIdentity_ = false;
+	} else {
+		worldPosition_ = parent->worldAttitude_ * localPosition_ + parent->worldPosition_;
+		worldAttitude_ = parent->worldAttitude_ * localAttitude_;
+		worldIdentity_ = false;
+	}
+
+	Eigen::Map<Eigen::Matrix4d> M(worldMatrix_.data());
+	M.setIdentity();
+	M.block<3,3>(0,0) = worldAttitude_;
+	M.block<3,1>(0,3) = worldPosition_;
+
+	worldDirty_ = false;
+}
+
+bool GraphicsItem::contains2D(int x, int y) const
+{
+	int rx, ry, rw, rh;
+	if (!boundingRect2D(rx, ry, rw, rh)) return false;
+	return x >= rx && y >= ry && x < rx + rw && y < ry + rh;
 }
 
 int GraphicsItem::viewWidth() const
@@ -6,9 +6,11 @@
 #define TGL_CORE_GRAPHICSITEM_H_
 
 #include <vector>
+#include <array>
 #include <string>
 #include <memory>
 #include <functional>
+#include <Eigen/Core>
 
 namespace tgl {
 
@@ -19,6 +21,7 @@ class TextRenderer;
 class GraphicsItemHoverEvent;
 class GraphicsItemMouseEvent;
 class GraphicsItemSelectEvent;
+class ChangeNotifier;
 
 class GraphicsItem;
 typedef std::shared_ptr<GraphicsItem> GraphicsItemPtr;
@@ -39,7 +42,7 @@ public:
 
 	// visible == false の時はpickingされない
 	bool isVisible() const { return visible_; }
-	void setVisible(bool visible);
+	virtual void setVisible(bool visible);
 
 	GraphicsItem* parentItem() const { return parent_; }
 
@@ -49,13 +52,64 @@ public:
 	GraphicsItemPtr childItem(size_t i) const { return children_[i]; }
 
 	GraphicsView* graphicsWindow() const { return graphicsView_; }
+
+	// local transform relative to the parent item, identity by default.
+	// GraphicsView multiplies the world matrix before the render and picking scenes of the item,
+	// and gives intersectRay() the ray in the item frame.
+	// world matrices are cached and recomputed lazily, only below a changed item
+	void setLocalTransform(const Eigen::Vector3d& p, const Eigen::Matrix3d& R);
+	const Eigen::Vector3d& localPosition() const { return localPosition_; }
+	const Eigen::Matrix3d& localAttitude() const { return localAttitude_; }
+
+	const Eigen::Vector3d& worldPosition() const { updateWorldTransform(); return worldPosition_; }
+	const Eigen::Matrix3d& worldAttitude() const { updateWorldTransform(); return worldAttitude_; }
+	// column major 4x4, for glMultMatrixd
+	const double* worldMatrix() const { updateWorldTransform(); return worldMatrix_.data(); }
+	bool isWorldIdentity() const { updateWorldTransform(); return worldIdentity_; }
+
+	// call after changing the item from outside of its event handlers.
+	// drops cached picking results and requests a frame
+	void update();
 	int viewWidth() const;
 	int viewHeight() const;
 
+	// 2D hit test
+	// an item with a 2D shape returns its bounding rect in view coordinates and is picked by
+	// contains2D() through a spatial index. items without one are picked by rendering
+	// renderPicking2DScene() in GL_SELECT mode, unless setSelectPicking2D(false) (default on)
+	virtual bool boundingRect2D(int& /* x */, int& /* y */, int& /* w */, int& /* h */) const { return false; }
+	virtual bool contains2D(int x, int y) const;
+
+	void setSelectPicking2D(bool on) { selectPicking2D_ = on; }
+	bool isSelectPicking2D() const { return selectPicking2D_; }
+
+	// 3D hit test
+	// an item with an analytic shape is picked by intersectRay() with the view ray in the pass
+	// given to setRayPicking(), and is never rendered in GL_SELECT mode.
+	// distance : ray parameter of the nearest hit (origin + distance * dir)
+	enum class RayPicking { None, Scene, Overlay };
+	virtual bool intersectRay(const Eigen::Vector3d& /* origin */, const Eigen::Vector3d& /* dir */, double& /* distance */) const { return false; }
+
+	void setRayPicking(RayPicking pass) { rayPicking_ = pass; }
+	RayPicking rayPicking() const { return rayPicking_; }
+
+	// picking interest (default off)
+	// only items accepting hover events are picked on mouse move, and only items accepting
+	// mouse events on press. a scene without them is not picked at all.
+	// an item drawn only in 3D should also call setSelectPicking2D(false), otherwise it costs
+	// a GL_SELECT 2D pass on every move
+	void setAcceptHoverEvents(bool on) { acceptHoverEvents_ = on; }
+	bool acceptHoverEvents() const { return acceptHoverEvents_; }
+	void setAcceptMouseEvents(bool on) { acceptMouseEvents_ = on; }
+	bool acceptMouseEvents() const { return acceptMouseEvents_; }
+
 	static void traverse(GraphicsItemPtr item, std::function<void (GraphicsItemPtr)> func);
 	static void traverseReverse(GraphicsItemPtr item, std::function<void (GraphicsItemPtr)> func);
 
 protected:
+	// notifiers owned by the item, flushed by GraphicsView once per frame on the render thread
+	void addChangeNotifier(ChangeNotifier* notifier) { notifiers_.push_back(notifier); }
+
 	// render scene
 	virtual void renderScene(tgl::Renderer3D* /* r */) {}
 	virtual void renderOverlayScene(tgl::Renderer3D* /* r */) {}
@@ -92,6 +146,26 @@ private:
 
 	GraphicsView* graphicsView_;
 	bool visible_;
+	bool selectPicking2D_;
+	RayPicking rayPicking_;
+	bool acceptHoverEvents_;
+	bool acceptMouseEvents_;
+
+	std::vector<ChangeNotifier*> notifiers_;
+
+	// world of a clean item is never below a dirty one, so invalidation stops at dirty items
+	void invalidateWorldTransform();
+	void updateWorldTransform() const;
+
+	Eigen::Vector3d localPosition_;
+	Eigen::Matrix3d localAttitude_;
+	bool localIdentity_;
+
+	mutable Eigen::Vector3d worldPosition_;
+	mutable Eigen::Matrix3d worldAttitude_;
+	mutable std::array<double, 16> worldMatrix_;
+	mutable bool worldIdentity_;
+	mutable bool worldDirty_;
 };
 
 } /* namespace tgl */
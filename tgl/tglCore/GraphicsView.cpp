@@ -2,7 +2,10 @@
  * GraphicsView.cpp
  */
 
+#include <algorithm>
 #include "GraphicsDriver.h"
+#include "FontRegistry.h"
+#include "ResourceLoader.h"
 #include "GraphicsView.h"
 
 //#include <iostream>
@@ -10,11 +13,33 @@
 
 namespace tgl {
 
+namespace {
+
+// multiplies the world matrix of the item. false if it is identity and nothing was pushed
+bool pushWorldTransform(const GraphicsItemPtr& item)
+{
+	if (item->isWorldIdentity()) return false;
+	glPushMatrix();
+	glMultMatrixd(item->worldMatrix());
+	return true;
+}
+
+}
+
 GraphicsView::GraphicsView(std::unique_ptr<GraphicsDriver> driver)
 	: driver_(std::move(driver))
 {
 	initialized_ = false;
 
+	renderOnDemand_ = false;
+	redrawRequested_ = true;
+	firstFrame_ = true;
+
+	glContextGroup_ = this;
+	FontRegistry::instance().attachContext(glContextGroup_);
+	TriangleMesh::attachContext(glContextGroup_);
+	ResourceLoader::instance().addListener(this, [this](){ requestRedraw(); });
+
 	renderer3D_ = std::move(std::unique_ptr<Renderer3D>(new Renderer3D(this)));
 	renderer2D_ = std::move(std::unique_ptr<Renderer2D>(new Renderer2D(this)));
 	textRenderer_ = std::move(std::unique_ptr<TextRenderer>(new TextRenderer(this)));
@@ -28,6 +53,8 @@ GraphicsView::GraphicsView(std::unique_ptr<GraphicsDriver> driver)
 	graphicsItemSelectEvent_ = std::move(std::unique_ptr<GraphicsItemSelectEvent>(new GraphicsItemSelectEvent));
 
 	camera_ = CameraPtr(new StandardCamera);
+	depthReadback_ = std::make_shared<DepthReadback>();
+	camera_->setDepthReadback(depthReadback_);
 
 	frameRate_ = 30;
 
@@ -40,11 +67,25 @@ GraphicsView::GraphicsView(std::unique_ptr<GraphicsDriver> driver)
 	float perspectiveZfar_;		// 一番遠いZ位置
 
 	backgroundColor_ = {{0.8, 0.8, 0.8, 1.0}};
+	viewport_ = {{0, 0, 1, 1}};
+
+	hitTree2DDirty_ = true;
+	hasSelectPicking2DItems_ = false;
+	numHoverItems_ = 0;
+	numMouseItems_ = 0;
+
+	pickingGeneration_ = 0;
+	pickingCache_.valid.fill(false);
+	pickingView_.fill(0.0);
+	pickingProjection_.fill(0.0);
 }
 
 GraphicsView::~GraphicsView()
 {
 //	driver_->terminate();
+	ResourceLoader::instance().removeListener(this);
+	FontRegistry::instance().detachContext(glContextGroup_);
+	TriangleMesh::detachContext(glContextGroup_);
 }
 
 void GraphicsView::initialize()
@@ -73,6 +114,21 @@ const std::string& GraphicsView::windowTitle() const
 }
 
 
+void GraphicsView::setGLContextGroup(const void* group)
+{
+	if (!group || group == glContextGroup_) return;
+
+	// the fonts of the old group may be deleted by detachContext()
+	renderer2D_->resetFont();
+	textRenderer_->resetFont();
+
+	FontRegistry::instance().detachContext(glContextGroup_);
+	TriangleMesh::detachContext(glContextGroup_);
+	glContextGroup_ = group;
+	FontRegistry::instance().attachContext(glContextGroup_);
+	TriangleMesh::attachContext(glContextGroup_);
+}
+
 void GraphicsView::setWindowSize(int width, int height)
 {
 	driver_->setWindowSize(width, height);
@@ -98,6 +154,23 @@ int GraphicsView::frameRate() const
 	return driver_->frameRate();
 }
 
+void GraphicsView::setRenderOnDemand(bool on)
+{
+	renderOnDemand_ = on;
+	requestRedraw();
+}
+
+void GraphicsView::requestRedraw()
+{
+	redrawRequested_ = true;
+	driver_->wakeUp();
+}
+
+bool GraphicsView::needsRedraw() const
+{
+	return !renderOnDemand_ || redrawRequested_ || camera_->isAnimating();
+}
+
 LightPtr GraphicsView::light(size_t index) const
 {
 	return index < lightList_.size() ? lightList_[index] : nullptr;
@@ -139,20 +212,30 @@ void GraphicsView::resizeEvent(int width, int height)
 {
 	double aspect = (double)width / (double)height;
 
+	viewport_ = {{0, 0, width, height}};
+	camera_->setViewport(0, 0, width, height);
+	camera_->setPerspective(perspectiveFovy_, aspect, perspectiveZnear_, perspectiveZfar_);
+
 	glViewport(0, 0, width, height);			// ビューポートの再設定
+	invalidatePicking();
 	glMatrixMode(GL_PROJECTION);				// 投影変換スタックの操作
-	glLoadIdentity();								// 投影変関スタックの初期化
-	gluPerspective(perspectiveFovy_, aspect, perspectiveZnear_, perspectiveZfar_);	// ビューボリュームの再定義
+	glLoadMatrixd(camera_->projectionMatrix().data());
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
-
-	camera_->updateProject();
 }
 
 void GraphicsView::renderEvent()
 {
+	// cleared first, requests made while drawing this frame ask for the next one
+	redrawRequested_ = false;
+
 	executePrevProcess();
 
+	ResourceLoader::instance().beginFrame();	// evicts over the memory budget
+	TriangleMesh::releaseUnusedBuffers(glContextGroup_);	// of meshes destroyed since the last frame
+	ResourceLoader::instance().uploadPending(glContextGroup_);	// within the upload budget
+	if (ResourceLoader::instance().hasPendingUploads()) requestRedraw();
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glEnable(GL_DEPTH_TEST);	// Zバッファ有効
 
@@ -167,19 +250,50 @@ void GraphicsView::renderEvent()
 	// set background color
 	glClearColor(backgroundColor_[0], backgroundColor_[1], backgroundColor_[2], backgroundColor_[3]);
 
-	// update camera
+	// update camera. animations step by time, not by frame
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double dt = firstFrame_ ? 0.0 : std::chrono::duration<double>(now - frameTime_).count();
+	frameTime_ = now;
+	firstFrame_ = false;
+	camera_->advance(std::min(dt, 0.1));	// no jump after idling
 	camera_->update();
-	camera_->updateProject();
+	renderer3D_->beginFrame(*camera_);
+
+	// a moved camera invalidates picking
+	const Eigen::Matrix4d& view = camera_->viewMatrix();
+	const Eigen::Matrix4d& projection = camera_->projectionMatrix();
+	if (!std::equal(pickingView_.begin(), pickingView_.end(), view.data()) ||
+			!std::equal(pickingProjection_.begin(), pickingProjection_.end(), projection.data())) {
+		std::copy(view.data(), view.data() + 16, pickingView_.begin());
+		std::copy(projection.data(), projection.data() + 16, pickingProjection_.begin());
+		invalidatePicking();
+	}
 
 	// update light
 	for (auto light : lightList_) {
 		light->update();
 	}
 
-	// get viewport
-	glGetIntegerv(GL_VIEWPORT, viewport_.data());
-
+	prevTraversedItems_.swap(traversedItems_);
 	traverseGraphicsItems(traversedItems_);
+	hitTree2DDirty_ = true;
+
+	const int prevNumHoverItems = numHoverItems_;
+	const int prevNumMouseItems = numMouseItems_;
+	numHoverItems_ = 0;
+	numMouseItems_ = 0;
+	for (const auto& item : traversedItems_) {
+		if (!item->isVisible()) continue;
+		if (item->acceptHoverEvents()) ++numHoverItems_;
+		if (item->acceptMouseEvents()) ++numMouseItems_;
+	}
+
+	if (traversedItems_ != prevTraversedItems_ ||
+			numHoverItems_ != prevNumHoverItems || numMouseItems_ != prevNumMouseItems) {
+		invalidatePicking();
+	}
+
+	deliverChangesOfGrahicsItems();
 
 	// render scene
 	{
@@ -188,6 +302,9 @@ void GraphicsView::renderEvent()
 		renderScene(renderer3D_.get());
 		renderSceneOfGrahicsItems();
 		glColor4dv(color);						// restore color
+
+		// depth of the scene, before the overlay clears it
+		depthReadback_->read(viewport_[2], viewport_[3]);
 	}
 
 	// render overlay scene
@@ -221,6 +338,7 @@ void GraphicsView::renderEvent()
 
 			render2DScene(renderer2D_.get());
 			render2DSceneOfGrahicsItems();
+			renderer2D_->endFrame();
 
 			glColor4dv(color);						// restore color
 		}
@@ -256,8 +374,14 @@ void GraphicsView::setCamera(CameraPtr camera)
 {
 	if (!camera) return;
 
+	// projection and viewport are set on resize, take them over
+	camera->setViewport(viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+	camera->setProjectionMatrix(camera_->projectionMatrix());
+	camera->setDepthReadback(depthReadback_);
+
 	camera_ = camera;
 	camera_->initializeConfiguration();
+	invalidatePicking();
 }
 
 void GraphicsView::addLight(LightPtr light)
@@ -286,6 +410,7 @@ void GraphicsView::addGraphicsItem(GraphicsItemPtr item)
 	GraphicsItem::traverse(item, [&](GraphicsItemPtr ptr){
 		ptr->graphicsView_ = this;
 	});
+	invalidatePicking();
 }
 
 void GraphicsView::removeGraphicsItem(GraphicsItemPtr item)
@@ -294,8 +419,9 @@ void GraphicsView::removeGraphicsItem(GraphicsItemPtr item)
 
 	auto itr = std::find(graphicsItems_.begin(), graphicsItems_.end(), item);
 	if (itr != graphicsItems_.end()) {
-		graphicsItems_.erase(itr);
 		(*itr)->graphicsView_ = nullptr;
+		graphicsItems_.erase(itr);
+		invalidatePicking();
 	}
 }
 
@@ -309,7 +435,9 @@ void GraphicsView::renderSceneOfGrahicsItems()
 {
 	for (auto item : traversedItems_) {
 		if (item->isVisible()) {
+			const bool pushed = pushWorldTransform(item);
 			item->renderScene(this->renderer3D_.get());
+			if (pushed) glPopMatrix();
 		}
 	}
 }
@@ -318,7 +446,9 @@ void GraphicsView::renderOverlaySceneOfGrahicsItems()
 {
 	for (auto item : traversedItems_) {
 		if (item->isVisible()) {
+			const bool pushed = pushWorldTransform(item);
 			item->renderOverlayScene(this->renderer3D_.get());
+			if (pushed) glPopMatrix();
 		}
 	}
 }
@@ -341,6 +471,15 @@ void GraphicsView::renderTextSceneOfGrahicsItems()
 	}
 }
 
+void GraphicsView::deliverChangesOfGrahicsItems()
+{
+	for (const auto& item : traversedItems_) {
+		for (ChangeNotifier* notifier : item->notifiers_) {
+			notifier->flush();
+		}
+	}
+}
+
 void GraphicsView::mousePressEvent(MouseEvent* e)
 {
 	if (e->button() == MouseEvent::MouseBotton::RightButton ||
@@ -394,7 +533,7 @@ void GraphicsView::graphicsItemMousePressEvent(MouseEvent* e)
 {
 	if (e->button() == MouseEvent::MouseBotton::LeftButton) {
 
-		GraphicsItemList pickingItems = pickingUpGrahicsItems(e->x(), e->y());
+		GraphicsItemList pickingItems = pickingUpGrahicsItems(e->x(), e->y(), PickingTarget::Mouse);
 
 		if (pickingItems.empty()) {
 
@@ -423,6 +562,7 @@ void GraphicsView::graphicsItemMousePressEvent(MouseEvent* e)
 			// mouse event
 			mouseGraphicsItem_ = nearItem;
 			mouseGraphicsItem_->mousePressEvent(graphicsItemMouseEvent_.get());
+			invalidatePicking();	// the item may have changed itself
 
 		}
 	}
@@ -438,10 +578,11 @@ void GraphicsView::graphicsItemMouseMoveEvent(MouseEvent* e)
 		// mouse event
 		if (mouseGraphicsItem_) {
 			mouseGraphicsItem_->mouseMoveEvent(graphicsItemMouseEvent_.get());
+			invalidatePicking();
 		}
 	}
 
-	GraphicsItemList pickingItems = pickingUpGrahicsItems(e->x(), e->y());
+	GraphicsItemList pickingItems = pickingUpGrahicsItems(e->x(), e->y(), PickingTarget::Hover);
 
 	if (pickingItems.empty()) {
 
@@ -482,29 +623,63 @@ void GraphicsView::graphicsItemMouseReleaseEvent(MouseEvent* e)
 	if (mouseGraphicsItem_) {
 		mouseGraphicsItem_->mouseReleaseEvent(graphicsItemMouseEvent_.get());
 		mouseGraphicsItem_ = nullptr;
+		invalidatePicking();
 	}
 }
 
-GraphicsItemList GraphicsView::pickingUpGrahicsItems(int x, int y)
+bool GraphicsView::acceptsPicking(const GraphicsItemPtr& item, PickingTarget target)
+{
+	if (!item->isVisible()) return false;
+
+	switch (target) {
+	case PickingTarget::Hover:	return item->acceptHoverEvents();
+	case PickingTarget::Mouse:	return item->acceptMouseEvents();
+	default:					return item->acceptHoverEvents() || item->acceptMouseEvents();
+	}
+}
+
+GraphicsItemList GraphicsView::pickingUpGrahicsItems(int x, int y, PickingTarget target)
 {
 	GraphicsItemList items;
 
-	// 2D scene
-	items = pickingUp2DSceneGrahicsItems(x, y);
-	if (items.size() > 0) return std::move(items);
+	// nobody listens, no picking
+	if ((target == PickingTarget::Hover ? numHoverItems_ : numMouseItems_) == 0) return items;
 
-	// overlay 3D scene
-	items = pickingUpOverlaySceneGrahicsItems(x, y);
-	if (items.size() > 0) return std::move(items);
+	const unsigned int generation = pickingGeneration_;
+	if (pickingCache_.x != x || pickingCache_.y != y || pickingCache_.generation != generation) {
+		pickingCache_.x = x;
+		pickingCache_.y = y;
+		pickingCache_.generation = generation;
+		pickingCache_.valid.fill(false);
+	}
 
-	// 3D scene
-	items = pickingUpSceneGrahicsItems(x, y);
+	// 2D scene, overlay 3D scene, 3D scene. each pass is picked once for all targets
+	for (int pass = 0; pass < 3; ++pass) {
+		if (!pickingCache_.valid[pass]) {
+			switch (pass) {
+			case 0:	pickingCache_.items[pass] = pickingUp2DSceneGrahicsItems(x, y, PickingTarget::Any); break;
+			case 1:	pickingCache_.items[pass] = pickingUpOverlaySceneGrahicsItems(x, y, PickingTarget::Any); break;
+			default: pickingCache_.items[pass] = pickingUpSceneGrahicsItems(x, y, PickingTarget::Any); break;
+			}
+			pickingCache_.valid[pass] = true;
+		}
 
-	return std::move(items);
+		for (const auto& item : pickingCache_.items[pass]) {
+			if (acceptsPicking(item, target)) items.push_back(item);
+		}
+		if (items.size() > 0) return items;
+	}
+
+	return items;
 }
 
-GraphicsItemList GraphicsView::pickingUpOverlaySceneGrahicsItems(int x, int y)
+GraphicsItemList GraphicsView::pickingUpOverlaySceneGrahicsItems(int x, int y, PickingTarget target)
 {
+	DepthItemList rayHits = rayPickingGrahicsItems(x, y, target, GraphicsItem::RayPicking::Overlay);
+	if (!hasSelectPickingGrahicsItems(target)) {
+		return mergePickedGrahicsItems(rayHits, GraphicsItemList(), std::vector<double>());
+	}
+
 	std::map<int, GraphicsItemPtr> indexToGraphicsItemMap;
 	int index = 1;
 
@@ -529,18 +704,18 @@ GraphicsItemList GraphicsView::pickingUpOverlaySceneGrahicsItems(int x, int y)
 		glPushMatrix();
 		glLoadIdentity();
 		gluPickMatrix(x, viewport[3]-y, 5.0, 5.0, viewport); // ピッキング行列の乗算
-		float aspect = (float)viewport[2] / (float)viewport[3];
-		gluPerspective(perspectiveFovy_, aspect, perspectiveZnear_, perspectiveZfar_);	// ビューボリュームの再定義
+		glMultMatrixd(camera_->projectionMatrix().data());
 
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
-		camera_->update();					// カメラ再設定
-//		camera_->updateProject();
+		camera_->loadViewMatrix();			// the view of the last frame
 
 		for (auto item : traversedItems_) {
-			if (item->isVisible()) {
+			if (item->rayPicking() == GraphicsItem::RayPicking::None && acceptsPicking(item, target)) {
 				glLoadName(index);
+				const bool pushed = pushWorldTransform(item);
 				item->renderPickingOverlayScene(renderer3D_.get());
+				if (pushed) glPopMatrix();
 				indexToGraphicsItemMap[index] = item;
 				++index;
 			}
@@ -554,11 +729,18 @@ GraphicsItemList GraphicsView::pickingUpOverlaySceneGrahicsItems(int x, int y)
 	glMatrixMode(GL_MODELVIEW);
 
 	// selectHitsGrahicsItem
-	return selectHitsGrahicsItems(hits, selectBuf, indexToGraphicsItemMap);
+	std::vector<double> depths;
+	GraphicsItemList selected = selectHitsGrahicsItems(hits, selectBuf, indexToGraphicsItemMap, &depths);
+	return mergePickedGrahicsItems(rayHits, selected, depths);
 }
 
-GraphicsItemList GraphicsView::pickingUpSceneGrahicsItems(int x, int y)
+GraphicsItemList GraphicsView::pickingUpSceneGrahicsItems(int x, int y, PickingTarget target)
 {
+	DepthItemList rayHits = rayPickingGrahicsItems(x, y, target, GraphicsItem::RayPicking::Scene);
+	if (!hasSelectPickingGrahicsItems(target)) {
+		return mergePickedGrahicsItems(rayHits, GraphicsItemList(), std::vector<double>());
+	}
+
 	std::map<int, GraphicsItemPtr> indexToGraphicsItemMap;
 	int index = 1;
 
@@ -584,19 +766,19 @@ GraphicsItemList GraphicsView::pickingUpSceneGrahicsItems(int x, int y)
 		glPushMatrix();
 		glLoadIdentity();
 		gluPickMatrix(x, viewport[3]-y, 5.0, 5.0, viewport); // ピッキング行列の乗算
-		float aspect = (float)viewport[2] / (float)viewport[3];
-		gluPerspective(perspectiveFovy_, aspect, perspectiveZnear_, perspectiveZfar_);	// ビューボリュームの再定義
+		glMultMatrixd(camera_->projectionMatrix().data());
 
 
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
-		camera_->update();					// カメラ再設定
-//		camera_->updateProject();
+		camera_->loadViewMatrix();			// the view of the last frame
 
 		for (auto item : traversedItems_) {
-			if (item->isVisible()) {
+			if (item->rayPicking() == GraphicsItem::RayPicking::None && acceptsPicking(item, target)) {
 				glLoadName(index);
+				const bool pushed = pushWorldTransform(item);
 				item->renderPickingScene(renderer3D_.get());
+				if (pushed) glPopMatrix();
 				indexToGraphicsItemMap[index] = item;
 				++index;
 			}
@@ -610,10 +792,145 @@ GraphicsItemList GraphicsView::pickingUpSceneGrahicsItems(int x, int y)
 	glMatrixMode(GL_MODELVIEW);
 
 	// selectHitsGrahicsItem
-	return selectHitsGrahicsItems(hits, selectBuf, indexToGraphicsItemMap);
+	std::vector<double> depths;
+	GraphicsItemList selected = selectHitsGrahicsItems(hits, selectBuf, indexToGraphicsItemMap, &depths);
+	return mergePickedGrahicsItems(rayHits, selected, depths);
+}
+
+GraphicsView::DepthItemList GraphicsView::rayPickingGrahicsItems(int x, int y, PickingTarget target, GraphicsItem::RayPicking pass)
+{
+	DepthItemList hits;
+
+	Eigen::Vector3d origin, dir;
+	bool rayReady = false;
+
+	std::vector<double> distances;
+	for (const auto& item : traversedItems_) {
+		if (item->rayPicking() != pass || !acceptsPicking(item, target)) continue;
+
+		if (!rayReady) {
+			camera_->unProjectRay(x, y, origin, dir);
+			rayReady = true;
+		}
+
+		// in the item frame. rigid, so the distance is the same
+		double distance;
+		bool hit;
+		if (item->isWorldIdentity()) {
+			hit = item->intersectRay(origin, dir, distance);
+		} else {
+			const Eigen::Matrix3d& R = item->worldAttitude();
+			hit = item->intersectRay(R.transpose() * (origin - item->worldPosition()), R.transpose() * dir, distance);
+		}
+		if (hit) {
+			hits.push_back(std::make_pair(0.0, item));
+			distances.push_back(distance);
+		}
+	}
+	if (hits.empty()) return hits;
+
+	// window depth, comparable with GL_SELECT hits
+	Eigen::Matrix3Xd points(3, hits.size());
+	for (size_t i = 0; i < hits.size(); ++i) {
+		points.col(i) = origin + distances[i] * dir;
+	}
+	Eigen::Matrix3Xd windows;
+	camera_->projectMany(points, windows);
+	for (size_t i = 0; i < hits.size(); ++i) {
+		hits[i].first = windows(2, i);
+	}
+
+	return hits;
+}
+
+bool GraphicsView::hasSelectPickingGrahicsItems(PickingTarget target) const
+{
+	for (const auto& item : traversedItems_) {
+		if (item->rayPicking() == GraphicsItem::RayPicking::None && acceptsPicking(item, target)) return true;
+	}
+	return false;
+}
+
+GraphicsItemList GraphicsView::mergePickedGrahicsItems(DepthItemList& rayHits, const GraphicsItemList& selected, const std::vector<double>& depths)
+{
+	for (size_t i = 0; i < selected.size(); ++i) {
+		rayHits.push_back(std::make_pair(depths[i], selected[i]));
+	}
+
+	// nearest first
+	std::stable_sort(rayHits.begin(), rayHits.end(), [](const DepthItemList::value_type& a, const DepthItemList::value_type& b){
+		return a.first < b.first;
+	});
+
+	GraphicsItemList items;
+	items.reserve(rayHits.size());
+	for (const auto& hit : rayHits) {
+		items.push_back(hit.second);
+	}
+	return items;
+}
+
+GraphicsItemList GraphicsView::pickingUp2DSceneGrahicsItems(int x, int y, PickingTarget target)
+{
+	if (hitTree2DDirty_) updateHitTree2D();
+
+	// rect items, topmost (last in traversal order) first
+	GraphicsItemList items;
+	int topOrder = -1;
+	hitTree2D_.query(x, y, hitIndices2D_);
+	for (auto itr = hitIndices2D_.rbegin(); itr != hitIndices2D_.rend(); ++itr) {
+		const GraphicsItemPtr& item = hitItems2D_[*itr];
+		if (acceptsPicking(item, target) && item->contains2D(x, y)) {
+			if (items.empty()) topOrder = hitOrder2D_[*itr];
+			items.push_back(item);
+		}
+	}
+
+	if (!hasSelectPicking2DItems_) return items;
+
+	// GL_SELECT items
+	GraphicsItemList selected = selectPicking2DSceneGrahicsItems(x, y, target);
+	if (selected.empty()) return items;
+	if (items.empty()) return selected;
+
+	const int selectedOrder = std::find(traversedItems_.begin(), traversedItems_.end(), selected.front()) - traversedItems_.begin();
+	if (selectedOrder > topOrder) {
+		selected.insert(selected.end(), items.begin(), items.end());
+		return selected;
+	}
+	items.insert(items.end(), selected.begin(), selected.end());
+	return items;
+}
+
+void GraphicsView::updateHitTree2D()
+{
+	std::vector<RectQuadTree::Rect> rects;
+
+	hitItems2D_.clear();
+	hitOrder2D_.clear();
+	hasSelectPicking2DItems_ = false;
+
+	for (size_t i = 0; i < traversedItems_.size(); ++i) {
+		const GraphicsItemPtr& item = traversedItems_[i];
+		if (!item->isVisible()) continue;
+		if (!item->acceptHoverEvents() && !item->acceptMouseEvents()) continue;
+
+		RectQuadTree::Rect rect;
+		if (item->boundingRect2D(rect.x, rect.y, rect.width, rect.height)) {
+			if (rect.width <= 0 || rect.height <= 0) continue;
+			rects.push_back(rect);
+			hitItems2D_.push_back(item);
+			hitOrder2D_.push_back(static_cast<int>(i));
+		} else if (item->isSelectPicking2D()) {
+			hasSelectPicking2DItems_ = true;
+		}
+	}
+
+	hitTree2D_.build(rects);
+	hitTree2DDirty_ = false;
 }
 
-GraphicsItemList GraphicsView::pickingUp2DSceneGrahicsItems(int x, int y)
+GraphicsItemList GraphicsView::selectPicking2DSceneGrahicsItems(int x, int y, PickingTarget target)
 {
 	std::map<int, GraphicsItemPtr> indexToGraphicsItemMap;
 	int index = 1;
@@ -645,9 +962,10 @@ GraphicsItemList GraphicsView::pickingUp2DSceneGrahicsItems(int x, int y)
 		glLoadIdentity();
 
 		for (auto item : traversedItems_) {
-			if (item->isVisible()) {
+			if (item->isSelectPicking2D() && acceptsPicking(item, target)) {
 				glLoadName(index);
 				item->renderPicking2DScene(renderer2D_.get());
+				renderer2D_->flush();	// draw before the name changes
 				indexToGraphicsItemMap[index] = item;
 				++index;
 			}
@@ -664,7 +982,8 @@ GraphicsItemList GraphicsView::pickingUp2DSceneGrahicsItems(int x, int y)
 	return selectHitsGrahicsItems(hits, selectBuf, indexToGraphicsItemMap);
 }
 
-GraphicsItemList GraphicsView::selectHitsGrahicsItems(GLuint hits, GLuint* buf, const std::map<int, GraphicsItemPtr>& indexToGraphicsItemMap)
+GraphicsItemList GraphicsView::selectHitsGrahicsItems(GLuint hits, GLuint* buf, const std::map<int, GraphicsItemPtr>& indexToGraphicsItemMap,
+		std::vector<double>* depths)
 {
 	GraphicsItemList pickedGraphicsItems;
 	std::map<GLuint, GraphicsItemPtr> depthGraphicsItemMap;
@@ -702,6 +1021,7 @@ GraphicsItemList GraphicsView::selectHitsGrahicsItems(GLuint hits, GLuint* buf,
 		if (pickedGraphicsItems.end() == std::find(pickedGraphicsItems.begin(), pickedGraphicsItems.end(), item)) {
 			if (item) {
 				pickedGraphicsItems.push_back(item);
+				if (depths) depths->push_back(itr->first / 4294967295.0);	// window depth [0, 1]
 			}
 		}
 	}
@@ -10,6 +10,7 @@
 #include <array>
 #include <string>
 #include <atomic>
+#include <chrono>
 #include <unordered_map>
 #include <boost/any.hpp>
 
@@ -23,11 +24,15 @@
 #include "Renderer2D.h"
 #include "TextRenderer.h"
 #include "Camera.h"
+#include "DepthReadback.h"
 #include "Light.h"
 
 #include "StandardCamera.h"
 #include "SphericalCamera.h"
 
+#include "tglUtil/RectQuadTree.h"
+#include "tglUtil/ChangeNotifier.h"
+
 namespace tgl {
 
 class GraphicsDriver;
@@ -52,6 +57,19 @@ public:
 	void setFrameRate(int fps);
 	int frameRate() const;
 
+	// rendering on demand (default off) : the driver draws a frame only when needsRedraw().
+	// input events and Widget::update() request a frame, call requestRedraw() after
+	// changing the scene from elsewhere
+	void setRenderOnDemand(bool on);
+	bool isRenderOnDemand() const { return renderOnDemand_; }
+	void requestRedraw();
+	bool needsRedraw() const;
+
+	// picking results are cached while the cursor stays on the same pixel and the scene
+	// does not change. camera, hierarchy and visibility changes and mouse events sent to
+	// items are detected, call this (or GraphicsItem::update()) after moving an item from elsewhere
+	void invalidatePicking() { ++pickingGeneration_; }
+
 	// Camera
 	void setCamera(CameraPtr camera);
 	CameraPtr camera() const { return camera_; }
@@ -71,6 +89,11 @@ public:
 	//  settings
 	void setBackgroundColor(double r, double g, double b, double a = 1.0);
 
+	// GL context group. views whose contexts share objects may use the same group
+	// so that per context resources (fonts, ...) are created once
+	void setGLContextGroup(const void* group);
+	const void* glContextGroup() const { return glContextGroup_; }
+
 	typedef std::unordered_map<std::string, boost::any> ExtentionsType;
 	ExtentionsType& extensions() { return extensions_; }
 	const ExtentionsType& extensions() const { return extensions_; }
@@ -114,14 +137,29 @@ protected:
 	void render2DSceneOfGrahicsItems();
 	void renderTextSceneOfGrahicsItems();
 
+	// coalesced changes of the items, once per frame
+	void deliverChangesOfGrahicsItems();
+
 	// picking event
-	GraphicsItemList pickingUpSceneGrahicsItems(int x, int y);
-	GraphicsItemList pickingUpOverlaySceneGrahicsItems(int x, int y);
-	GraphicsItemList pickingUp2DSceneGrahicsItems(int x, int y);
-	GraphicsItemList pickingUpGrahicsItems(int x, int y);
-	GraphicsItemList selectHitsGrahicsItems(GLuint hits, GLuint* buf, const std::map<int, GraphicsItemPtr>& indexToGraphicsItemMap);
+	// only items interested in the event of the target are picked
+	enum class PickingTarget { Hover, Mouse, Any };
+	static bool acceptsPicking(const GraphicsItemPtr& item, PickingTarget target);
+	GraphicsItemList pickingUpSceneGrahicsItems(int x, int y, PickingTarget target);
+	GraphicsItemList pickingUpOverlaySceneGrahicsItems(int x, int y, PickingTarget target);
+	GraphicsItemList pickingUp2DSceneGrahicsItems(int x, int y, PickingTarget target);
+	GraphicsItemList selectPicking2DSceneGrahicsItems(int x, int y, PickingTarget target);
+	GraphicsItemList pickingUpGrahicsItems(int x, int y, PickingTarget target);
+	GraphicsItemList selectHitsGrahicsItems(GLuint hits, GLuint* buf, const std::map<int, GraphicsItemPtr>& indexToGraphicsItemMap,
+			std::vector<double>* depths = nullptr);
+
+	// analytic picking of the items with GraphicsItem::setRayPicking(), merged with GL_SELECT hits by window depth
+	typedef std::vector<std::pair<double, GraphicsItemPtr>> DepthItemList;
+	DepthItemList rayPickingGrahicsItems(int x, int y, PickingTarget target, GraphicsItem::RayPicking pass);
+	bool hasSelectPickingGrahicsItems(PickingTarget target) const;
+	static GraphicsItemList mergePickedGrahicsItems(DepthItemList& rayHits, const GraphicsItemList& selected, const std::vector<double>& depths);
 
 	void traverseGraphicsItems(GraphicsItemList& items);
+	void updateHitTree2D();
 
 	std::unique_ptr<Renderer3D> renderer3D_;
 	std::unique_ptr<Renderer2D> renderer2D_;
@@ -130,6 +168,8 @@ protected:
 	CameraPtr camera_;
 	std::vector<LightPtr> lightList_;
 
+	DepthReadbackPtr depthReadback_;	// scene depth of the previous frame, for Camera::unProject
+
 	int frameRate_;
 
 	float perspectiveFovy_;		// 縦の視野角を”度”単位
@@ -156,10 +196,42 @@ protected:
 	std::unique_ptr<GraphicsItemSelectEvent> graphicsItemSelectEvent_;
 
 	std::vector<GraphicsItemPtr> traversedItems_;
+	int numHoverItems_;		// visible items accepting hover events, counted on traversal
+	int numMouseItems_;		// visible items accepting mouse events
+	GraphicsItemList prevTraversedItems_;
+
+	// picking cache. results of each pass (2D, overlay, scene) for all interested items,
+	// filtered by target on use so that move and press on the same pixel pick once
+	struct PickingCache {
+		int x, y;
+		unsigned int generation;
+		std::array<bool, 3> valid;
+		std::array<GraphicsItemList, 3> items;
+	};
+	PickingCache pickingCache_;
+	std::atomic<unsigned int> pickingGeneration_;
+	std::array<double, 16> pickingView_;			// camera of the cached generation
+	std::array<double, 16> pickingProjection_;
+
+	// 2D hit test, rebuilt on the first picking after traversal
+	RectQuadTree hitTree2D_;
+	std::vector<GraphicsItemPtr> hitItems2D_;
+	std::vector<int> hitOrder2D_;		// index in traversedItems_
+	std::vector<int> hitIndices2D_;
+	bool hitTree2DDirty_;
+	bool hasSelectPicking2DItems_;
 
 	// extensions
 	ExtentionsType extensions_;
 
+	const void* glContextGroup_;
+
+	// rendering on demand
+	std::atomic<bool> renderOnDemand_;
+	std::atomic<bool> redrawRequested_;
+	std::chrono::steady_clock::time_point frameTime_;
+	bool firstFrame_;
+
 	// driver
 	std::atomic<bool> initialized_;
 	std::unique_ptr<GraphicsDriver> driver_;
@@ -2,9 +2,15 @@
  * Renderer2D.cpp
  */
 
-#include <boost/filesystem.hpp>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <GL/gl.h>
+#include <GL/glext.h>
 #include <FTGL/ftgl.h>
 #include "GraphicsView.h"
+#include "FontRegistry.h"
+#include "UnitCircleTable.h"
 #include "Renderer2D.h"
 
 #include <iostream>
@@ -30,12 +36,31 @@ Renderer2D::Renderer2D(GraphicsView* view) : graphicsView_(view) {
 	textColor_[2] = 1;
 	textColor_[3] = 1;
 
-	circleQuality_ = 40;
+	circleQuality_ = 0;		// auto
+
+	fill_ = true;
+	stroke_ = true;
+	strokeWeight_ = 1;
+	pointSize_ = 1;
+
+	transform_.a = 1; transform_.b = 0;
+	transform_.c = 0; transform_.d = 1;
+	transform_.tx = 0; transform_.ty = 0;
 
 	align_ = Align::Left;
 	valign_ = VAlign::Bottom;
 	textSize_ = 16;
-	loadFont(defaultFontPath);
+	font_ = nullptr;
+	fontPath_ = defaultFontPath;
+
+	numBatches_ = 0;
+	primitive_.mode = GL_TRIANGLES;
+	primitive_.size = 0;
+
+	currentLayer_ = nullptr;
+	prevFramebuffer_ = 0;
+	layerSupported_ = true;
+	frame_ = 0;
 }
 
 Renderer2D::~Renderer2D() {
@@ -45,68 +70,52 @@ Renderer2D::~Renderer2D() {
 // Primitive shapes
 void Renderer2D::drawPoint(int x, int y)
 {
-	setColor(fillColor_);
+	GLubyte c[4];
+	packColor(fillColor_, c);
 
-	glBegin(GL_POINTS);
-	glVertex3i(x, y, 0);
-	glEnd();
+	beginBatch(GL_POINTS, pointSize_);
+	addVertex(x, y, c);
 }
 
 void Renderer2D::drawLine(int x1, int y1, int x2, int y2)
 {
-	setColor(strokeColor_);
+	GLubyte c[4];
+	packColor(strokeColor_, c);
 
-	glBegin(GL_LINES);
-	glVertex3i(x1, y1, 0);
-	glVertex3i(x2, y2, 0);
-	glEnd();
+	beginBatch(GL_LINES, strokeWeight_);
+	addVertex(x1, y1, c);
+	addVertex(x2, y2, c);
 }
 
 void Renderer2D::drawTriangle(int x1, int y1, int x2, int y2, int x3, int y3)
 {
-	if (fill_) {
-		setColor(fillColor_);
+	outline_.assign({double(x1), double(y1), double(x2), double(y2), double(x3), double(y3)});
 
-		glBegin(GL_POLYGON);
-		glVertex3i(x1, y1, 0);
-		glVertex3i(x2, y2, 0);
-		glVertex3i(x3, y3, 0);
-		glEnd();
+	GLubyte c[4];
+	if (fill_) {
+		packColor(fillColor_, c);
+		addPolygon(outline_, c);
 	}
 
 	if (stroke_) {
-		setColor(strokeColor_);
-
-		glBegin(GL_LINE_LOOP);
-		glVertex3i(x1, y1, 0);
-		glVertex3i(x2, y2, 0);
-		glVertex3i(x3, y3, 0);
-		glEnd();
+		packColor(strokeColor_, c);
+		addLineLoop(outline_, c);
 	}
 }
 
 void Renderer2D::drawQuad(int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4)
 {
+	outline_.assign({double(x1), double(y1), double(x2), double(y2), double(x3), double(y3), double(x4), double(y4)});
+
+	GLubyte c[4];
 	if (fill_) {
-		setColor(fillColor_);
-
-		glBegin(GL_POLYGON);
-		glVertex3i(x1, y1, 0);
-		glVertex3i(x2, y2, 0);
-		glVertex3i(x3, y3, 0);
-		glVertex3i(x4, y4, 0);
-		glEnd();
+		packColor(fillColor_, c);
+		addPolygon(outline_, c);
 	}
 
 	if (stroke_) {
-		setColor(strokeColor_);
-
-		glBegin(GL_LINE_LOOP);
-		glVertex3i(x1, y1, 0);
-		glVertex3i(x2, y2, 0);
-		glVertex3i(x3, y3, 0);
-		glVertex3i(x4, y4, 0);
-		glEnd();
+		packColor(strokeColor_, c);
+		addLineLoop(outline_, c);
 	}
 }
 
@@ -127,149 +136,60 @@ void Renderer2D::drawRect(int x, int y, int w, int h)
 
 void Renderer2D::drawEllipse(int x, int y, int width, int height)
 {
-	const double r = 1.0;
-
-	glPushMatrix();
-	glTranslatef(x, y, 0);
-	glScalef(width, height, 0);
+	// the outline is shared by the fill and the stroke
+	calcEllipse(outline_, x, y, width, height, circleSegments(std::max(width, height)));
 
+	GLubyte c[4];
 	if (fill_) {
-		setColor(fillColor_);
-
-		glBegin(GL_POLYGON); // ポリゴンの描画
-		// 円を描画
-		for (int i = 0; i < circleQuality_; i++) {
-			// 座標を計算
-			double rate = (double)i / circleQuality_;
-			double x = r * cos(2.0 * M_PI * rate);
-			double y = r * sin(2.0 * M_PI * rate);
-			glVertex3d(x, y, 0.0); // 頂点座標を指定
-		}
-		glEnd(); // ポリゴンの描画終了
+		packColor(fillColor_, c);
+		addPolygon(outline_, c);
 	}
 
 	if (stroke_) {
-		setColor(strokeColor_);
-
-		glBegin(GL_LINE_LOOP);
-		// 円を描画
-		for (int i = 0; i < circleQuality_; i++) {
-			// 座標を計算
-			double rate = (double)i / circleQuality_;
-			double x = r * cos(2.0 * M_PI * rate);
-			double y = r * sin(2.0 * M_PI * rate);
-			glVertex3d(x, y, 0.0); // 頂点座標を指定
-		}
-		glEnd(); // ポリゴンの描画終了
+		packColor(strokeColor_, c);
+		addLineLoop(outline_, c);
 	}
-
-	glPopMatrix();
 }
 
 void Renderer2D::drawCircle(int x, int y, int radius)
 {
-	const double r = radius;
-
-	glPushMatrix();
-	glTranslatef(x, y, 0);
-
-	if (fill_) {
-		setColor(fillColor_);
-
-		glBegin(GL_POLYGON); // ポリゴンの描画
-		// 円を描画
-		for (int i = 0; i < circleQuality_; i++) {
-			// 座標を計算
-			double rate = (double)i / circleQuality_;
-			double x = r * cos(2.0 * M_PI * rate);
-			double y = r * sin(2.0 * M_PI * rate);
-			glVertex3d(x, y, 0.0); // 頂点座標を指定
-		}
-		glEnd(); // ポリゴンの描画終了
-	}
-
-	if (stroke_) {
-		setColor(strokeColor_);
-
-		glBegin(GL_LINE_LOOP);
-		// 円を描画
-		for (int i = 0; i < circleQuality_; i++) {
-			// 座標を計算
-			double rate = (double)i / circleQuality_;
-			double x = r * cos(2.0 * M_PI * rate);
-			double y = r * sin(2.0 * M_PI * rate);
-			glVertex3d(x, y, 0.0); // 頂点座標を指定
-		}
-		glEnd(); // ポリゴンの描画終了
-	}
-
-	glPopMatrix();
+	drawEllipse(x, y, radius, radius);
 }
 
 void Renderer2D::drawRing(int x, int y, int outer_radius, int inner_radius)
 {
-	glPushMatrix();
-	glTranslatef(x, y, 0);
+	const int n = circleSegments(std::max(outer_radius, inner_radius));
+	calcEllipse(outline_, x, y, outer_radius, outer_radius, n);
+	calcEllipse(innerOutline_, x, y, inner_radius, inner_radius, n);
 
+	GLubyte c[4];
 	if (fill_) {
-		setColor(fillColor_);
-
-		glBegin(GL_QUAD_STRIP); // ポリゴンの描画
-		// 円を描画
-		for (int i = 0; i <= circleQuality_; i++) {
-			// 座標を計算
-			double rate = (double)i / circleQuality_;
-			double c = cos(2.0 * M_PI * rate);
-			double s = sin(2.0 * M_PI * rate);
-
-			double ox = outer_radius * c;
-			double oy = outer_radius * s;
-
-			double ix = inner_radius * c;
-			double iy = inner_radius * s;
-
-			glVertex3d(ix, iy, 0.0); // 頂点座標を指定
-			glVertex3d(ox, oy, 0.0); // 頂点座標を指定
-//			glVertex3d(ix, iy, 0.0); // 頂点座標を指定
+		packColor(fillColor_, c);
+
+		beginBatch(GL_TRIANGLES, 0);
+		const size_t n = outline_.size() / 2;
+		for (size_t i = 0; i < n; ++i) {
+			const size_t j = (i + 1) % n;
+			const double* o0 = &outline_[i*2];
+			const double* o1 = &outline_[j*2];
+			const double* i0 = &innerOutline_[i*2];
+			const double* i1 = &innerOutline_[j*2];
+
+			addVertex(i0[0], i0[1], c);
+			addVertex(o0[0], o0[1], c);
+			addVertex(o1[0], o1[1], c);
+
+			addVertex(i0[0], i0[1], c);
+			addVertex(o1[0], o1[1], c);
+			addVertex(i1[0], i1[1], c);
 		}
-		glEnd(); // ポリゴンの描画終了
 	}
 
 	if (stroke_) {
-		setColor(strokeColor_);
-
-		glBegin(GL_LINE_LOOP);
-		// 円を描画
-		for (int i = 0; i < circleQuality_; i++) {
-			// 座標を計算
-			double rate = (double)i / circleQuality_;
-			double c = cos(2.0 * M_PI * rate);
-			double s = sin(2.0 * M_PI * rate);
-
-			double ix = inner_radius * c;
-			double iy = inner_radius * s;
-
-			glVertex3d(ix, iy, 0.0); // 頂点座標を指定
-		}
-		glEnd(); // ポリゴンの描画終了
-
-		glBegin(GL_LINE_LOOP);
-		// 円を描画
-		for (int i = 0; i < circleQuality_; i++) {
-			// 座標を計算
-			double rate = (double)i / circleQuality_;
-			double c = cos(2.0 * M_PI * rate);
-			double s = sin(2.0 * M_PI * rate);
-
-			double ox = outer_radius * c;
-			double oy = outer_radius * s;
-
-			glVertex3d(ox, oy, 0.0); // 頂点座標を指定
-		}
-		glEnd(); // ポリゴンの描画終了
+		packColor(strokeColor_, c);
+		addLineLoop(innerOutline_, c);
+		addLineLoop(outline_, c);
 	}
-
-	glPopMatrix();
 }
 
 // Curves
@@ -281,6 +201,8 @@ void Renderer2D::drawBezier(int x, int y, int cx1, int cy1, int cx2, int cy2, in
 // Attributes
 void Renderer2D::setSmooth(bool on)
 {
+	flush();
+
 	if (on) {
 		glEnable(GL_LINE_SMOOTH);	// アンチエイリアス
 		glEnable(GL_POINT_SMOOTH);
@@ -335,12 +257,12 @@ void Renderer2D::setNoStroke()
 
 void Renderer2D::setStrokeWeight(int w)
 {
-	glLineWidth(w);
+	strokeWeight_ = w;
 }
 
 void Renderer2D::setPointSize(int s)
 {
-	glPointSize(s);
+	pointSize_ = s;
 }
 
 void Renderer2D::setTextAlign(Align align, VAlign vAlign)
@@ -351,9 +273,9 @@ void Renderer2D::setTextAlign(Align align, VAlign vAlign)
 
 void Renderer2D::setTextSize(int size)
 {
+	if (textSize_ == size) return;
 	textSize_ = size;
-	if (!font_) return;
-	font_->FaceSize(size);
+	font_ = nullptr;
 }
 
 int Renderer2D::textSize() const
@@ -363,12 +285,25 @@ int Renderer2D::textSize() const
 
 void Renderer2D::loadFont(const std::string& path)
 {
-	boost::filesystem::path fpath(path);
-	if (boost::filesystem::exists(fpath)) {
-		fontPath_ = path;
-		font_ = FTFontPtr(new FTExtrudeFont(fontPath_.c_str()));
-		font_->FaceSize(textSize_);
+	// read on a worker thread, the current font is used until the face is ready
+	pendingFont_ = std::make_shared<FontResource>(path);
+	ResourceLoader::instance().load(pendingFont_);
+}
+
+FTFont* Renderer2D::font()
+{
+	if (pendingFont_ && !pendingFont_->isPending()) {
+		if (pendingFont_->isReady()) {
+			fontPath_ = pendingFont_->path();
+			font_ = nullptr;
+		}
+		pendingFont_.reset();
 	}
+
+	if (!font_ && graphicsView_) {
+		font_ = FontRegistry::instance().font(graphicsView_->glContextGroup(), fontPath_, textSize_);
+	}
+	return font_;
 }
 
 void Renderer2D::setTextColor(double r, double g, double b, double a)
@@ -381,13 +316,14 @@ void Renderer2D::setTextColor(double r, double g, double b, double a)
 
 void Renderer2D::drawText(int x, int y, const std::string& str)
 {
-	if (!font_) {
+	FTFont* font = this->font();
+	if (!font) {
 		std::cerr << "error : Renderer2D::drawText font is null" << std::endl;
 		return;
 	}
 
 	// text align の設定
-	FTBBox bb = font_->BBox(str.c_str());
+	FTBBox bb = font->BBox(str.c_str());
 	const int w = abs(bb.Lower().X() - bb.Upper().X());
 	const int h = abs(bb.Lower().Y() - bb.Upper().Y());
 	int sx, sy;
@@ -406,15 +342,27 @@ void Renderer2D::drawText(int x, int y, const std::string& str)
 	default: sy = 0; break;
 	}
 
-	setColor(textColor_);
+	// text is drawn by FTGL, draw the shapes below it first
+	flush();
+
+	glColor4dv(textColor_);
 
 	glEnable(GL_POLYGON_SMOOTH);
 
+	const Transform& t = transform_;
+	const GLdouble m[16] = {
+		t.a,  t.b,  0, 0,
+		t.c,  t.d,  0, 0,
+		0,    0,    1, 0,
+		t.tx, t.ty, 0, 1
+	};
+
 	glPushMatrix();
+	glMultMatrixd(m);
 	glTranslatef(x + sx, y + sy, 0);
 	glScalef(1,-1,1);
 
-	font_->Render(str.c_str());
+	font->Render(str.c_str());
 
 	glPopMatrix();
 
@@ -423,36 +371,47 @@ void Renderer2D::drawText(int x, int y, const std::string& str)
 
 void Renderer2D::pushMatrix()
 {
-	glPushMatrix();
+	transformStack_.push_back(transform_);
 }
 void Renderer2D::popMatrix()
 {
-	glPopMatrix();
+	if (transformStack_.empty()) return;
+
+	transform_ = transformStack_.back();
+	transformStack_.pop_back();
 }
 
 void Renderer2D::translate(int x, int y)
 {
-	glTranslated(x, y, 0);
+	Transform& t = transform_;
+	t.tx += t.a * x + t.c * y;
+	t.ty += t.b * x + t.d * y;
 }
 
 void Renderer2D::rotate(double degree)
 {
-	glRotated(degree, 0,0,1);
+	const double rad = degree * M_PI / 180.0;
+	const double cs = cos(rad);
+	const double sn = sin(rad);
+
+	Transform& t = transform_;
+	const double a = t.a * cs + t.c * sn;
+	const double b = t.b * cs + t.d * sn;
+	const double c = -t.a * sn + t.c * cs;
+	const double d = -t.b * sn + t.d * cs;
+	t.a = a; t.b = b; t.c = c; t.d = d;
 }
 
 void Renderer2D::scale(double scale)
 {
-	glScaled(scale, scale, 1.0);
+	this->scale(scale, scale);
 }
 
 void Renderer2D::scale(double scaleX, double scaleY)
 {
-	glScaled(scaleX, scaleY, 1.0);
-}
-
-void Renderer2D::setColor(double color[4])
-{
-	glColor4dv(color);
+	Transform& t = transform_;
+	t.a *= scaleX; t.b *= scaleX;
+	t.c *= scaleY; t.d *= scaleY;
 }
 
 int Renderer2D::viewWidth() const
@@ -465,5 +424,352 @@ int Renderer2D::viewHeight() const
 	return graphicsView_ ? graphicsView_->height() : 0;
 }
 
+// vertex stream
+void Renderer2D::beginBatch(GLenum mode, int size)
+{
+	commitBatch();
+
+	primitive_.mode = mode;
+	primitive_.size = mode == GL_TRIANGLES ? 0 : size;
+	primitive_.bounds[0] = primitive_.bounds[1] = std::numeric_limits<GLfloat>::max();
+	primitive_.bounds[2] = primitive_.bounds[3] = -std::numeric_limits<GLfloat>::max();
+}
+
+void Renderer2D::commitBatch()
+{
+	Batch& p = primitive_;
+	if (p.vertices.empty()) return;
+
+	// wide lines and points cover pixels around their vertices
+	const GLfloat margin = 0.5f * p.size + 1.0f;
+	p.bounds[0] -= margin; p.bounds[1] -= margin;
+	p.bounds[2] += margin; p.bounds[3] += margin;
+
+	// latest batch of the state, unless a batch after it overlaps the primitive
+	size_t target = numBatches_;
+	for (size_t i = numBatches_; i-- > 0; ) {
+		const Batch& batch = batches_[i];
+		if (batch.mode == p.mode && batch.size == p.size) {
+			target = i;
+			break;
+		}
+		if (batch.bounds[0] <= p.bounds[2] && p.bounds[0] <= batch.bounds[2] &&
+				batch.bounds[1] <= p.bounds[3] && p.bounds[1] <= batch.bounds[3]) break;
+	}
+
+	if (target == numBatches_) {
+		if (numBatches_ == batches_.size()) batches_.emplace_back();
+		Batch& batch = batches_[numBatches_++];
+		batch.mode = p.mode;
+		batch.size = p.size;
+		batch.vertices.clear();
+		std::copy(p.bounds, p.bounds + 4, batch.bounds);
+	}
+
+	Batch& batch = batches_[target];
+	batch.vertices.insert(batch.vertices.end(), p.vertices.begin(), p.vertices.end());
+	batch.bounds[0] = std::min(batch.bounds[0], p.bounds[0]);
+	batch.bounds[1] = std::min(batch.bounds[1], p.bounds[1]);
+	batch.bounds[2] = std::max(batch.bounds[2], p.bounds[2]);
+	batch.bounds[3] = std::max(batch.bounds[3], p.bounds[3]);
+	p.vertices.clear();
+}
+
+void Renderer2D::addVertex(double x, double y, const GLubyte color[4])
+{
+	const Transform& t = transform_;
+
+	Vertex v;
+	v.x = t.a * x + t.c * y + t.tx;
+	v.y = t.b * x + t.d * y + t.ty;
+	v.color[0] = color[0];
+	v.color[1] = color[1];
+	v.color[2] = color[2];
+	v.color[3] = color[3];
+
+	primitive_.vertices.push_back(v);
+	GLfloat* bounds = primitive_.bounds;
+	bounds[0] = std::min(bounds[0], v.x);
+	bounds[1] = std::min(bounds[1], v.y);
+	bounds[2] = std::max(bounds[2], v.x);
+	bounds[3] = std::max(bounds[3], v.y);
+}
+
+// convex polygon as a triangle fan
+void Renderer2D::addPolygon(const std::vector<double>& xy, const GLubyte color[4])
+{
+	const size_t n = xy.size() / 2;
+	if (n < 3) return;
+
+	beginBatch(GL_TRIANGLES, 0);
+	for (size_t i = 1; i + 1 < n; ++i) {
+		addVertex(xy[0], xy[1], color);
+		addVertex(xy[i*2], xy[i*2+1], color);
+		addVertex(xy[i*2+2], xy[i*2+3], color);
+	}
+}
+
+void Renderer2D::addLineLoop(const std::vector<double>& xy, const GLubyte color[4])
+{
+	const size_t n = xy.size() / 2;
+	if (n < 2) return;
+
+	beginBatch(GL_LINES, strokeWeight_);
+	for (size_t i = 0; i < n; ++i) {
+		const size_t j = (i + 1) % n;
+		addVertex(xy[i*2], xy[i*2+1], color);
+		addVertex(xy[j*2], xy[j*2+1], color);
+	}
+}
+
+int Renderer2D::circleSegments(double radius) const
+{
+	if (circleQuality_ > 0) return circleQuality_;
+
+	// radius on the screen
+	const Transform& t = transform_;
+	const double s = std::max(std::sqrt(t.a*t.a + t.b*t.b), std::sqrt(t.c*t.c + t.d*t.d));
+	return UnitCircleTable::segmentsForRadius(std::abs(radius) * s);
+}
+
+void Renderer2D::calcEllipse(std::vector<double>& xy, double x, double y, double rx, double ry, int n)
+{
+	const UnitCircleTable& table = UnitCircleTable::get(n);
+	const double* cost = table.cost();
+	const double* sint = table.sint();
+	n = table.segments();
+
+	xy.resize(n * 2);
+	for (int i = 0; i < n; i++) {
+		xy[i*2] = x + rx * cost[i];
+		xy[i*2+1] = y + ry * sint[i];
+	}
+}
+
+void Renderer2D::packColor(const double color[4], GLubyte c[4])
+{
+	for (int i = 0; i < 4; ++i) {
+		double v = color[i] < 0.0 ? 0.0 : (color[i] > 1.0 ? 1.0 : color[i]);
+		c[i] = static_cast<GLubyte>(v * 255.0 + 0.5);
+	}
+}
+
+void Renderer2D::flush()
+{
+	commitBatch();
+
+	vertices_.clear();
+	for (size_t i = 0; i < numBatches_; ++i) {
+		const std::vector<Vertex>& v = batches_[i].vertices;
+		vertices_.insert(vertices_.end(), v.begin(), v.end());
+	}
+
+	if (vertices_.empty()) {
+		numBatches_ = 0;
+		return;
+	}
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices_[0].x);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), vertices_[0].color);
+
+	GLint first = 0;
+	for (size_t i = 0; i < numBatches_; ++i) {
+		const Batch& batch = batches_[i];
+		const GLsizei count = batch.vertices.size();
+		if (count == 0) continue;
+
+		if (batch.mode == GL_LINES) {
+			glLineWidth(batch.size);
+		} else if (batch.mode == GL_POINTS) {
+			glPointSize(batch.size);
+		}
+		glDrawArrays(batch.mode, first, count);
+		first += count;
+	}
+
+	glPopClientAttrib();
+
+	vertices_.clear();
+	numBatches_ = 0;
+}
+
+// Offscreen layers
+namespace {
+// layers not used for this number of frames are released
+const unsigned int unusedLayerFrames = 120;
+}
+
+bool Renderer2D::createLayer(Layer& layer, int width, int height)
+{
+	layer.width = width;
+	layer.height = height;
+
+	glPushAttrib(GL_TEXTURE_BIT);
+	glGenTextures(1, &layer.texture);
+	glBindTexture(GL_TEXTURE_2D, layer.texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);	// drawn 1:1 on integer positions
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glPopAttrib();
+
+	glGenFramebuffers(1, &layer.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture, 0);
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, prevFramebuffer_);
+
+	if (layer.framebuffer == 0 || status != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "error : Renderer2D offscreen layer is not supported" << std::endl;
+		deleteLayer(layer);
+		layerSupported_ = false;
+		return false;
+	}
+
+	return true;
+}
+
+void Renderer2D::deleteLayer(Layer& layer)
+{
+	if (layer.framebuffer) glDeleteFramebuffers(1, &layer.framebuffer);
+	if (layer.texture) glDeleteTextures(1, &layer.texture);
+	layer.framebuffer = 0;
+	layer.texture = 0;
+}
+
+bool Renderer2D::beginLayer(const void* key, int width, int height)
+{
+	if (!layerSupported_ || currentLayer_ || width <= 0 || height <= 0) return false;
+
+	flush();
+
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFramebuffer_);
+
+	auto itr = layers_.find(key);
+	if (itr != layers_.end() && (itr->second.width != width || itr->second.height != height)) {
+		deleteLayer(itr->second);
+		layers_.erase(itr);
+		itr = layers_.end();
+	}
+	if (itr == layers_.end()) {
+		Layer layer = {0, 0, 0, 0, 0};
+		if (!createLayer(layer, width, height)) return false;
+		itr = layers_.insert(std::make_pair(key, layer)).first;
+	}
+
+	Layer& layer = itr->second;
+	layer.lastUsedFrame = frame_;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+
+	glPushAttrib(GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT);
+	glViewport(0, 0, width, height);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, width, height, 0, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// premultiplied alpha : the texture is composited with (ONE, ONE_MINUS_SRC_ALPHA)
+	// and gives the same result as drawing directly with (SRC_ALPHA, ONE_MINUS_SRC_ALPHA)
+	glEnable(GL_BLEND);
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	layerTransform_ = transform_;
+	layerTransformStack_.swap(transformStack_);
+	transformStack_.clear();
+	transform_.a = 1; transform_.b = 0;
+	transform_.c = 0; transform_.d = 1;
+	transform_.tx = 0; transform_.ty = 0;
+
+	currentLayer_ = key;
+	return true;
+}
+
+void Renderer2D::endLayer()
+{
+	if (!currentLayer_) return;
+
+	flush();
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	glPopAttrib();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, prevFramebuffer_);
+
+	transform_ = layerTransform_;
+	transformStack_.swap(layerTransformStack_);
+	layerTransformStack_.clear();
+
+	currentLayer_ = nullptr;
+}
+
+bool Renderer2D::hasLayer(const void* key, int width, int height) const
+{
+	auto itr = layers_.find(key);
+	return itr != layers_.end() && itr->second.width == width && itr->second.height == height;
+}
+
+void Renderer2D::drawLayer(const void* key, int x, int y)
+{
+	auto itr = layers_.find(key);
+	if (itr == layers_.end()) return;
+
+	flush();
+
+	Layer& layer = itr->second;
+	layer.lastUsedFrame = frame_;
+
+	const Transform& t = transform_;
+	const double xs[4] = {double(x), double(x), double(x + layer.width), double(x + layer.width)};
+	const double ys[4] = {double(y), double(y + layer.height), double(y + layer.height), double(y)};
+	const GLfloat us[4] = {0, 0, 1, 1};
+	const GLfloat vs[4] = {1, 0, 0, 1};		// texture rows are bottom-up
+
+	glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, layer.texture);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	glBegin(GL_QUADS);
+	for (int i = 0; i < 4; ++i) {
+		glTexCoord2f(us[i], vs[i]);
+		glVertex2d(t.a * xs[i] + t.c * ys[i] + t.tx, t.b * xs[i] + t.d * ys[i] + t.ty);
+	}
+	glEnd();
+
+	glPopAttrib();
+}
+
+void Renderer2D::endFrame()
+{
+	flush();
+
+	for (auto itr = layers_.begin(); itr != layers_.end(); ) {
+		if (frame_ - itr->second.lastUsedFrame > unusedLayerFrames) {
+			deleteLayer(itr->second);
+			itr = layers_.erase(itr);
+		} else {
+			++itr;
+		}
+	}
+
+	++frame_;
+}
 
 } /* namespace tgl */
@@ -6,8 +6,11 @@
 #define TGL_CORE_RENDERER2D_H_
 
 #include <string>
+#include <vector>
 #include <memory>
+#include <unordered_map>
 #include <GL/gl.h>
+#include "FontRegistry.h"
 
 class FTFont;
 
@@ -64,6 +67,8 @@ public:
 	void setStrokeWeight(int w);
 	void setPointSize(int s);
 
+	// number of segments of circles, ellipses and rings.
+	// 0 (default) chooses it from the radius on the screen
 	void setCircleQuality(int q) { circleQuality_ = q; }
 	int circleQuality() const { return circleQuality_; }
 
@@ -75,6 +80,10 @@ public:
 	void loadFont(const std::string& path);
 	void drawText(int x, int y, const std::string& str);
 
+	// forget the cached font, it is resolved again on the next text.
+	// called by GraphicsView when the GL context group changes
+	void resetFont() { font_ = nullptr; }
+
 	// transforms
 	void pushMatrix();
 	void popMatrix();
@@ -87,8 +96,66 @@ public:
 	int viewWidth() const;
 	int viewHeight() const;
 
+	// draw the accumulated shapes
+	void flush();
+
+	// Offscreen layers
+	// shapes and text between beginLayer() and endLayer() are drawn into a texture identified by key,
+	// in layer coordinates (0, 0)-(width, height). returns false if the layer can not be created.
+	// a layer which is neither drawn nor updated for a while is released by endFrame()
+	bool beginLayer(const void* key, int width, int height);
+	void endLayer();
+	bool hasLayer(const void* key, int width, int height) const;
+	void drawLayer(const void* key, int x, int y);
+
+	// flush and release unused layers. called by GraphicsView at the end of the 2D pass
+	void endFrame();
+
 private:
-	void setColor(double color[4]);
+	// vertex stream
+	struct Vertex {
+		GLfloat x, y;
+		GLubyte color[4];
+	};
+
+	// one batch per state (mode and width) until flush(). a primitive joins an earlier batch of
+	// its state only if it overlaps none of the batches drawn after it, so that the fills and
+	// strokes of separate shapes take one call each and overlapping shapes keep painter's order
+	struct Batch {
+		GLenum mode;
+		int size;		// line width or point size
+		std::vector<Vertex> vertices;
+		GLfloat bounds[4];	// min x, min y, max x, max y
+	};
+
+	// 2D affine transform [a c tx; b d ty]
+	struct Transform {
+		double a, b, c, d, tx, ty;
+	};
+
+	// texture with premultiplied alpha and its framebuffer
+	struct Layer {
+		GLuint framebuffer;
+		GLuint texture;
+		int width;
+		int height;
+		unsigned int lastUsedFrame;
+	};
+
+	void beginBatch(GLenum mode, int size);
+	void commitBatch();
+	void addVertex(double x, double y, const GLubyte color[4]);
+	void addPolygon(const std::vector<double>& xy, const GLubyte color[4]);
+	void addLineLoop(const std::vector<double>& xy, const GLubyte color[4]);
+	int circleSegments(double radius) const;
+	void calcEllipse(std::vector<double>& xy, double x, double y, double rx, double ry, int n);
+	static void packColor(const double color[4], GLubyte c[4]);
+
+	bool createLayer(Layer& layer, int width, int height);
+	void deleteLayer(Layer& layer);
+
+	FTFont* font();
+
 	GraphicsView* graphicsView_;
 
 	double fillColor_[4];
@@ -107,13 +174,32 @@ private:
 
 	double textColor_[4];
 
-	typedef std::unique_ptr<FTFont> FTFontPtr;
-	FTFontPtr font_;
+	FTFont* font_;		// owned by FontRegistry, resolved on first use
 	std::string fontPath_;
+	FontResourcePtr pendingFont_;	// loadFont() in progress
 	int textSize_;
 
 	int strokeWeight_;
 	int pointSize_;
+
+	std::vector<Vertex> vertices_;		// batches joined by flush()
+	std::vector<Batch> batches_;		// storage is kept across flushes
+	size_t numBatches_;
+	Batch primitive_;		// vertices since beginBatch(), placed by commitBatch()
+	std::vector<double> outline_;
+	std::vector<double> innerOutline_;
+
+	Transform transform_;
+	std::vector<Transform> transformStack_;
+
+	// layers (GL objects are owned by the context, they are not deleted in the destructor)
+	std::unordered_map<const void*, Layer> layers_;
+	const void* currentLayer_;
+	GLint prevFramebuffer_;
+	Transform layerTransform_;			// saved while drawing into a layer
+	std::vector<Transform> layerTransformStack_;
+	bool layerSupported_;
+	unsigned int frame_;
 };
 
 } /* namespace tgl */
@@ -3,7 +3,11 @@
  */
 
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include "GraphicsView.h"
+#include "UnitCircleTable.h"
+#include "UnitPrimitiveMeshes.h"
 #include "Renderer3D.h"
 
 #include <iostream>
@@ -19,6 +23,9 @@ Renderer3D::Renderer3D(GraphicsView* view) {
 	capsuleQuality_ = 24;
 	cylinderQuality_ = 24;
 	circleQuality_ = 24;
+	qualityTolerance_ = 0.25;
+	projectionScale_ = 1.0;
+	perspective_ = true;
 
 	pointSize_ = 10;
 	lineWidth_ = 1;
@@ -49,7 +56,7 @@ void Renderer3D::setLineWidth(double width)
 
 void Renderer3D::setCylinderQuality(int n)
 {
-	capsuleQuality_ = n;
+	cylinderQuality_ = n;
 }
 
 void Renderer3D::setCircleQuality(int n)
@@ -460,14 +467,19 @@ void Renderer3D::drawSphere(const double pos[3], const double R[9], double r)
 {
 	glPushMatrix();
 	transform(pos, R);
+	const int n = segments(sphereQuality_, r);
 	switch (drawMode_) {
 		case Solid:
 			glEnable(GL_LIGHTING);
-			drawSolidSphere(r, sphereQuality_, sphereQuality_);
+			if (sphereQuality_ > 0) {
+				drawSolidSphere(r, n, n);
+			} else {
+				drawSolidSphereMesh(r, n);
+			}
 			break;
 		case Wire:
 			glDisable(GL_LIGHTING);
-			drawWireSphere(r, sphereQuality_, sphereQuality_);
+			drawWireSphere(r, n, n);
 			break;
 	}
 	glPopMatrix();
@@ -922,17 +934,22 @@ void Renderer3D::drawCylinder(const double pos[3], const double R[9], double len
 	glPushMatrix();
 	transform(pos, R);
 //	drawCylinder(length, radius, 0.0, drawCap);
+	const int n = segments(cylinderQuality_, radius);
 
 	switch (drawMode_) {
 		case Solid:
 			glEnable(GL_LIGHTING);
-			drawCylinder(length, radius, 0.0, drawCap);
+			if (cylinderQuality_ > 0) {
+				drawCylinder(length, radius, 0.0, drawCap);
+			} else {
+				drawSolidCylinderMesh(length, radius, n, drawCap);
+			}
 			break;
 		case Wire:
 			glDisable(GL_LIGHTING);
 			glPushMatrix();
 			translate(0, 0, -length/2);
-			drawWireCylinder(radius, length, cylinderQuality_, 2);
+			drawWireCylinder(radius, length, n, 2);
 			glPopMatrix();
 			break;
 	}
@@ -947,7 +964,11 @@ void Renderer3D::drawCapsule(const double pos[3], const double R[9], double leng
 	glEnable(GL_CULL_FACE);
 	glPushMatrix();
 	transform(pos, R);
-	drawCapsule(length, radius);
+	if (capsuleQuality_ > 0) {
+		drawCapsule(length, radius);
+	} else {
+		drawSolidCapsuleMesh(length, radius, segments(capsuleQuality_, radius));
+	}
 	glPopMatrix();
 }
 
@@ -955,11 +976,12 @@ void Renderer3D::drawCone(const double pos[3], const double R[9], double length,
 {
 	glPushMatrix();
 	transform(pos, R);
+	const int n = segments(circleQuality_, radius);
 	switch (drawMode_) {
-		case Solid: drawSolidCone(radius, length, circleQuality_, 1); break;
+		case Solid: drawSolidCone(radius, length, n, 1); break;
 		case Wire:
 			glDisable(GL_LIGHTING);
-			drawWireCone(radius, length, circleQuality_, 1);
+			drawWireCone(radius, length, n, 1);
 			glEnable(GL_LIGHTING);
 			break;
 	}
@@ -970,15 +992,16 @@ void Renderer3D::drawRing(const double pos[3], const double R[9], double length,
 {
 	glPushMatrix();
 	transform(pos, R);
+	const int n = segments(circleQuality_, outer_radius);
 
 	glBegin(GL_QUAD_STRIP); // ポリゴンの描画
 
 	glNormal3f(0, 0, 1);
 
 	// 上
-	for (int i = 0; i <= circleQuality_; i++) {
+	for (int i = 0; i <= n; i++) {
 		// 座標を計算
-		double rate = (double)i / circleQuality_;
+		double rate = (double)i / n;
 		double c = cos(2.0 * M_PI * rate);
 		double s = sin(2.0 * M_PI * rate);
 
@@ -995,9 +1018,9 @@ void Renderer3D::drawRing(const double pos[3], const double R[9], double length,
 	glNormal3f(0, 0, -1);
 
 	// 下
-	for (int i = 0; i <= circleQuality_; i++) {
+	for (int i = 0; i <= n; i++) {
 		// 座標を計算
-		double rate = -(double)i / circleQuality_;
+		double rate = -(double)i / n;
 		double c = cos(2.0 * M_PI * rate);
 		double s = sin(2.0 * M_PI * rate);
 
@@ -1012,9 +1035,9 @@ void Renderer3D::drawRing(const double pos[3], const double R[9], double length,
 	}
 
 	// 外周
-	for (int i = 0; i <= circleQuality_; i++) {
+	for (int i = 0; i <= n; i++) {
 		// 座標を計算
-		double rate = (double)i / circleQuality_;
+		double rate = (double)i / n;
 		double c = cos(2.0 * M_PI * rate);
 		double s = sin(2.0 * M_PI * rate);
 
@@ -1031,9 +1054,9 @@ void Renderer3D::drawRing(const double pos[3], const double R[9], double length,
 
 
 	// 内周
-	for (int i = 0; i <= circleQuality_; i++) {
+	for (int i = 0; i <= n; i++) {
 		// 座標を計算
-		double rate = (double)i / circleQuality_;
+		double rate = (double)i / n;
 		double c = cos(2.0 * M_PI * rate);
 		double s = sin(2.0 * M_PI * rate);
 
@@ -1058,6 +1081,7 @@ void Renderer3D::drawCircle(const double pos[3], const double R[9], double r)
 {
 	glPushMatrix();
 	transform(pos, R);
+	const int n = segments(circleQuality_, r);
 
 	glDisable(GL_CULL_FACE);
 
@@ -1072,9 +1096,9 @@ void Renderer3D::drawCircle(const double pos[3], const double R[9], double r)
 	glNormal3f(0, 0, 1);
 
 	// 円を描画
-	for (int i = 0; i < circleQuality_; i++) {
+	for (int i = 0; i < n; i++) {
 		// 座標を計算
-		double rate = (double)i / circleQuality_;
+		double rate = (double)i / n;
 		double x = r * cos(2.0 * M_PI * rate);
 		double y = r * sin(2.0 * M_PI * rate);
 		glVertex3d(x, y, 0.0); // 頂点座標を指定
@@ -1090,6 +1114,7 @@ void Renderer3D::drawRingCircle(const double pos[3], const double R[9], double o
 {
 	glPushMatrix();
 	transform(pos, R);
+	const int n = segments(circleQuality_, outer_radius);
 
 	if (cullFace_) {
 		glEnable(GL_CULL_FACE);
@@ -1102,9 +1127,9 @@ void Renderer3D::drawRingCircle(const double pos[3], const double R[9], double o
 	glNormal3f(0, 0, 1);
 
 	// 円を描画
-	for (int i = 0; i <= circleQuality_; i++) {
+	for (int i = 0; i <= n; i++) {
 		// 座標を計算
-		double rate = (double)i / circleQuality_;
+		double rate = (double)i / n;
 		double c = cos(2.0 * M_PI * rate);
 		double s = sin(2.0 * M_PI * rate);
 
@@ -1206,6 +1231,227 @@ void Renderer3D::drawGrid(double w, int div)
 	glEnable(GL_LIGHTING);
 }
 
+bool Renderer3D::beginMesh(const TriangleMeshPtr& mesh, double scale)
+{
+	if (!mesh || mesh->numTriangles() == 0) return false;
+
+	glPushAttrib(GL_ENABLE_BIT | GL_POLYGON_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+	if (!mesh->bindBuffers(graphicsView_->glContextGroup())) {
+		glPopClientAttrib();
+		glPopAttrib();
+		return false;
+	}
+
+	if (cullFace_) {
+		glEnable(GL_CULL_FACE);
+	} else {
+		glDisable(GL_CULL_FACE);
+	}
+
+	switch (drawMode_) {
+		case Solid: {
+			glEnable(GL_LIGHTING);
+			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+			break;
+		}
+		case Wire: {
+			glDisable(GL_LIGHTING);
+			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			break;
+		}
+	}
+
+	if (!mesh->hasNormals()) glNormal3d(0.0, 0.0, 1.0);
+	if (mesh->hasColors()) {
+		glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+		glEnable(GL_COLOR_MATERIAL);
+	}
+	// compact normals are scaled with the positions
+	if (scale != 1.0 || mesh->vertexFormat() == TriangleMesh::VertexFormat::Compact) glEnable(GL_NORMALIZE);
+
+	return true;
+}
+
+void Renderer3D::endMesh(const TriangleMeshPtr& mesh)
+{
+	mesh->unbindBuffers();
+	glPopClientAttrib();
+	glPopAttrib();
+}
+
+void Renderer3D::beginFrame(const Camera& camera)
+{
+	const Eigen::Matrix4d& projection = camera.projectionMatrix();
+	projectionScale_ = 0.5 * camera.height() * projection(1, 1);
+	perspective_ = projection(3, 2) != 0.0;
+}
+
+double Renderer3D::projectedRadius(double radius) const
+{
+	GLdouble modelview[16];
+	glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+
+	// radius in the eye coordinates, then on the screen
+	double s = 0.0;
+	for (int i = 0; i < 3; ++i) {
+		const double* c = modelview + 4*i;
+		s = std::max(s, std::sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2]));
+	}
+	const double r = std::abs(radius) * s;
+	double pixels = r * projectionScale_;
+	if (perspective_) {
+		const double depth = -modelview[14];
+		if (depth <= r) return std::numeric_limits<double>::infinity();	// around the eye
+		pixels /= depth;
+	}
+	return pixels;
+}
+
+int Renderer3D::segments(int quality, double radius) const
+{
+	if (quality > 0) return quality;
+
+	const double pixels = projectedRadius(radius);
+	if (std::isinf(pixels)) return UnitPrimitiveMeshes::levelSegments(UnitPrimitiveMeshes::NumLevels - 1);
+
+	// snapped to the levels of the cached meshes
+	const int n = UnitCircleTable::segmentsForRadius(pixels, qualityTolerance_);
+	return UnitPrimitiveMeshes::levelSegments(UnitPrimitiveMeshes::levelOf(n));
+}
+
+void Renderer3D::drawSolidSphereMesh(double r, int segments)
+{
+	const TriangleMeshPtr& mesh = UnitPrimitiveMeshes::sphere(UnitPrimitiveMeshes::levelOf(segments));
+	if (!beginMesh(mesh, r)) return;
+
+	glPushMatrix();
+	scale(r);
+	mesh->drawElements();
+	glPopMatrix();
+
+	endMesh(mesh);
+}
+
+void Renderer3D::drawSolidCapsuleMesh(double l, double r, int segments)
+{
+	const int level = UnitPrimitiveMeshes::levelOf(segments);
+	const TriangleMeshPtr& tube = UnitPrimitiveMeshes::tube(level);
+	const TriangleMeshPtr& cap = UnitPrimitiveMeshes::hemisphere(level);
+	if (!beginMesh(tube, 1.0)) return;
+	glEnable(GL_NORMALIZE);		// scaled unevenly
+
+	glPushMatrix();
+	scale(r, r, l);
+	tube->drawElements();
+	glPopMatrix();
+
+	cap->bindBuffers(graphicsView_->glContextGroup());
+	for (int i = 0; i < 2; ++i) {
+		glPushMatrix();
+		translate(0, 0, i == 0 ? l/2 : -l/2);
+		if (i == 1) rotateX(180);
+		scale(r);
+		cap->drawElements();
+		glPopMatrix();
+	}
+
+	endMesh(cap);
+}
+
+void Renderer3D::drawSolidCylinderMesh(double l, double r, int segments, bool drawCap)
+{
+	const int level = UnitPrimitiveMeshes::levelOf(segments);
+	const TriangleMeshPtr& tube = UnitPrimitiveMeshes::tube(level);
+	if (!beginMesh(tube, 1.0)) return;
+	glEnable(GL_NORMALIZE);		// scaled unevenly
+
+	glPushMatrix();
+	scale(r, r, l);
+	tube->drawElements();
+	glPopMatrix();
+
+	if (drawCap) {
+		const TriangleMeshPtr& disk = UnitPrimitiveMeshes::disk(level);
+		disk->bindBuffers(graphicsView_->glContextGroup());
+		for (int i = 0; i < 2; ++i) {
+			glPushMatrix();
+			translate(0, 0, i == 0 ? l/2 : -l/2);
+			if (i == 1) rotateX(180);
+			scale(r, r, 1);
+			disk->drawElements();
+			glPopMatrix();
+		}
+	}
+
+	endMesh(tube);
+}
+
+void Renderer3D::drawMesh(const TriangleMeshPtr& mesh, const double pos[3], const double R[9], double scale)
+{
+	if (!beginMesh(mesh, scale)) return;
+
+	glPushMatrix();
+	transform(pos, R);
+	if (scale != 1.0) this->scale(scale);
+	mesh->drawElements();
+	glPopMatrix();
+
+	endMesh(mesh);
+}
+
+void Renderer3D::drawMeshInstances(const TriangleMeshPtr& mesh, const double* positions, const double* attitudes, int numInstances, double scale)
+{
+	if (numInstances <= 0 || !beginMesh(mesh, scale)) return;
+
+	GLdouble matrix[16];
+	matrix[3] = matrix[7] = matrix[11] = 0.0;
+	matrix[15] = 1.0;
+	for (int i = 0; i < numInstances; ++i) {
+		const double* p = positions + 3*i;
+		const double* R = attitudes + 9*i;
+		for (int j = 0; j < 3; ++j) {
+			matrix[j]   = R[j];		// column major, as GL
+			matrix[4+j] = R[3+j];
+			matrix[8+j] = R[6+j];
+			matrix[12+j] = p[j];
+		}
+
+		glPushMatrix();
+		glMultMatrixd(matrix);
+		if (scale != 1.0) this->scale(scale);
+		mesh->drawElements();
+		glPopMatrix();
+	}
+
+	endMesh(mesh);
+}
+
+void Renderer3D::drawPointCloud(const CompactPointCloudPtr& cloud)
+{
+	if (!cloud || cloud->numPoints() == 0) return;
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+	if (cloud->hasNormals()) {
+		glEnable(GL_LIGHTING);
+		glEnable(GL_NORMALIZE);
+	} else {
+		glDisable(GL_LIGHTING);
+	}
+	if (cloud->hasColors()) {
+		glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+		glEnable(GL_COLOR_MATERIAL);
+	}
+
+	cloud->drawChunks(graphicsView_->glContextGroup());
+
+	glPopClientAttrib();
+	glPopAttrib();
+}
+
 void Renderer3D::drawPoints(const double* p, int np)
 {
 	glDisable(GL_LIGHTING);
@@ -6,10 +6,14 @@
 #define TGL_CORE_RENDERER3D_H_
 
 #include <array>
+#include <vector>
 #include <GL/gl.h>
+#include "TriangleMesh.h"
+#include "CompactPointCloud.h"
 
 namespace tgl {
 
+class Camera;
 class GraphicsView;
 
 class Renderer3D {
@@ -32,10 +36,26 @@ public:
     void setPointSize(double size);
     void setLineWidth(double width);
 
+	// segments around the axis. 0 picks them per draw from the radius on the screen, within the
+	// quality tolerance, and draws solid spheres, capsules and cylinders from cached meshes
+	// (UnitPrimitiveMeshes) : the triangles follow the pixels covered, not the number of objects
 	void setCylinderQuality(int n);
 	void setCircleQuality(int n);
 	void setCapsuleQuality(int n);
 	void setSphereQuality(int n);
+	void setAutoQuality() { sphereQuality_ = capsuleQuality_ = cylinderQuality_ = circleQuality_ = 0; }
+
+	// radius in pixels on the screen of a sphere at the origin of the current modelview,
+	// infinity if the eye is inside. the projection is the one of the camera given to beginFrame(),
+	// so the picking matrix does not change the result
+	double projectedRadius(double radius) const;
+
+	// caches the camera projection and viewport for auto quality. called by GraphicsView once per frame
+	void beginFrame(const Camera& camera);
+
+	// largest distance in pixels between a curve and its segments in auto quality, 0.25 by default
+	void setQualityTolerance(double pixels) { qualityTolerance_ = pixels; }
+	double qualityTolerance() const { return qualityTolerance_; }
 
 	int cylinderQuality() const { return cylinderQuality_; }
 	int circleQuality() const { return circleQuality_; }
@@ -79,6 +99,16 @@ public:
 	void drawAxis(const double pos[3], const double R[9], double length);
 	void drawGrid(double w, int div);
 
+	// indexed mesh from its buffer objects. colors of the mesh replace the current color
+	void drawMesh(const TriangleMeshPtr& mesh, const double pos[3], const double R[9], double scale = 1.0);
+	// the same mesh at many poses, bound once.
+	// positions x,y,z per instance, attitudes column major 3x3 per instance (SE3Group, TransformPool)
+	void drawMeshInstances(const TriangleMeshPtr& mesh, const double* positions, const double* attitudes, int numInstances, double scale = 1.0);
+
+	// quantized chunks from their buffer objects, positions decoded by the modelview. lit if the cloud has normals,
+	// colors of the cloud replace the current color
+	void drawPointCloud(const CompactPointCloudPtr& cloud);
+
 	void drawPoints(const double* p, int numpoints);
 	void drawLines(const double* lines, int numlines);
 	void drawLineStrip(const double* lines, int numlines);
@@ -121,6 +151,15 @@ private:
 	void drawSolidCylinder(GLdouble radius, GLdouble height, GLint slices, GLint stacks);
 	void drawWireCylinder(GLdouble radius, GLdouble height, GLint slices, GLint stacks);
 
+	bool beginMesh(const TriangleMeshPtr& mesh, double scale);
+	void endMesh(const TriangleMeshPtr& mesh);
+
+	// the quality, or segments for the radius on the screen with the current modelview if 0
+	int segments(int quality, double radius) const;
+	void drawSolidSphereMesh(double r, int segments);
+	void drawSolidCapsuleMesh(double l, double r, int segments);
+	void drawSolidCylinderMesh(double l, double r, int segments, bool drawCap);
+
 	static void calcCircleTable(std::vector<double>& sint, std::vector<double>& cost, int n);
 
 	GraphicsView* graphicsView_;
@@ -131,6 +170,11 @@ private:
 	int capsuleQuality_;
 	int cylinderQuality_;
 	int circleQuality_;
+	double qualityTolerance_;
+
+	// of the camera in beginFrame()
+	double projectionScale_;	// projection(1, 1) * viewport height / 2
+	bool perspective_;
 	double pointSize_;
 	double lineWidth_;
 	DrawMode drawMode_;
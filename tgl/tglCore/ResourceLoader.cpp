@@ -0,0 +1,213 @@
+/*
+ * ResourceLoader.cpp
+ */
+
+#include <utility>
+#include <algorithm>
+#include "tglUtil/ThreadPool.h"
+#include "ResourceLoader.h"
+
+namespace tgl {
+
+Resource::Resource(const std::string& path, const std::string& category)
+	: path_(path), category_(category), state_(State::Idle), evicted_(false), bytes_(0), lastUsedFrame_(0)
+{
+
+}
+
+Resource::~Resource()
+{
+
+}
+
+void Resource::touch()
+{
+	ResourceLoader& loader = ResourceLoader::instance();
+	lastUsedFrame_ = loader.frame();
+	if (evicted_ && state() == State::Idle) {
+		loader.load(shared_from_this());
+	}
+}
+
+ResourceLoader& ResourceLoader::instance()
+{
+	static ResourceLoader loader;
+	return loader;
+}
+
+ResourceLoader::ResourceLoader()
+	: uploadBudget_(32 << 20), numPending_(0), memoryBudget_(0), evictionDelay_(60), frame_(0)
+{
+
+}
+
+ResourceLoader::~ResourceLoader()
+{
+
+}
+
+void ResourceLoader::load(ResourcePtr resource)
+{
+	if (!resource) return;
+
+	Resource::State expected = Resource::State::Idle;
+	if (!resource->state_.compare_exchange_strong(expected, Resource::State::Loading)) {
+		expected = Resource::State::Failed;
+		if (!resource->state_.compare_exchange_strong(expected, Resource::State::Loading)) return;
+	}
+	resource->evicted_ = false;
+	++numPending_;
+
+	ThreadPool::instance().enqueue([this, resource]() {
+		std::string error;
+		bool ok = false;
+		try {
+			ok = resource->loadData(error);
+		} catch (const std::exception& e) {
+			error = e.what();
+		}
+
+		if (ok) {
+			resource->state_.store(Resource::State::Uploading, std::memory_order_release);
+			std::lock_guard<std::mutex> lock(mutex_);
+			uploads_.push_back(resource);
+		} else {
+			resource->error_ = error;
+			resource->state_.store(Resource::State::Failed, std::memory_order_release);
+			--numPending_;
+		}
+		notify();
+	});
+}
+
+size_t ResourceLoader::uploadPending(const void* context)
+{
+	size_t spent = 0;
+	for (;;) {
+		ResourcePtr resource;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (uploads_.empty()) break;
+			if (spent > 0 && spent + uploads_.front()->uploadBytes() > uploadBudget_) break;
+			resource = uploads_.front();
+			uploads_.pop_front();
+		}
+
+		const size_t bytes = resource->uploadData(context);
+		spent += std::max<size_t>(1, bytes);
+		resource->bytes_ = bytes;
+		resource->lastUsedFrame_ = frame_.load();
+		resource->state_.store(Resource::State::Ready, std::memory_order_release);
+		--numPending_;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		resident_.push_back(resource);
+	}
+
+	if (spent > 0) notify();	// other views draw the resources too
+	return spent;
+}
+
+void ResourceLoader::beginFrame()
+{
+	const unsigned long frame = ++frame_;
+	const size_t budget = memoryBudget_;
+
+	size_t used = 0;
+	// last used frame copied once, touch() from other views may change it meanwhile
+	std::vector<std::pair<unsigned long, ResourcePtr>> candidates;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto end = std::remove_if(resident_.begin(), resident_.end(), [](const std::weak_ptr<Resource>& w) {
+			ResourcePtr resource = w.lock();
+			return !resource || !resource->isReady();
+		});
+		resident_.erase(end, resident_.end());
+		if (budget == 0) return;
+
+		for (const auto& w : resident_) {
+			ResourcePtr resource = w.lock();
+			if (!resource) continue;
+			used += resource->bytes();
+			const unsigned long lastUsed = resource->lastUsedFrame();
+			if (lastUsed + evictionDelay_ < frame) {
+				candidates.push_back(std::make_pair(lastUsed, resource));
+			}
+		}
+	}
+	if (used <= budget) return;
+
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<unsigned long, ResourcePtr>& a, const std::pair<unsigned long, ResourcePtr>& b) {
+		return a.first < b.first;
+	});
+
+	for (const auto& candidate : candidates) {
+		if (used <= budget) break;
+		const ResourcePtr& resource = candidate.second;
+		const size_t bytes = resource->bytes();
+		if (!resource->releaseData()) continue;
+
+		resource->bytes_ = 0;
+		resource->evicted_ = true;
+		resource->state_.store(Resource::State::Idle, std::memory_order_release);
+		used -= bytes;
+	}
+}
+
+bool ResourceLoader::hasPendingUploads() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return !uploads_.empty();
+}
+
+size_t ResourceLoader::usedBytes() const
+{
+	size_t bytes = 0;
+	for (const auto& entry : usage()) {
+		bytes += entry.second;
+	}
+	return bytes;
+}
+
+size_t ResourceLoader::usedBytes(const std::string& category) const
+{
+	std::map<std::string, size_t> bytes = usage();
+	auto itr = bytes.find(category);
+	return itr != bytes.end() ? itr->second : 0;
+}
+
+std::map<std::string, size_t> ResourceLoader::usage() const
+{
+	std::map<std::string, size_t> bytes;
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (const auto& w : resident_) {
+		ResourcePtr resource = w.lock();
+		if (resource && resource->isReady()) {
+			bytes[resource->category()] += resource->bytes();
+		}
+	}
+	return bytes;
+}
+
+void ResourceLoader::addListener(const void* key, std::function<void ()> listener)
+{
+	std::lock_guard<std::mutex> lock(listenerMutex_);
+	listeners_[key] = listener;
+}
+
+void ResourceLoader::removeListener(const void* key)
+{
+	// waits for a listener being called, the owner may be destroyed after this
+	std::lock_guard<std::mutex> lock(listenerMutex_);
+	listeners_.erase(key);
+}
+
+void ResourceLoader::notify()
+{
+	std::lock_guard<std::mutex> lock(listenerMutex_);
+	for (const auto& entry : listeners_) {
+		entry.second();
+	}
+}
+
+} /* namespace tgl */
@@ -0,0 +1,155 @@
+/*
+ * ResourceLoader.h
+ */
+
+#ifndef TGL_CORE_RESOURCELOADER_H_
+#define TGL_CORE_RESOURCELOADER_H_
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <functional>
+
+namespace tgl {
+
+class Resource;
+typedef std::shared_ptr<Resource> ResourcePtr;
+
+// Resource loaded in the background.
+// loadData() runs on a worker thread of ThreadPool::instance() (reading, parsing, decoding),
+// uploadData() runs later on a render thread, from GraphicsView, within the upload budget of a frame.
+// an evictable resource (releaseData()) may be dropped over the memory budget when it has not
+// been used for a while, and is loaded again by the next touch()
+class Resource : public std::enable_shared_from_this<Resource> {
+public:
+	enum class State {
+		Idle,		// not requested
+		Loading,	// on a worker thread
+		Uploading,	// loaded, waiting for a render thread
+		Ready,
+		Failed
+	};
+
+	// category groups the memory usage ("mesh", "font")
+	explicit Resource(const std::string& path, const std::string& category = std::string());
+	virtual ~Resource();
+
+	const std::string& path() const { return path_; }
+	const std::string& category() const { return category_; }
+
+	State state() const { return state_.load(std::memory_order_acquire); }
+	bool isReady() const { return state() == State::Ready; }
+	bool isFailed() const { return state() == State::Failed; }
+	bool isPending() const { State s = state(); return s == State::Loading || s == State::Uploading; }
+
+	bool isEvicted() const { return evicted_; }
+
+	// valid once failed
+	const std::string& error() const { return error_; }
+
+	// bytes uploaded, while ready
+	size_t bytes() const { return bytes_; }
+
+	// marks the resource used in the current frame, to be drawn. loads it again if evicted
+	void touch();
+	unsigned long lastUsedFrame() const { return lastUsedFrame_; }
+
+protected:
+	friend class ResourceLoader;
+
+	// worker thread. false on error, with the reason in error (loaders print it)
+	virtual bool loadData(std::string& error) = 0;
+
+	// render thread of the context. returns the bytes sent to GL
+	virtual size_t uploadData(const void* /* context */) { return 0; }
+	// bytes uploadData() will send, counted in the budget before uploading
+	virtual size_t uploadBytes() const { return 0; }
+
+	// render thread. drops the data and the GL objects on eviction.
+	// false if the resource can not be evicted (default)
+	virtual bool releaseData() { return false; }
+
+private:
+	Resource(const Resource&) = delete;
+	Resource& operator=(const Resource&) = delete;
+
+	std::string path_;
+	std::string category_;
+	std::string error_;
+	std::atomic<State> state_;
+	std::atomic<bool> evicted_;
+	std::atomic<size_t> bytes_;
+	std::atomic<unsigned long> lastUsedFrame_;
+};
+
+// Background loading and budgeted GL upload of resources.
+// a frame uploads resources until the budget is used, at least one, so a large
+// resource is never starved and many small ones do not stall a frame
+class ResourceLoader {
+public:
+	static ResourceLoader& instance();
+
+	// starts loading if the resource is idle or failed
+	void load(ResourcePtr resource);
+
+	// bytes uploaded per frame, 32 MB by default
+	void setUploadBudget(size_t bytes) { uploadBudget_ = bytes; }
+	size_t uploadBudget() const { return uploadBudget_; }
+
+	// memory of the ready resources, in bytes uploaded. 0 (default) is no limit.
+	// over the budget, resources not used in the last evictionDelay frames are evicted,
+	// least recently used first. resources drawn every frame are never evicted
+	void setMemoryBudget(size_t bytes) { memoryBudget_ = bytes; }
+	size_t memoryBudget() const { return memoryBudget_; }
+	// 60 frames by default. frames of all views are counted
+	void setEvictionDelay(unsigned int frames) { evictionDelay_ = frames; }
+	unsigned int evictionDelay() const { return evictionDelay_; }
+
+	// render thread. called by GraphicsView at the start of a frame, evicts over the memory budget
+	void beginFrame();
+	unsigned long frame() const { return frame_; }
+
+	// render thread. called by GraphicsView after beginFrame(), returns the bytes uploaded
+	size_t uploadPending(const void* context);
+	bool hasPendingUploads() const;
+	size_t numPending() const { return numPending_; }
+
+	// bytes of the ready resources, all or of a category
+	size_t usedBytes() const;
+	size_t usedBytes(const std::string& category) const;
+	std::map<std::string, size_t> usage() const;	// per category
+
+	// called, from any thread, when resources are ready to upload or have become ready.
+	// GraphicsView requests a frame
+	void addListener(const void* key, std::function<void ()> listener);
+	void removeListener(const void* key);
+
+private:
+	ResourceLoader();
+	~ResourceLoader();
+	ResourceLoader(const ResourceLoader&) = delete;
+	ResourceLoader& operator=(const ResourceLoader&) = delete;
+
+	void notify();
+
+	mutable std::mutex mutex_;
+	std::deque<ResourcePtr> uploads_;
+	std::vector<std::weak_ptr<Resource>> resident_;	// uploaded, the owners keep them
+
+	std::mutex listenerMutex_;	// held while listeners are called
+	std::map<const void*, std::function<void ()>> listeners_;
+
+	std::atomic<size_t> uploadBudget_;
+	std::atomic<size_t> numPending_;
+	std::atomic<size_t> memoryBudget_;
+	std::atomic<unsigned int> evictionDelay_;
+	std::atomic<unsigned long> frame_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_RESOURCELOADER_H_ */
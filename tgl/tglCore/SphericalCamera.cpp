@@ -4,9 +4,6 @@
 
 #include <cmath>
 
-#include <GL/gl.h>
-#include <GL/glu.h>
-
 #include "tglUtil/EigenUtil.h"
 #include "InputEvent.h"
 #include "SphericalCamera.h"
@@ -17,7 +14,13 @@
 namespace tgl {
 
 SphericalCamera::SphericalCamera() {
+	allowThrow_ = false;
+	thrown_ = false;
+	motion_ = 0;
 
+	orbiting_ = false;
+	orbitTime_ = 0;
+	orbitDuration_ = 0;
 }
 
 SphericalCamera::~SphericalCamera() {
@@ -54,42 +57,83 @@ void SphericalCamera::initializeConfiguration()
 	view_hpr_[2] = 0;
 }
 
-static void rotateR(const double R[9])
+void SphericalCamera::update()
 {
-	GLdouble matrix[16];
-	matrix[0] = R[0];
-	matrix[1] = R[3];
-	matrix[2] = R[6];
-	matrix[3] = 0.0;
-	matrix[4] = R[1];
-	matrix[5] = R[4];
-	matrix[6] = R[7];
-	matrix[7] = 0.0;
-	matrix[8] = R[2];
-	matrix[9] = R[5];
-	matrix[10] = R[8];
-	matrix[11] = 0.0;
-	matrix[12] = 0.0;
-	matrix[13] = 0.0;
-	matrix[14] = 0.0;
-	matrix[15] = 1.0;
-	glMultMatrixd(matrix);
+	R_ = rotationX(elevation_*DEG_TO_RAD) * rotationZ(heading_*DEG_TO_RAD);
+	Rt_ = R_.transpose();
+
+	// T(0, 0, -distance) R^T T(-center)
+	Eigen::Vector3d center(center_[0], center_[1], center_[2]);
+	setViewMatrix(Rt_, Eigen::Vector3d(0.0, 0.0, -distance_) - Rt_ * center);
+	loadViewMatrix();
 }
 
+void SphericalCamera::advance(double dt)
+{
+	if (orbiting_) {
+		orbitTime_ += dt;
+		const double t = orbitDuration_ > 0 ? orbitTime_ / orbitDuration_ : 1.0;
+		const double s = smoothStep(t);
+
+		double v[6];
+		for (int i = 0; i < 6; ++i) {
+			v[i] = orbitFrom_[i] + (orbitTo_[i] - orbitFrom_[i]) * s;
+		}
+		setCenter(v);
+		distance_ = v[3];
+		heading_ = v[4];
+		elevation_ = v[5];
+
+		if (t >= 1.0) orbiting_ = false;
+	}
+
+	if (thrown_) {
+		const double dx = velocity_[0] * dt;
+		const double dy = velocity_[1] * dt;
+
+		switch (motion_) {
+		case 1: viewMotion1(dx, dy); break;
+		case 3: viewMotion3(dx, dy); break;
+		default: break;
+		}
+
+		thrown_ = dampThrow(dt);
+	}
+}
 
-void SphericalCamera::update()
+void SphericalCamera::orbitTo(const double center[3], double distance, double heading, double elevation, double duration)
 {
-	R_ = rotationX(elevation_*DEG_TO_RAD) * rotationZ(heading_*DEG_TO_RAD);
-	Rt_ = R_.transpose();
+	const double from[6] = {center_[0], center_[1], center_[2], distance_, heading_, elevation_};
+	const double to[6] = {center[0], center[1], center[2], distance, heading, elevation};
+
+	for (int i = 0; i < 6; ++i) {
+		orbitFrom_[i] = from[i];
+		orbitTo_[i] = to[i];
+	}
+
+	// the shorter way around
+	double da = heading - heading_;
+	while (da > 180) da -= 360;
+	while (da < -180) da += 360;
+	orbitTo_[4] = heading_ + da;
+
+	orbitTime_ = 0;
+	orbitDuration_ = duration;
+	orbiting_ = true;
+	thrown_ = false;
+}
 
-	glTranslated(0.0, 0.0, -distance_);
-	rotateR(R_.data());
-	glTranslated(-center_[0], -center_[1], -center_[2]);
+void SphericalCamera::stopAnimation()
+{
+	orbiting_ = false;
+	thrown_ = false;
 }
 
 void SphericalCamera::mousePressEvent(MouseEvent* /* event */)
 {
-
+	motion_ = 0;
+	stopAnimation();
+	beginThrow();
 }
 
 void SphericalCamera::mouseMoveEvent(MouseEvent* event)
@@ -103,18 +147,23 @@ void SphericalCamera::mouseMoveEvent(MouseEvent* event)
     	break;
     case MouseEvent::MouseBotton::RightButton:
     	viewMotion1(dx, dy);
+    	motion_ = 1;
     	break;
     case MouseEvent::MouseBotton::MiddleButton:
     	viewMotion3(dx, dy);
+    	motion_ = 3;
     	break;
     default:
     	break;
     }
+
+    trackThrow(dx, dy);
 }
 
 void SphericalCamera::mouseReleaseEvent(MouseEvent* event)
 {
-
+	// keeps moving with the velocity at the release
+	thrown_ = endThrow() && allowThrow_ && motion_ != 0;
 }
 
 void SphericalCamera::wheelEvent(WheelEvent* event)
@@ -126,22 +175,22 @@ void SphericalCamera::wheelEvent(WheelEvent* event)
 }
 
 // left
-void SphericalCamera::viewMotion1(int dx, int dy)
+void SphericalCamera::viewMotion1(double dx, double dy)
 {
-	view_hpr_[0] += double (dx) * 0.5f;
-	view_hpr_[1] += double (dy) * 0.5f;
+	view_hpr_[0] += dx * 0.5;
+	view_hpr_[1] += dy * 0.5;
 
-	heading_ += double (dx) * 0.5f;
-	elevation_ += double (dy) * 0.5f;
+	heading_ += dx * 0.5;
+	elevation_ += dy * 0.5;
 
 	wrapCameraAngles();
 }
 
 // rigth
-void SphericalCamera::viewMotion2(int dx, int dy)
+void SphericalCamera::viewMotion2(double dx, double dy)
 {
-	double side = 0.01 * double(dx);
-	double fwd = 0.01f * double(dy);
+	double side = 0.01 * dx;
+	double fwd = 0.01 * dy;
 	double s = (double)sin(view_hpr_[0]*DEG_TO_RAD);
 	double c = (double)cos(view_hpr_[0]*DEG_TO_RAD);
 
@@ -152,10 +201,10 @@ void SphericalCamera::viewMotion2(int dx, int dy)
 }
 
 // mid
-void SphericalCamera::viewMotion3(int dx, int dy)
+void SphericalCamera::viewMotion3(double dx, double dy)
 {
-	double side = 0.01 * double(dx);
-	double fwd = 0.0f;
+	double side = 0.01 * dx;
+	double fwd = 0.0;
 	double s = (double)sin(view_hpr_[0]*DEG_TO_RAD);
 	double c = (double)cos(view_hpr_[0]*DEG_TO_RAD);
 
@@ -163,7 +212,7 @@ void SphericalCamera::viewMotion3(int dx, int dy)
 
 	view_xyz_[0] += -s*side + c*fwd;
 	view_xyz_[1] += c*side + s*fwd;
-	view_xyz_[2] += 0.01f * double(dy);
+	view_xyz_[2] += 0.01 * dy;
 
 	center_[0] = -view_xyz_[1];
 	center_[1] = -view_xyz_[0];
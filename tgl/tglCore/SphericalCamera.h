@@ -32,6 +32,17 @@ public:
 	virtual void initializeConfiguration();
 	virtual void update();
 
+	// animation
+	virtual void advance(double dt);
+	virtual bool isAnimating() const { return thrown_ || orbiting_; }
+
+	// moves the center and turns around it in duration seconds
+	void orbitTo(const double center[3], double distance, double heading, double elevation, double duration = 0.5);
+	void stopAnimation();
+
+	void setAllowThrow(bool allow) { allowThrow_ = allow; }
+	bool allowThrow() const { return allowThrow_; }
+
 	virtual void mousePressEvent(MouseEvent* e);
 	virtual void mouseMoveEvent(MouseEvent* e);
 	virtual void mouseReleaseEvent(MouseEvent* e);
@@ -39,12 +50,20 @@ public:
 
 protected:
 	void wrapCameraAngles();
-	void viewMotion1(int dx, int dy);
-	void viewMotion2(int dx, int dy);
-	void viewMotion3(int dx, int dy);
+	void viewMotion1(double dx, double dy);
+	void viewMotion2(double dx, double dy);
+	void viewMotion3(double dx, double dy);
 
 	bool allowThrow_;
 	bool thrown_;
+	int motion_;
+
+	// orbitTo : center x, y, z, distance, heading, elevation
+	bool orbiting_;
+	double orbitTime_;
+	double orbitDuration_;
+	double orbitFrom_[6];
+	double orbitTo_[6];
 
 	double center_[3];
 	double distance_;
@@ -3,8 +3,6 @@
  */
 
 #include <cmath>
-#include <GL/gl.h>
-#include <GL/glu.h>
 
 #include "tglUtil/EigenUtil.h"
 #include "InputEvent.h"
@@ -22,7 +20,13 @@ StandardCamera::StandardCamera() {
     set(xyz[0], xyz[1], xyz[2], hpr[0], hpr[1], hpr[2]);
 
 	allowThrow_ = false;
-	thrown_ = allowThrow_;
+	thrown_ = false;
+	motion_ = 0;
+	px_ = py_ = 0;
+
+	flying_ = false;
+	flyTime_ = 0;
+	flyDuration_ = 0;
 }
 
 StandardCamera::~StandardCamera() {
@@ -38,39 +42,80 @@ void StandardCamera::set(double x, double y, double z, double h, double p, doubl
 
 void StandardCamera::update()
 {
+	p_[0] = view_xyz_[0], p_[1] = view_xyz_[1], p_[2] = view_xyz_[2];
+	setCamera();
+	loadViewMatrix();
+}
+
+void StandardCamera::advance(double dt)
+{
+	if (flying_) {
+		flyTime_ += dt;
+		const double t = flyDuration_ > 0 ? flyTime_ / flyDuration_ : 1.0;
+		const double s = smoothStep(t);
+
+		for (int i = 0; i < 3; ++i) {
+			view_xyz_[i] = flyFrom_[i] + (flyTo_[i] - flyFrom_[i]) * s;
+			view_hpr_[i] = flyFrom_[i+3] + (flyTo_[i+3] - flyFrom_[i+3]) * s;
+		}
+		wrapCameraAngles();
+
+		if (t >= 1.0) flying_ = false;
+	}
+
 	if (thrown_) {
+		const double dx = velocity_[0] * dt;
+		const double dy = velocity_[1] * dt;
+
 		switch (motion_) {
-		case 1: viewMotion1(dx_, dy_); break;
-		case 2: viewMotion2(dx_, dy_); break;
-		case 3: viewMotion2(dx_, dy_); break;
+		case 1: viewMotion1(dx, dy); break;
+		case 2: viewMotion2(dx, dy); break;
+		case 3: viewMotion3(dx, dy); break;
 		default: break;
 		}
+
+		thrown_ = dampThrow(dt);
+	}
+}
+
+void StandardCamera::flyTo(double x, double y, double z, double h, double p, double r, double duration)
+{
+	const double to[6] = {x, y, z, h, p, r};
+
+	for (int i = 0; i < 3; ++i) {
+		flyFrom_[i] = view_xyz_[i];
+		flyFrom_[i+3] = view_hpr_[i];
+		flyTo_[i] = to[i];
+
+		// the shorter way around
+		double da = to[i+3] - view_hpr_[i];
+		while (da > 180) da -= 360;
+		while (da < -180) da += 360;
+		flyTo_[i+3] = view_hpr_[i] + da;
 	}
 
-	p_[0] = view_xyz_[0], p_[1] = view_xyz_[1], p_[2] = view_xyz_[2];
-	setCamera();
+	flyTime_ = 0;
+	flyDuration_ = duration;
+	flying_ = true;
+	thrown_ = false;
 }
 
-void StandardCamera::setCamera(double x, double y, double z, double h, double p, double r)
+void StandardCamera::stopAnimation()
 {
-	glMatrixMode (GL_MODELVIEW);
-	glLoadIdentity();
-	glRotatef (90, 0,0,1);
-	glRotatef (90, 0,1,0);
-	glRotatef (r, 1,0,0);
-	glRotatef (p, 0,1,0);
-	glRotatef (-h, 0,0,1);
+	flying_ = false;
+	thrown_ = false;
+}
 
-	GLdouble m[16];
-	glGetDoublev(GL_MODELVIEW_MATRIX, m);
+void StandardCamera::setCamera(double x, double y, double z, double h, double p, double r)
+{
+	// Rz(90) Ry(90) Rx(r) Ry(p) Rz(-h) T(-xyz)
+	Eigen::Matrix3d R = rotationZ(M_PI/2) * rotationY(M_PI/2)
+			* rotationX(r*DEG_TO_RAD) * rotationY(p*DEG_TO_RAD) * rotationZ(-h*DEG_TO_RAD);
 
-	double* R = R_.data();
-	R[0]=m[0]; R[1]=m[4]; R[2]=m[8];
-	R[3]=m[1]; R[4]=m[5]; R[5]=m[9];
-	R[6]=m[2]; R[7]=m[6]; R[8]=m[10];
-	Rt_ = R_.transpose();
+	R_ = R.transpose();
+	Rt_ = R;
 
-	glTranslatef (-x,-y,-z);
+	setViewMatrix(R, -R * Eigen::Vector3d(x, y, z));
 }
 
 void StandardCamera::setCamera()
@@ -82,15 +127,15 @@ void StandardCamera::mousePressEvent(MouseEvent* event)
 {
     px_ = event->x();
     py_ = event->y();
-    thrown_ = false;
+    motion_ = 0;
+    stopAnimation();
+    beginThrow();
 }
 
 void StandardCamera::mouseMoveEvent(MouseEvent* event)
 {
     int dx = event->x() - px_;
     int dy = event->y() - py_;
-    dx_ = event->x() - px_;
-    dy_ = event->y() - py_;
     px_ = event->x();
     py_ = event->y();
     switch (event->button()) {
@@ -109,16 +154,14 @@ void StandardCamera::mouseMoveEvent(MouseEvent* event)
     	break;
     }
 
+	trackThrow(dx, dy);
 	setCamera();
-
-	thrown_ = false;
-	thrown_ = allowThrow_;
-
 }
 
 void StandardCamera::mouseReleaseEvent(MouseEvent* /* event */)
 {
-	thrown_ = allowThrow_;
+	// keeps moving with the velocity at the release
+	thrown_ = endThrow() && allowThrow_ && motion_ != 0;
 }
 
 void StandardCamera::wheelEvent(WheelEvent* event)
@@ -131,19 +174,19 @@ void StandardCamera::wheelEvent(WheelEvent* event)
 }
 
 // left
-void StandardCamera::viewMotion1(int dx, int dy)
+void StandardCamera::viewMotion1(double dx, double dy)
 {
-	view_hpr_[0] += double (dx) * 0.5f;
-	view_hpr_[1] += double (dy) * 0.5f;
+	view_hpr_[0] += dx * 0.5;
+	view_hpr_[1] += dy * 0.5;
 
 	wrapCameraAngles();
 }
 
 // rigth
-void StandardCamera::viewMotion2(int dx, int dy)
+void StandardCamera::viewMotion2(double dx, double dy)
 {
-	double side = 0.01 * double(dx);
-	double fwd = 0.01f * double(dy);
+	double side = 0.01 * dx;
+	double fwd = 0.01 * dy;
 	double s = (double)sin(view_hpr_[0]*DEG_TO_RAD);
 	double c = (double)cos(view_hpr_[0]*DEG_TO_RAD);
 
@@ -154,16 +197,16 @@ void StandardCamera::viewMotion2(int dx, int dy)
 }
 
 // mid
-void StandardCamera::viewMotion3(int dx, int dy)
+void StandardCamera::viewMotion3(double dx, double dy)
 {
-	double side = 0.01 * double(dx);
-	double fwd = 0.0f;
+	double side = 0.01 * dx;
+	double fwd = 0.0;
 	double s = (double)sin(view_hpr_[0]*DEG_TO_RAD);
 	double c = (double)cos(view_hpr_[0]*DEG_TO_RAD);
 
 	view_xyz_[0] += -s*side + c*fwd;
 	view_xyz_[1] += c*side + s*fwd;
-	view_xyz_[2] += 0.01f * double(dy);
+	view_xyz_[2] += 0.01 * dy;
 
 	wrapCameraAngles();
 }
@@ -21,6 +21,14 @@ public:
 
 	virtual void update();
 
+	// animation
+	virtual void advance(double dt);
+	virtual bool isAnimating() const { return thrown_ || flying_; }
+
+	// moves to the pose in duration seconds
+	void flyTo(double x, double y, double z, double h, double p, double r, double duration = 0.5);
+	void stopAnimation();
+
 	virtual void mousePressEvent(MouseEvent* e);
 	virtual void mouseMoveEvent(MouseEvent* e);
 	virtual void mouseReleaseEvent(MouseEvent* e);
@@ -34,20 +42,24 @@ protected:
 	void setCamera(double x, double y, double z, double h, double p, double r);
 
 	void wrapCameraAngles();
-	void viewMotion1(int dx, int dy);
-	void viewMotion2(int dx, int dy);
-	void viewMotion3(int dx, int dy);
+	void viewMotion1(double dx, double dy);
+	void viewMotion2(double dx, double dy);
+	void viewMotion3(double dx, double dy);
 
 	int px_;
 	int py_;
 
-	int dx_;
-	int dy_;
-
 	bool allowThrow_;
 	bool thrown_;
 	int motion_;
 
+	// flyTo : x, y, z, h, p, r
+	bool flying_;
+	double flyTime_;
+	double flyDuration_;
+	double flyFrom_[6];
+	double flyTo_[6];
+
 	float view_hpr_[3];		// position x,y,z
 	float view_xyz_[3];		// heading, pitch, roll (degrees)
 
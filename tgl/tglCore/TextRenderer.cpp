@@ -2,9 +2,9 @@
  * TextRenderer.cpp
  */
 
-#include <boost/filesystem.hpp>
 #include <FTGL/ftgl.h>
 #include "GraphicsView.h"
+#include "FontRegistry.h"
 #include "TextRenderer.h"
 
 #include <iostream>
@@ -23,7 +23,8 @@ TextRenderer::TextRenderer(GraphicsView* view)
 
 	align_ = Align::Left;
 	valign_ = VAlign::Bottom;
-	loadFont(defaultFontPath);
+	font_ = nullptr;
+	fontPath_ = defaultFontPath;
 }
 
 TextRenderer::~TextRenderer() {
@@ -47,30 +48,44 @@ void TextRenderer::setTextAlign(Align align, VAlign valign)
 
 void TextRenderer::setTextSize(int size)
 {
+	if (textSize_ == size) return;
 	textSize_ = size;
-	if (!font_) return;
-	font_->FaceSize(size);
+	font_ = nullptr;
 }
 
 void TextRenderer::loadFont(const std::string& path)
 {
-	boost::filesystem::path fpath(path);
-	if (boost::filesystem::exists(fpath)) {
-		fontPath_ = path;
-		font_ = std::move(FTFontPtr(new FTExtrudeFont(fontPath_.c_str())));
-		font_->FaceSize(textSize_);
+	// read on a worker thread, the current font is used until the face is ready
+	pendingFont_ = std::make_shared<FontResource>(path);
+	ResourceLoader::instance().load(pendingFont_);
+}
+
+FTFont* TextRenderer::font()
+{
+	if (pendingFont_ && !pendingFont_->isPending()) {
+		if (pendingFont_->isReady()) {
+			fontPath_ = pendingFont_->path();
+			font_ = nullptr;
+		}
+		pendingFont_.reset();
+	}
+
+	if (!font_ && graphicsView_) {
+		font_ = FontRegistry::instance().font(graphicsView_->glContextGroup(), fontPath_, textSize_);
 	}
+	return font_;
 }
 
 void TextRenderer::drawText(int x, int y, const std::string& text)
 {
-	if (!font_) {
+	FTFont* font = this->font();
+	if (!font) {
 		std::cerr << "error : Renderer2D::drawText font is null" << std::endl;
 		return;
 	}
 
 	// text align の設定
-	FTBBox bb = font_->BBox(text.c_str());
+	FTBBox bb = font->BBox(text.c_str());
 	const int w = abs(bb.Lower().X() - bb.Upper().X());
 	const int h = abs(bb.Lower().Y() - bb.Upper().Y());
 	int sx, sy;
@@ -97,7 +112,7 @@ void TextRenderer::drawText(int x, int y, const std::string& text)
 	glTranslatef(x + sx, y + sy, 0);
 	glScalef(1,-1,1);
 
-	font_->Render(text.c_str());
+	font->Render(text.c_str());
 
 	glPopMatrix();
 
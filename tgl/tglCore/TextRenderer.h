@@ -8,6 +8,7 @@
 #include <string>
 #include <memory>
 #include <GL/gl.h>
+#include "FontRegistry.h"
 #include "Common.h"
 
 class FTFont;
@@ -32,10 +33,16 @@ public:
 	void drawText(int x, int y, const std::string& text);
 	void drawText(double x, double y, double z, const std::string& text);
 
+	// forget the cached font, it is resolved again on the next text.
+	// called by GraphicsView when the GL context group changes
+	void resetFont() { font_ = nullptr; }
+
 	int viewWidth() const;
 	int viewHeight() const;
 
 private:
+	FTFont* font();
+
 	GraphicsView* graphicsView_;
 
 	double textColor_[4];
@@ -43,9 +50,9 @@ private:
 	Align align_;
 	VAlign valign_;
 
-	typedef std::unique_ptr<FTFont> FTFontPtr;
-	FTFontPtr font_;
+	FTFont* font_;		// owned by FontRegistry, resolved on first use
 	std::string fontPath_;
+	FontResourcePtr pendingFont_;	// loadFont() in progress
 	int textSize_;
 };
 
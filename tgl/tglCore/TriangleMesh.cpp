@@ -0,0 +1,292 @@
+/*
+ * TriangleMesh.cpp
+ */
+
+#include <unordered_map>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <Eigen/Geometry>
+#include "VertexQuantization.h"
+#include "TriangleMesh.h"
+
+namespace tgl {
+
+namespace {
+
+struct ContextState {
+	ContextState() : refCount(0), serial(0) {}
+	int refCount;
+	unsigned int serial;
+	std::vector<GLuint> unusedBuffers;	// of destroyed meshes, deleted on the render thread
+};
+
+std::mutex contextMutex;
+std::unordered_map<TriangleMesh::ContextKey, ContextState> contexts;
+
+}
+
+TriangleMesh::TriangleMesh()
+{
+	bboxMin_.setZero();
+	bboxMax_.setZero();
+	revision_ = 0;
+	vertexFormat_ = VertexFormat::Float;
+}
+
+TriangleMesh::~TriangleMesh()
+{
+	for (const auto& entry : buffers_) {
+		releaseBuffers(entry.first, entry.second.contextSerial, {entry.second.vertexBuffer, entry.second.indexBuffer});
+	}
+}
+
+void TriangleMesh::setVertices(std::vector<float> positions, std::vector<float> normals, std::vector<float> colors)
+{
+	positions_ = std::move(positions);
+	normals_ = std::move(normals);
+	colors_ = std::move(colors);
+
+	if (normals_.size() != positions_.size()) normals_.clear();
+	if (colors_.size() / 4 != positions_.size() / 3) colors_.clear();
+
+	updateBoundingBox();
+	++revision_;
+}
+
+void TriangleMesh::setIndices(std::vector<uint32_t> indices)
+{
+	indices_ = std::move(indices);
+	indices_.resize(indices_.size() / 3 * 3);
+	++revision_;
+}
+
+void TriangleMesh::clear()
+{
+	positions_.clear();
+	normals_.clear();
+	colors_.clear();
+	indices_.clear();
+	updateBoundingBox();
+	++revision_;
+}
+
+void TriangleMesh::computeNormals()
+{
+	const size_t nv = numVertices();
+	std::vector<Eigen::Vector3f> sums(nv, Eigen::Vector3f::Zero());
+	for (size_t i = 0; i + 2 < indices_.size(); i += 3) {
+		const uint32_t a = indices_[i], b = indices_[i+1], c = indices_[i+2];
+		if (a >= nv || b >= nv || c >= nv) continue;
+		Eigen::Map<const Eigen::Vector3f> pa(&positions_[3*a]), pb(&positions_[3*b]), pc(&positions_[3*c]);
+		const Eigen::Vector3f n((pb - pa).cross(pc - pa));	// length is twice the area
+		sums[a] += n;
+		sums[b] += n;
+		sums[c] += n;
+	}
+
+	normals_.resize(3 * nv);
+	for (size_t i = 0; i < nv; ++i) {
+		const float norm = sums[i].norm();
+		Eigen::Map<Eigen::Vector3f> n(&normals_[3*i]);
+		if (norm > 0.0f) {
+			n = sums[i] / norm;
+		} else {
+			n = Eigen::Vector3f::UnitZ();
+		}
+	}
+	++revision_;
+}
+
+void TriangleMesh::setVertexFormat(VertexFormat format)
+{
+	if (format == vertexFormat_) return;
+	vertexFormat_ = format;
+	++revision_;
+}
+
+void TriangleMesh::updateBoundingBox()
+{
+	if (positions_.size() < 3) {
+		bboxMin_.setZero();
+		bboxMax_.setZero();
+		return;
+	}
+
+	Eigen::Map<const Eigen::Matrix3Xf> P(positions_.data(), 3, numVertices());
+	bboxMin_ = P.rowwise().minCoeff().cast<double>();
+	bboxMax_ = P.rowwise().maxCoeff().cast<double>();
+}
+
+namespace {
+
+// compact blocks start on 4 bytes
+size_t compactPositionBytes(size_t numVertices)
+{
+	return (numVertices * 3 * sizeof(int16_t) + 3) & ~size_t(3);
+}
+
+}
+
+size_t TriangleMesh::bufferBytes() const
+{
+	const size_t indexBytes = indices_.size() * sizeof(uint32_t);
+	if (vertexFormat_ == VertexFormat::Compact) {
+		const size_t n = numVertices();
+		return compactPositionBytes(n) + (hasNormals() ? 4 * n : 0) + (hasColors() ? 4 * n : 0) + indexBytes;
+	}
+	return (positions_.size() + normals_.size() + colors_.size()) * sizeof(float) + indexBytes;
+}
+
+// positions | normals | colors in one buffer
+void TriangleMesh::uploadFloat()
+{
+	const size_t positionBytes = positions_.size() * sizeof(float);
+	const size_t normalBytes = normals_.size() * sizeof(float);
+	const size_t colorBytes = colors_.size() * sizeof(float);
+	glBufferData(GL_ARRAY_BUFFER, positionBytes + normalBytes + colorBytes, nullptr, GL_STATIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, positionBytes, positions_.data());
+	if (normalBytes) glBufferSubData(GL_ARRAY_BUFFER, positionBytes, normalBytes, normals_.data());
+	if (colorBytes) glBufferSubData(GL_ARRAY_BUFFER, positionBytes + normalBytes, colorBytes, colors_.data());
+}
+
+void TriangleMesh::uploadCompact()
+{
+	const size_t n = numVertices();
+	Eigen::Vector3d offset, scale;
+	VertexQuantization::boxQuantization(bboxMin_, bboxMax_, offset, scale);
+
+	const size_t positionBytes = compactPositionBytes(n);
+	const size_t normalBytes = hasNormals() ? 4 * n : 0;
+	const size_t colorBytes = hasColors() ? 4 * n : 0;
+	std::vector<char> data(positionBytes + normalBytes + colorBytes, 0);
+
+	VertexQuantization::quantizePositions(positions_.data(), n, offset, scale, reinterpret_cast<int16_t*>(data.data()));
+	if (normalBytes) {
+		VertexQuantization::packNormals(normals_.data(), n, reinterpret_cast<int8_t*>(data.data() + positionBytes));
+	}
+	if (colorBytes) {
+		VertexQuantization::packColors(colors_.data(), n, reinterpret_cast<uint8_t*>(data.data() + positionBytes + normalBytes));
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+}
+
+bool TriangleMesh::bindBuffers(ContextKey context)
+{
+	if (indices_.empty() || positions_.empty()) return false;
+
+	const unsigned int serial = contextSerial(context);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	Buffers& buffers = buffers_[context];	// zero for a new context
+	if (buffers.vertexBuffer == 0 || buffers.contextSerial != serial) {
+		glGenBuffers(1, &buffers.vertexBuffer);
+		glGenBuffers(1, &buffers.indexBuffer);
+		buffers.revision = revision_ - 1;
+		buffers.contextSerial = serial;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer);
+
+	const bool compact = vertexFormat_ == VertexFormat::Compact;
+	if (buffers.revision != revision_) {
+		if (compact) {
+			uploadCompact();
+		} else {
+			uploadFloat();
+		}
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_.size() * sizeof(uint32_t), indices_.data(), GL_STATIC_DRAW);
+		buffers.revision = revision_;
+	}
+
+	const size_t n = numVertices();
+	const size_t positionBytes = compact ? compactPositionBytes(n) : positions_.size() * sizeof(float);
+	const size_t normalBytes = hasNormals() ? (compact ? 4 * n : normals_.size() * sizeof(float)) : 0;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, compact ? GL_SHORT : GL_FLOAT, 0, nullptr);
+	if (hasNormals()) {
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glNormalPointer(compact ? GL_BYTE : GL_FLOAT, compact ? 4 : 0, reinterpret_cast<const GLvoid*>(positionBytes));
+	}
+	if (hasColors()) {
+		glEnableClientState(GL_COLOR_ARRAY);
+		glColorPointer(4, compact ? GL_UNSIGNED_BYTE : GL_FLOAT, 0, reinterpret_cast<const GLvoid*>(positionBytes + normalBytes));
+	}
+
+	return true;
+}
+
+void TriangleMesh::drawElements() const
+{
+	if (vertexFormat_ == VertexFormat::Compact) {
+		// positions decoded in the vertex stage
+		Eigen::Vector3d offset, scale;
+		VertexQuantization::boxQuantization(bboxMin_, bboxMax_, offset, scale);
+		glPushMatrix();
+		glTranslated(offset.x(), offset.y(), offset.z());
+		glScaled(scale.x(), scale.y(), scale.z());
+	}
+
+	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, nullptr);
+
+	if (vertexFormat_ == VertexFormat::Compact) glPopMatrix();
+}
+
+void TriangleMesh::unbindBuffers() const
+{
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void TriangleMesh::attachContext(ContextKey context)
+{
+	std::lock_guard<std::mutex> lock(contextMutex);
+	++contexts[context].refCount;
+}
+
+void TriangleMesh::detachContext(ContextKey context)
+{
+	std::lock_guard<std::mutex> lock(contextMutex);
+	auto itr = contexts.find(context);
+	if (itr == contexts.end()) return;
+
+	if (--itr->second.refCount <= 0) {
+		// the GL objects go with the context. a new context at the same key starts clean
+		itr->second.refCount = 0;
+		++itr->second.serial;
+		itr->second.unusedBuffers.clear();
+	}
+}
+
+unsigned int TriangleMesh::contextSerial(ContextKey context)
+{
+	std::lock_guard<std::mutex> lock(contextMutex);
+	return contexts[context].serial;
+}
+
+void TriangleMesh::releaseBuffers(ContextKey context, unsigned int serial, const std::vector<GLuint>& names)
+{
+	std::lock_guard<std::mutex> lock(contextMutex);
+	auto itr = contexts.find(context);
+	if (itr == contexts.end() || itr->second.serial != serial) return;
+	itr->second.unusedBuffers.insert(itr->second.unusedBuffers.end(), names.begin(), names.end());
+}
+
+void TriangleMesh::releaseUnusedBuffers(ContextKey context)
+{
+	std::vector<GLuint> names;
+	{
+		std::lock_guard<std::mutex> lock(contextMutex);
+		auto itr = contexts.find(context);
+		if (itr == contexts.end()) return;
+		names.swap(itr->second.unusedBuffers);
+	}
+	if (!names.empty()) glDeleteBuffers(static_cast<GLsizei>(names.size()), names.data());
+}
+
+} /* namespace tgl */
@@ -0,0 +1,120 @@
+/*
+ * TriangleMesh.h
+ */
+
+#ifndef TGL_CORE_TRIANGLEMESH_H_
+#define TGL_CORE_TRIANGLEMESH_H_
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <Eigen/Core>
+#include <GL/gl.h>
+
+namespace tgl {
+
+class TriangleMesh;
+typedef std::shared_ptr<TriangleMesh> TriangleMeshPtr;
+
+// Indexed triangle mesh in float arrays.
+// the arrays are uploaded to a vertex and an index buffer object once per GL context group,
+// on the first draw, and drawn with one glDrawElements (Renderer3D::drawMesh).
+// one mesh may be shared by any number of items and instances.
+// the CPU arrays are kept. setting them again uploads them again on the next draw
+class TriangleMesh {
+public:
+	typedef const void* ContextKey;
+
+	// layout of the buffer objects. the CPU arrays stay float
+	enum class VertexFormat {
+		Float,		// 40 bytes a vertex with normals and colors
+		Compact		// 14 bytes : 16 bit positions in the bounding box, byte normals and colors (VertexQuantization)
+	};
+
+	TriangleMesh();
+	virtual ~TriangleMesh();
+
+	// x,y,z per vertex. normals are x,y,z per vertex, colors r,g,b,a per vertex, both optional (may be empty)
+	void setVertices(std::vector<float> positions, std::vector<float> normals = std::vector<float>(), std::vector<float> colors = std::vector<float>());
+	// 3 per triangle, counter clockwise
+	void setIndices(std::vector<uint32_t> indices);
+	void clear();
+
+	// area weighted vertex normals
+	void computeNormals();
+
+	// uploaded again on the next draw. Compact positions are decoded by the modelview in drawElements()
+	void setVertexFormat(VertexFormat format);
+	VertexFormat vertexFormat() const { return vertexFormat_; }
+
+	const std::vector<float>& positions() const { return positions_; }
+	const std::vector<float>& normals() const { return normals_; }
+	const std::vector<float>& colors() const { return colors_; }
+	const std::vector<uint32_t>& indices() const { return indices_; }
+
+	size_t numVertices() const { return positions_.size() / 3; }
+	size_t numTriangles() const { return indices_.size() / 3; }
+	bool hasNormals() const { return !normals_.empty(); }
+	bool hasColors() const { return !colors_.empty(); }
+
+	const Eigen::Vector3d& boundingBoxMin() const { return bboxMin_; }
+	const Eigen::Vector3d& boundingBoxMax() const { return bboxMax_; }
+
+	// bumped by every change of the arrays
+	unsigned int revision() const { return revision_; }
+
+	// bytes of the vertex and index buffers
+	size_t bufferBytes() const;
+
+	// GL, on the render thread of the context
+	// binds the buffers and sets the client arrays, uploading if needed. false if the mesh is empty
+	bool bindBuffers(ContextKey context);
+	void drawElements() const;
+	void unbindBuffers() const;
+
+	// called by GraphicsView. buffers of destroyed meshes are deleted on the next frame of their context
+	static void attachContext(ContextKey context);
+	static void detachContext(ContextKey context);
+	static void releaseUnusedBuffers(ContextKey context);
+
+	// shared with other owners of buffer objects (CompactPointCloud).
+	// serial changes when the context group goes away, its buffers are then not deleted.
+	// released buffers are deleted by releaseUnusedBuffers() if the serial is still current
+	static unsigned int contextSerial(ContextKey context);
+	static void releaseBuffers(ContextKey context, unsigned int serial, const std::vector<GLuint>& names);
+
+private:
+	TriangleMesh(const TriangleMesh&) = delete;
+	TriangleMesh& operator=(const TriangleMesh&) = delete;
+
+	void updateBoundingBox();
+	void uploadFloat();
+	void uploadCompact();
+
+	std::vector<float> positions_;
+	std::vector<float> normals_;
+	std::vector<float> colors_;
+	std::vector<uint32_t> indices_;
+
+	Eigen::Vector3d bboxMin_;
+	Eigen::Vector3d bboxMax_;
+
+	unsigned int revision_;
+	VertexFormat vertexFormat_;
+
+	struct Buffers {
+		GLuint vertexBuffer;
+		GLuint indexBuffer;
+		unsigned int revision;
+		unsigned int contextSerial;	// buffers of a context that went away are not deleted
+	};
+
+	std::mutex mutex_;
+	std::map<ContextKey, Buffers> buffers_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_TRIANGLEMESH_H_ */
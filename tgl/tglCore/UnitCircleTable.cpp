@@ -0,0 +1,69 @@
+/*
+ * UnitCircleTable.cpp
+ */
+
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include "UnitCircleTable.h"
+
+namespace tgl {
+
+const int UnitCircleTable::MinSegments;	// bound to references by std::min/max
+const int UnitCircleTable::MaxSegments;
+
+namespace {
+
+std::atomic<const UnitCircleTable*> tables[UnitCircleTable::MaxSegments + 1];
+std::mutex tablesMutex;
+
+}
+
+UnitCircleTable::UnitCircleTable(int segments)
+	: segments_(segments)
+{
+	const double angle = 2.0 * M_PI / segments;
+
+	cost_.resize(segments + 1);
+	sint_.resize(segments + 1);
+
+	cost_[0] = 1.0;
+	sint_[0] = 0.0;
+	for (int i = 1; i < segments; ++i) {
+		cost_[i] = cos(angle * i);
+		sint_[i] = sin(angle * i);
+	}
+	cost_[segments] = cost_[0];
+	sint_[segments] = sint_[0];
+}
+
+const UnitCircleTable& UnitCircleTable::get(int segments)
+{
+	segments = std::max(MinSegments, std::min(segments, MaxSegments));
+
+	const UnitCircleTable* table = tables[segments].load(std::memory_order_acquire);
+	if (table) return *table;
+
+	std::unique_lock<std::mutex> lock(tablesMutex);
+	table = tables[segments].load(std::memory_order_relaxed);
+	if (!table) {
+		table = new UnitCircleTable(segments);	// never released
+		tables[segments].store(table, std::memory_order_release);
+	}
+	return *table;
+}
+
+int UnitCircleTable::segmentsForRadius(double radius, double tolerance, int minSegments, int maxSegments)
+{
+	if (radius <= tolerance) return minSegments;
+
+	// chord error : r * (1 - cos(PI/n)) <= tolerance
+	const double a = acos(1.0 - tolerance / radius);
+	int n = static_cast<int>(ceil(M_PI / a));
+	n = (n + 3) / 4 * 4;
+
+	return std::max(minSegments, std::min(n, maxSegments));
+}
+
+} /* namespace tgl */
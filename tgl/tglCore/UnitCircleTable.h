@@ -0,0 +1,40 @@
+/*
+ * UnitCircleTable.h
+ */
+
+#ifndef TGL_CORE_UNITCIRCLETABLE_H_
+#define TGL_CORE_UNITCIRCLETABLE_H_
+
+#include <vector>
+
+namespace tgl {
+
+// Precomputed cos/sin of 2*PI*i/n.
+// Tables are built on first use and shared by every renderer (thread safe).
+// The size of a table is (n+1), the last entry is the same as the first.
+class UnitCircleTable {
+public:
+	static const int MinSegments = 3;
+	static const int MaxSegments = 1024;
+
+	static const UnitCircleTable& get(int segments);
+
+	// number of segments to keep the chord error of a circle with the radius
+	// (in pixels) under the tolerance. rounded up to a multiple of 4
+	static int segmentsForRadius(double radius, double tolerance = 0.25, int minSegments = 8, int maxSegments = 256);
+
+	int segments() const { return segments_; }
+	const double* cost() const { return cost_.data(); }
+	const double* sint() const { return sint_.data(); }
+
+private:
+	UnitCircleTable(int segments);
+
+	int segments_;
+	std::vector<double> cost_;
+	std::vector<double> sint_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_UNITCIRCLETABLE_H_ */
@@ -0,0 +1,142 @@
+/*
+ * UnitPrimitiveMeshes.cpp
+ */
+
+#include <cmath>
+#include <mutex>
+#include <algorithm>
+#include "UnitCircleTable.h"
+#include "UnitPrimitiveMeshes.h"
+
+namespace tgl {
+
+namespace {
+
+const int levelSegmentsTable[UnitPrimitiveMeshes::NumLevels] = {8, 12, 16, 24, 32, 48, 64, 96, 128};
+
+enum Shape { Sphere, Hemisphere, Tube, Disk, NumShapes };
+
+TriangleMeshPtr meshes[NumShapes][UnitPrimitiveMeshes::NumLevels];
+std::mutex meshesMutex;
+
+// rows of rings from the top, (n+1) vertices per ring (the seam is duplicated).
+// ring i is at the polar angle theta[i] (sphere) or at the height z[i] (tube)
+TriangleMeshPtr createRings(int n, int rows, bool tube, double maxTheta)
+{
+	const UnitCircleTable& table = UnitCircleTable::get(n);
+	const double* cost = table.cost();
+	const double* sint = table.sint();
+
+	std::vector<float> positions, normals;
+	positions.reserve((rows + 1) * (n + 1) * 3);
+	normals.reserve((rows + 1) * (n + 1) * 3);
+
+	for (int i = 0; i <= rows; ++i) {
+		double r, z, nr, nz;
+		if (tube) {
+			r = 1.0; z = 0.5 - static_cast<double>(i) / rows;
+			nr = 1.0; nz = 0.0;
+		} else {
+			const double theta = maxTheta * i / rows;
+			r = sin(theta); z = cos(theta);
+			nr = r; nz = z;
+		}
+		for (int j = 0; j <= n; ++j) {
+			positions.push_back(static_cast<float>(r * cost[j]));
+			positions.push_back(static_cast<float>(r * sint[j]));
+			positions.push_back(static_cast<float>(z));
+			normals.push_back(static_cast<float>(nr * cost[j]));
+			normals.push_back(static_cast<float>(nr * sint[j]));
+			normals.push_back(static_cast<float>(nz));
+		}
+	}
+
+	std::vector<uint32_t> indices;
+	indices.reserve(rows * n * 6);
+	for (int i = 0; i < rows; ++i) {
+		for (int j = 0; j < n; ++j) {
+			const uint32_t a = i * (n + 1) + j;
+			const uint32_t b = a + (n + 1);
+			// no degenerate triangles at the poles
+			if (tube || i > 0) {
+				indices.push_back(a); indices.push_back(b); indices.push_back(a + 1);
+			}
+			if (tube || i < rows - 1 || maxTheta < M_PI) {
+				indices.push_back(a + 1); indices.push_back(b); indices.push_back(b + 1);
+			}
+		}
+	}
+
+	TriangleMeshPtr mesh = std::make_shared<TriangleMesh>();
+	mesh->setVertices(std::move(positions), std::move(normals));
+	mesh->setIndices(std::move(indices));
+	return mesh;
+}
+
+TriangleMeshPtr createDisk(int n)
+{
+	const UnitCircleTable& table = UnitCircleTable::get(n);
+
+	std::vector<float> positions = {0.0f, 0.0f, 0.0f};
+	for (int j = 0; j < n; ++j) {
+		positions.push_back(static_cast<float>(table.cost()[j]));
+		positions.push_back(static_cast<float>(table.sint()[j]));
+		positions.push_back(0.0f);
+	}
+	std::vector<float> normals;
+	for (int j = 0; j <= n; ++j) {
+		normals.push_back(0.0f); normals.push_back(0.0f); normals.push_back(1.0f);
+	}
+
+	std::vector<uint32_t> indices;
+	for (int j = 0; j < n; ++j) {
+		indices.push_back(0);
+		indices.push_back(1 + j);
+		indices.push_back(1 + (j + 1) % n);
+	}
+
+	TriangleMeshPtr mesh = std::make_shared<TriangleMesh>();
+	mesh->setVertices(std::move(positions), std::move(normals));
+	mesh->setIndices(std::move(indices));
+	return mesh;
+}
+
+const TriangleMeshPtr& get(Shape shape, int level)
+{
+	level = std::max(0, std::min(level, UnitPrimitiveMeshes::NumLevels - 1));
+
+	std::unique_lock<std::mutex> lock(meshesMutex);
+	TriangleMeshPtr& mesh = meshes[shape][level];
+	if (!mesh) {
+		const int n = levelSegmentsTable[level];
+		switch (shape) {
+			case Sphere:		mesh = createRings(n, n / 2, false, M_PI); break;
+			case Hemisphere:	mesh = createRings(n, n / 4, false, M_PI / 2); break;
+			case Tube:			mesh = createRings(n, 1, true, 0.0); break;
+			default:			mesh = createDisk(n); break;
+		}
+	}
+	return mesh;
+}
+
+}
+
+int UnitPrimitiveMeshes::levelSegments(int level)
+{
+	return levelSegmentsTable[std::max(0, std::min(level, NumLevels - 1))];
+}
+
+int UnitPrimitiveMeshes::levelOf(int segments)
+{
+	for (int level = 0; level < NumLevels; ++level) {
+		if (levelSegmentsTable[level] >= segments) return level;
+	}
+	return NumLevels - 1;
+}
+
+const TriangleMeshPtr& UnitPrimitiveMeshes::sphere(int level) { return get(Sphere, level); }
+const TriangleMeshPtr& UnitPrimitiveMeshes::hemisphere(int level) { return get(Hemisphere, level); }
+const TriangleMeshPtr& UnitPrimitiveMeshes::tube(int level) { return get(Tube, level); }
+const TriangleMeshPtr& UnitPrimitiveMeshes::disk(int level) { return get(Disk, level); }
+
+} /* namespace tgl */
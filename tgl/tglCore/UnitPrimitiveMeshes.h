@@ -0,0 +1,32 @@
+/*
+ * UnitPrimitiveMeshes.h
+ */
+
+#ifndef TGL_CORE_UNITPRIMITIVEMESHES_H_
+#define TGL_CORE_UNITPRIMITIVEMESHES_H_
+
+#include "TriangleMesh.h"
+
+namespace tgl {
+
+// Tessellated unit primitives at a few levels of detail, drawn by Renderer3D in auto quality.
+// meshes are built on first use and shared by every renderer and context (thread safe).
+// all are centered at the origin around the z axis, radius 1
+class UnitPrimitiveMeshes {
+public:
+	static const int NumLevels = 9;
+
+	// segments around the axis of a level, 8 to 128
+	static int levelSegments(int level);
+	// smallest level with at least the segments
+	static int levelOf(int segments);
+
+	static const TriangleMeshPtr& sphere(int level);
+	static const TriangleMeshPtr& hemisphere(int level);	// z >= 0, open at z = 0
+	static const TriangleMeshPtr& tube(int level);			// length 1, open
+	static const TriangleMeshPtr& disk(int level);			// z = 0, facing +z
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_UNITPRIMITIVEMESHES_H_ */
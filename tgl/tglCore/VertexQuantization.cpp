@@ -0,0 +1,160 @@
+/*
+ * VertexQuantization.cpp
+ */
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "VertexQuantization.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TGL_QUANTIZE_SSE2
+#endif
+
+namespace tgl {
+
+namespace {
+
+template <typename T>
+void quantize(const T* xyz, size_t n, const Eigen::Vector3d& offset, const Eigen::Vector3d& scale, int16_t* out)
+{
+	const double inv[3] = {1.0 / scale.x(), 1.0 / scale.y(), 1.0 / scale.z()};
+	for (size_t i = 0; i < n * 3; ++i) {
+		const int k = i % 3;
+		const double q = std::floor((xyz[i] - offset[k]) * inv[k] + 0.5);
+		out[i] = static_cast<int16_t>(std::max(-32768.0, std::min(32767.0, q)));
+	}
+}
+
+inline int8_t toSnorm8(float v)
+{
+	return static_cast<int8_t>(std::floor(std::max(-1.0f, std::min(1.0f, v)) * 127.0f + 0.5f));
+}
+
+// x,y,z normalized to bytes
+inline void storeNormal(float x, float y, float z, int8_t* out)
+{
+	const float length = std::sqrt(x*x + y*y + z*z);
+	const float inv = length > 0.0f ? 1.0f / length : 0.0f;
+	out[0] = toSnorm8(x * inv);
+	out[1] = toSnorm8(y * inv);
+	out[2] = toSnorm8(z * inv);
+	out[3] = 0;
+}
+
+inline void decodeOne(const int8_t* oct, int8_t* out)
+{
+	float x = oct[0] / 127.0f;
+	float y = oct[1] / 127.0f;
+	const float z = 1.0f - std::abs(x) - std::abs(y);
+	const float t = std::max(-z, 0.0f);
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+	storeNormal(x, y, z, out);
+}
+
+}
+
+void VertexQuantization::boxQuantization(const Eigen::Vector3d& min, const Eigen::Vector3d& max, Eigen::Vector3d& offset, Eigen::Vector3d& scale)
+{
+	// q in -32768..32767 spans the largest extent. a scale per axis would bend the normals
+	// of long boxes (rods, plates, terrain tiles) before they are squeezed into bytes
+	double extent = 0.0;
+	for (int k = 0; k < 3; ++k) {
+		extent = std::max(extent, std::max(max[k] - min[k], 1e-9 * std::max(1.0, std::abs(min[k]))));
+	}
+	scale.setConstant(extent / 65535.0);
+	for (int k = 0; k < 3; ++k) {
+		offset[k] = min[k] + 32768.0 * scale[k];
+	}
+}
+
+void VertexQuantization::quantizePositions(const float* xyz, size_t n, const Eigen::Vector3d& offset, const Eigen::Vector3d& scale, int16_t* out)
+{
+	quantize(xyz, n, offset, scale, out);
+}
+
+void VertexQuantization::quantizePositions(const double* xyz, size_t n, const Eigen::Vector3d& offset, const Eigen::Vector3d& scale, int16_t* out)
+{
+	quantize(xyz, n, offset, scale, out);
+}
+
+void VertexQuantization::encodeOctahedral(const float* normals, size_t n, int8_t* out)
+{
+	for (size_t i = 0; i < n; ++i) {
+		const float* v = normals + 3*i;
+		const float sum = std::abs(v[0]) + std::abs(v[1]) + std::abs(v[2]);
+		float x = sum > 0.0f ? v[0] / sum : 0.0f;
+		float y = sum > 0.0f ? v[1] / sum : 0.0f;
+		if (v[2] < 0.0f) {
+			// lower half folded over the diagonals
+			const float fx = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const float fy = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = fx;
+			y = fy;
+		}
+		out[2*i] = toSnorm8(x);
+		out[2*i+1] = toSnorm8(y);
+	}
+}
+
+void VertexQuantization::decodeOctahedral(const int8_t* oct, size_t n, int8_t* out)
+{
+	size_t i = 0;
+
+#if defined(TGL_QUANTIZE_SSE2)
+	// 4 normals per step
+	const __m128 inv127 = _mm_set1_ps(1.0f / 127.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 tiny = _mm_set1_ps(1e-30f);
+	const __m128 s127 = _mm_set1_ps(127.0f);
+	const __m128i byteMask = _mm_set1_epi32(0xff);
+
+	for (; i + 4 <= n; i += 4) {
+		// x0 y0 x1 y1 x2 y2 x3 y3, sign extended to 32 bit
+		const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(oct + 2*i));
+		const __m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+		const __m128 lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16)), inv127);
+		const __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16)), inv127);
+		__m128 x = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 y = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+
+		__m128 z = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), _mm_andnot_ps(signMask, y));
+		const __m128 t = _mm_max_ps(_mm_sub_ps(zero, z), zero);
+		x = _mm_sub_ps(x, _mm_or_ps(t, _mm_and_ps(x, signMask)));	// x -= copysign(t, x)
+		y = _mm_sub_ps(y, _mm_or_ps(t, _mm_and_ps(y, signMask)));
+
+		const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+		const __m128 k = _mm_div_ps(s127, _mm_max_ps(length, tiny));
+
+		const __m128i xi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(x, k)), byteMask);
+		const __m128i yi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(y, k)), byteMask);
+		const __m128i zi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(z, k)), byteMask);
+		const __m128i packed = _mm_or_si128(xi, _mm_or_si128(_mm_slli_epi32(yi, 8), _mm_slli_epi32(zi, 16)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4*i), packed);
+	}
+#endif
+
+	for (; i < n; ++i) {
+		decodeOne(oct + 2*i, out + 4*i);
+	}
+}
+
+void VertexQuantization::packNormals(const float* normals, size_t n, int8_t* out)
+{
+	for (size_t i = 0; i < n; ++i) {
+		storeNormal(normals[3*i], normals[3*i+1], normals[3*i+2], out + 4*i);
+	}
+}
+
+void VertexQuantization::packColors(const float* rgba, size_t n, uint8_t* out)
+{
+	for (size_t i = 0; i < n * 4; ++i) {
+		out[i] = static_cast<uint8_t>(std::floor(std::max(0.0f, std::min(1.0f, rgba[i])) * 255.0f + 0.5f));
+	}
+}
+
+} /* namespace tgl */
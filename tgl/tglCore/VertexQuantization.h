@@ -0,0 +1,43 @@
+/*
+ * VertexQuantization.h
+ */
+
+#ifndef TGL_CORE_VERTEXQUANTIZATION_H_
+#define TGL_CORE_VERTEXQUANTIZATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <Eigen/Core>
+
+namespace tgl {
+
+// Compact vertex attributes.
+// positions : 16 bit signed per coordinate in a box, x = offset + scale * q. the fixed function
+//   pipeline decodes them with a translate and a scale of the modelview (GL_SHORT arrays).
+//   the scale is the same on all axes, so the normals need no correction for it
+// normals : octahedral, 2 signed bytes. decoded to GL_BYTE x,y,z (4 bytes with padding),
+//   with SSE2 where available, before drawing or uploading
+// colors : r,g,b,a bytes (GL_UNSIGNED_BYTE arrays)
+class VertexQuantization {
+public:
+	// offset and scale of the box. one scale from the largest extent for all axes,
+	// a flat box keeps a nonzero scale
+	static void boxQuantization(const Eigen::Vector3d& min, const Eigen::Vector3d& max, Eigen::Vector3d& offset, Eigen::Vector3d& scale);
+
+	static void quantizePositions(const float* xyz, size_t n, const Eigen::Vector3d& offset, const Eigen::Vector3d& scale, int16_t* out);
+	static void quantizePositions(const double* xyz, size_t n, const Eigen::Vector3d& offset, const Eigen::Vector3d& scale, int16_t* out);
+
+	static void encodeOctahedral(const float* normals, size_t n, int8_t* out);
+	// out : x,y,z,0 per normal. the modelview scale of the positions changes their length
+	// (GL_NORMALIZE needed)
+	static void decodeOctahedral(const int8_t* oct, size_t n, int8_t* out);
+
+	// float normals to unit x,y,z,0 bytes
+	static void packNormals(const float* normals, size_t n, int8_t* out);
+	// r,g,b,a in 0..1
+	static void packColors(const float* rgba, size_t n, uint8_t* out);
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_CORE_VERTEXQUANTIZATION_H_ */
@@ -2,6 +2,7 @@
  * GLFWGraphicDriver.cpp
  */
 
+#include <algorithm>
 #include <GLFW/glfw3.h>
 #include "tglCore/GraphicsView.h"
 #include "GLFWGraphicsDriver.h"
@@ -21,6 +22,7 @@ GLFWGraphicsDriver::GLFWGraphicsDriver() {
 	glfwWindow_ = nullptr;
 	width_ = 640;
 	height_ = 480;
+	frameRate_ = 30;
 
 	windowTitle_ = "GraphicsView";
 
@@ -156,14 +158,19 @@ void GLFWGraphicsDriver::execute() {
 			// handle events
 			handleEvents();
 
-			/* Render here */
-			executeGraphicsViewRenderEvent();
+			if (graphicsView()->needsRedraw()) {
+				/* Render here */
+				executeGraphicsViewRenderEvent();
 
-			/* Swap front and back buffers */
-			glfwSwapBuffers(glfwWindow_);
+				/* Swap front and back buffers */
+				glfwSwapBuffers(glfwWindow_);
 
-			/* Poll for and process events */
-			glfwPollEvents();
+				/* Poll for and process events */
+				glfwPollEvents();
+			} else {
+				// rendering on demand, nothing changed : sleep until an event or wakeUp()
+				glfwWaitEventsTimeout(1.0 / std::max(frameRate_, 1));
+			}
 		}
 
 		glfwDestroyWindow(glfwWindow_);
@@ -185,6 +192,12 @@ void GLFWGraphicsDriver::terminate() {
 	}
 }
 
+void GLFWGraphicsDriver::wakeUp() {
+	if (glfwWindow_) {
+		glfwPostEmptyEvent();
+	}
+}
+
 void GLFWGraphicsDriver::resizeGL(int x, int y) {
 	width_ = x;
 	height_ = y;
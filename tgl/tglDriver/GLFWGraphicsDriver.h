@@ -41,6 +41,8 @@ protected:
 	virtual int height() const { return height_; }
 	virtual int frameRate() const { return frameRate_; }
 
+	virtual void wakeUp();
+
 	// event
 	static void mouseButtonEvent(GLFWwindow *window, int button, int action, int mods);
 	static void cursorPosEvent(GLFWwindow *window, double x, double y);
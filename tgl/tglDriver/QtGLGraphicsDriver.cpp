@@ -35,7 +35,7 @@ void QtGLGraphicsDriver::execute()
 {
 	QGLWidget::show();
 
-	connect(&timer_, SIGNAL(timeout()), this, SLOT(updateGL()));
+	connect(&timer_, SIGNAL(timeout()), this, SLOT(timeout()));
 	timer_.start(1000/frameRate_);
 }
 
@@ -79,6 +79,13 @@ int QtGLGraphicsDriver::frameRate() const
 	return frameRate_;
 }
 
+void QtGLGraphicsDriver::timeout()
+{
+	if (graphicsView() && graphicsView()->needsRedraw()) {
+		updateGL();
+	}
+}
+
 // qt event
 void QtGLGraphicsDriver::initializeGL()
 {
@@ -51,6 +51,12 @@ protected:
 
 	Key keymap(int key);
 
+protected slots:
+	// draws a frame on the timer, or skips it when rendering on demand and nothing changed
+	void timeout();
+
+protected:
+
 	int frameRate_;
 
 	QTimer timer_;
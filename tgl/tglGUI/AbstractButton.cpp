@@ -44,12 +44,16 @@ void AbstractButton::setCheckable(bool on)
 
 void AbstractButton::setDown(bool down)
 {
+	if (down_ == down) return;
 	down_ = down;
+	update();
 }
 
 void AbstractButton::setText(const std::string& text)
 {
+	if (text_ == text) return;
 	text_ = text;
+	update();
 }
 
 const std::string& AbstractButton::text() const
@@ -65,7 +69,9 @@ void AbstractButton::click()
 
 void AbstractButton::setChecked(bool checked)
 {
+	if (checked_ == checked) return;
 	checked_ = checked;
+	update();
 }
 
 void AbstractButton::toggle()
@@ -6,7 +6,6 @@
 
 #include "tglCore/Renderer2D.h"
 #include "tglCore/Renderer3D.h"
-#include "tglCore/TextRenderer.h"
 #include "tglCore/GraphicsItemEvent.h"
 #include "DockWidget.h"
 
@@ -53,14 +52,29 @@ void DockWidget::init()
 
 	enableTitleBar_ = true;
 	titleBarHeight_ = 20;
+	contentsHeight_ = 0;
 	showWidgets_ = true;
 }
 
+void DockWidget::setWindowTitle(const std::string& windowTitle)
+{
+	if (windowTitle_ == windowTitle) return;
+	windowTitle_ = windowTitle;
+	update();
+}
+
+void DockWidget::setEnableTitleBar(bool enable)
+{
+	if (enableTitleBar_ == enable) return;
+	enableTitleBar_ = enable;
+	update();
+}
+
 void DockWidget::titleBarButtonToggled(bool toggle)
 {
 //	cout << "toggle : " << toggle << endl;
 	showWidgets_ = toggle;
-
+	update();
 }
 
 void DockWidget::titleBarButtonPressed()
@@ -95,66 +109,49 @@ void DockWidget::addWidget(WidgetPtr widget)
 	addedWidgets_.push_back(widget);
 }
 
-void DockWidget::render2DScene(tgl::Renderer2D* r)
+void DockWidget::paintRect(int& x, int& y, int& w, int& h) const
 {
-	int x, y, w, h;
-	x = this->x();
-	y = this->y();
-	Widget* parent = dynamic_cast<Widget*>(parentItem());
-	if (parent) {
-		x += parent->x();
-		y += parent->y();
+	x = globalX();
+	y = globalY();
+	w = width();
+	h = 0;
+
+	if (isEnabledTitleBar()) {
+		h = titleBarHeight_;
+		if (showWidgets_) h += contentsHeight_;
 	}
+}
 
-	w = this->width();
-	h = this->height();
+void DockWidget::layoutEvent()
+{
 	int hy = 0;
 
-	r->setRectMode(tgl::Renderer2D::Mode::Corner);
-	r->setStrokeWeight(1);
-	r->setStrokeColor(0.3, 0.3, 0.3);
-
-	// draw title bar
+	// title bar
 	if (isEnabledTitleBar()) {
 		titleBarButton_->setVisible(true);
-		titleBarButton_->setPos(w - 20, titleBarHeight_/4);
-
-		double tc[] = {0.1, 0.1, 0.1, 0.8};
-		r->setFillColor(tc[0], tc[1], tc[2], tc[3]);
-		r->drawRect(x, y, w, titleBarHeight_);
-
-		y += titleBarHeight_;
+		titleBarButton_->setPos(width() - 20, titleBarHeight_/4);
 		hy = titleBarHeight_;
 	} else {
 		titleBarButton_->setVisible(false);
 	}
 
-	// draw widgets container
-	if (!showWidgets_) {
-		for (size_t i = 0; i < this->addedWidgets_.size(); ++i) {
-			WidgetPtr child = addedWidgets_[i];
-			if (child) {
-				child->setVisible(false);
-			}
+	// widgets container
+	for (size_t i = 0; i < this->addedWidgets_.size(); ++i) {
+		WidgetPtr child = addedWidgets_[i];
+		if (child) {
+			child->setVisible(showWidgets_);
 		}
+	}
 
+	if (!showWidgets_) {
+		contentsHeight_ = 0;
 		return;
-
-	} else {
-		for (size_t i = 0; i < this->addedWidgets_.size(); ++i) {
-			WidgetPtr child = addedWidgets_[i];
-			if (child) {
-				child->setVisible(true);
-			}
-		}
 	}
 
 	int padx = 4;
 	int pady = 4;
-	int xx = x + padx;
 	int yy = hy + pady;
-	w = this->width();
-	h = pady;
+	int h = pady;
 
 	for (size_t i = 0; i < this->addedWidgets_.size(); ++i) {
 		WidgetPtr child = addedWidgets_[i];
@@ -167,33 +164,41 @@ void DockWidget::render2DScene(tgl::Renderer2D* r)
 		}
 	}
 
-	if (isEnabledTitleBar()) {
-		r->setFillColor(1,1,1, 0.4);
-
-		r->setStrokeColor(0.3, 0.3, 0.3);
-		r->setStrokeWeight(1);
-
-		r->drawRect(x,y,w,h);
+	if (contentsHeight_ != h) {
+		contentsHeight_ = h;
+		update();
 	}
 }
 
-void DockWidget::renderTextScene(tgl::TextRenderer* r)
+void DockWidget::paintEvent(tgl::Renderer2D* r)
 {
-	if (!isEnabledTitleBar() || windowTitle_.empty()) return;
+	r->setRectMode(tgl::Renderer2D::Mode::Corner);
+	r->setStrokeWeight(1);
+	r->setStrokeColor(0.3, 0.3, 0.3);
 
-	int x = this->x();
-	int y = this->y();
-	Widget* parent = dynamic_cast<Widget*>(parentItem());
-	if (parent) {
-		x += parent->x();
-		y += parent->y();
-	}
+	if (!isEnabledTitleBar()) return;
+
+	int x = this->globalX();
+	int y = this->globalY();
+	int w = this->width();
 
-	x += 20;
-	y += titleBarHeight_ - 5;
+	// draw title bar
+	double tc[] = {0.1, 0.1, 0.1, 0.8};
+	r->setFillColor(tc[0], tc[1], tc[2], tc[3]);
+	r->drawRect(x, y, w, titleBarHeight_);
+
+	if (!windowTitle_.empty()) {
+		r->setTextColor(1,1,1);
+		r->setTextSize(16);
+		r->setTextAlign(tgl::Renderer2D::Align::Left, tgl::Renderer2D::VAlign::Bottom);
+		r->drawText(x + 20, y + titleBarHeight_ - 5, windowTitle_);
+	}
 
-	r->setTextColor(1,1,1);
-	r->drawText(x, y, windowTitle_);
+	// draw widgets container
+	if (showWidgets_) {
+		r->setFillColor(1,1,1, 0.4);
+		r->drawRect(x, y + titleBarHeight_, w, contentsHeight_);
+	}
 }
 
 void DockWidget::mouseDoubleClickEvent(tgl::GraphicsItemMouseEvent* e)
@@ -216,15 +221,25 @@ void DockWidget::mouseReleaseEvent(tgl::GraphicsItemMouseEvent* e)
 
 }
 
-void DockWidget::TitleBarButton::render2DScene(tgl::Renderer2D* r)
+void DockWidget::TitleBarButton::paintRect(int& x, int& y, int& w, int& h) const
 {
-	int x = this->x();
-	int y = this->y();
-	Widget* parent = dynamic_cast<Widget*>(parentItem());
-	if (parent) {
-		x += parent->x();
-		y += parent->y();
-	}
+	// circle around the position
+	x = globalX() - 8;
+	y = globalY() - 8;
+	w = h = 16;
+}
+
+bool DockWidget::TitleBarButton::contains2D(int x, int y) const
+{
+	const int dx = x - globalX();
+	const int dy = y - globalY();
+	return isEnabled() && dx*dx + dy*dy <= 8*8;
+}
+
+void DockWidget::TitleBarButton::paintEvent(tgl::Renderer2D* r)
+{
+	int x = this->globalX();
+	int y = this->globalY();
 
 	r->setFillColor(0.9, 0.9, 0.9);
 	r->drawCircle(x, y, 8);
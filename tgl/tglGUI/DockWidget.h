@@ -25,7 +25,7 @@ public:
 	DockWidget(const std::string& windowTitle);
 	virtual ~DockWidget();
 
-	void setWindowTitle(const std::string& windowTitle) { windowTitle_ = windowTitle; }
+	void setWindowTitle(const std::string& windowTitle);
 	const std::string& windowTitle() const { return windowTitle_; }
 
 	void setEnableTitleBar(bool enable);
@@ -38,6 +38,8 @@ public:
 
 	size_t numWidgets() const { return addedWidgets_.size(); }
 
+	virtual void paintRect(int& x, int& y, int& w, int& h) const;
+
 	virtual void titleBarButtonToggled(bool toggle);
 	virtual void titleBarButtonPressed();
 
@@ -45,15 +47,17 @@ protected:
 
 	class TitleBarButton : public PushButton {
 	public:
-		virtual void render2DScene(tgl::Renderer2D* r);
-		virtual void renderPicking2DScene(tgl::Renderer2D* r) { render2DScene(r); }
+		virtual void paintRect(int& x, int& y, int& w, int& h) const;
+		virtual bool contains2D(int x, int y) const;
+	protected:
+		virtual void paintEvent(tgl::Renderer2D* r);
 	};
 
 	void init();
 
 	// render
-	virtual void render2DScene(tgl::Renderer2D* r);
-	virtual void renderTextScene(tgl::TextRenderer* r);
+	virtual void layoutEvent();
+	virtual void paintEvent(tgl::Renderer2D* r);
 
 	// Mouse event
 	virtual void mouseDoubleClickEvent(tgl::GraphicsItemMouseEvent* e);
@@ -71,6 +75,7 @@ protected:
 	bool showWidgets_;
 
 	int titleBarHeight_;
+	int contentsHeight_;	// height of the widgets container, set by layoutEvent()
 };
 
 }
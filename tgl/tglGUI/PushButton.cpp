@@ -34,24 +34,25 @@ PushButton::~PushButton()
 void PushButton::setCheckedColor(double r, double g, double b, double a)
 {
 	checkedColor_ = {{r, g, b, a}};
+	update();
 }
 
-void PushButton::render2DScene(tgl::Renderer2D* r)
+bool PushButton::contains2D(int x, int y) const
+{
+	return isEnabled() && AbstractButton::contains2D(x, y);
+}
+
+void PushButton::paintEvent(tgl::Renderer2D* r)
 {
 	if (!isEnabled() || !isVisible()) return;
 
 	int x, y, w, h;
-	x = this->x();
-	y = this->y();
-	Widget* parent = dynamic_cast<Widget*>(parentItem());
-	if (parent) {
-		x += parent->x();
-		y += parent->y();
-	}
-
+	x = this->globalX();
+	y = this->globalY();
 	w = this->width();
 	h = this->height();
 
+	r->setRectMode(tgl::Renderer2D::Mode::Corner);
 	r->setStrokeColor(0.3, 0.3, 0.3);
 	r->setStrokeWeight(1);
 
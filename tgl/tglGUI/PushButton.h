@@ -26,9 +26,12 @@ public:
 	void setCheckedColor(double r, double g, double b, double a = 1.0);
 	const std::array<double, 4> checkedColor() const { return checkedColor_; }
 
+	// a disabled button is not painted and not picked
+	virtual bool contains2D(int x, int y) const;
+
 protected:
 
-	virtual void render2DScene(tgl::Renderer2D* r);
+	virtual void paintEvent(tgl::Renderer2D* r);
 
 	std::array<double, 4> checkedColor_;
 
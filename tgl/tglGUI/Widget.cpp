@@ -2,6 +2,10 @@
  * Widget.cpp
  */
 
+#include <algorithm>
+
+#include "tglCore/GraphicsView.h"
+#include "tglCore/Renderer2D.h"
 #include "Widget.h"
 
 namespace tgl
@@ -9,6 +13,11 @@ namespace tgl
 namespace gui
 {
 
+namespace {
+// extra pixels around the layer for strokes and text overhanging the widget rect
+const int layerMargin = 4;
+}
+
 Widget::Widget()
 {
 	enabled_ = true;
@@ -18,6 +27,14 @@ Widget::Widget()
 
 	x_ = 0;
 	y_ = 0;
+
+	retained_ = true;
+	dirty_ = true;
+	layered_ = false;
+
+	// widgets take the mouse, so that the scene under them is not picked
+	setAcceptHoverEvents(true);
+	setAcceptMouseEvents(true);
 }
 
 Widget::~Widget()
@@ -25,27 +42,196 @@ Widget::~Widget()
 
 }
 
+void Widget::setEnabled(bool on)
+{
+	if (enabled_ == on) return;
+	enabled_ = on;
+	update();
+}
+
+void Widget::setVisible(bool visible)
+{
+	if (isVisible() != visible) update();
+	GraphicsItem::setVisible(visible);
+}
+
 void Widget::setSize(int width, int height)
 {
+	if (width_ == width && height_ == height) return;
 	width_ = width;
 	height_ = height;
+	update();
 }
 
 void Widget::setPos(int x, int y)
 {
+	if (x_ == x && y_ == y) return;
 	x_ = x;
 	y_ = y;
+
+	// moving a top level widget only moves its texture. the layer stays clean,
+	// but the frame and the hit rect change
+	if (parentWidget()) {
+		update();
+	} else {
+		GraphicsItem::update();
+	}
+}
+
+int Widget::globalX() const
+{
+	Widget* parent = parentWidget();
+	return parent ? parent->globalX() + x_ : x_;
+}
+
+int Widget::globalY() const
+{
+	Widget* parent = parentWidget();
+	return parent ? parent->globalY() + y_ : y_;
+}
+
+void Widget::paintRect(int& x, int& y, int& w, int& h) const
+{
+	x = globalX();
+	y = globalY();
+	w = width_;
+	h = height_;
+}
+
+bool Widget::boundingRect2D(int& x, int& y, int& w, int& h) const
+{
+	paintRect(x, y, w, h);
+	return true;
+}
+
+Widget* Widget::parentWidget() const
+{
+	return dynamic_cast<Widget*>(parentItem());
+}
+
+Widget* Widget::topLevelWidget()
+{
+	Widget* widget = this;
+	while (Widget* parent = widget->parentWidget()) {
+		widget = parent;
+	}
+	return widget;
+}
+
+void Widget::setRetained(bool on)
+{
+	retained_ = on;
+	dirty_ = true;
+}
+
+void Widget::update()
+{
+	topLevelWidget()->dirty_ = true;
+
+	GraphicsItem::update();
 }
 
 void Widget::addWidget(WidgetPtr widget)
 {
 	addChild(widget);
+	update();
 }
 
 void Widget::removeWidget(WidgetPtr widget)
 {
+	update();
 	removeChild(widget);
 }
 
+void Widget::render2DScene(tgl::Renderer2D* r)
+{
+	Widget* top = topLevelWidget();
+	if (top != this) {
+		if (top->layered_) return;	// already in the texture of the top level widget
+
+		layoutEvent();
+		paintEvent(r);
+		return;
+	}
+
+	layered_ = false;
+
+	if (retained_) {
+		layoutTree();	// may call update()
+
+		int x, y, w, h;
+		treeRect(x, y, w, h);
+		x -= layerMargin;
+		y -= layerMargin;
+		w += layerMargin*2;
+		h += layerMargin*2;
+
+		if (dirty_ || !r->hasLayer(this, w, h)) {
+			if (r->beginLayer(this, w, h)) {
+				r->translate(-x, -y);
+				paintTree(r);
+				r->endLayer();
+				dirty_ = false;
+			}
+		}
+
+		if (r->hasLayer(this, w, h)) {
+			r->drawLayer(this, x, y);
+			layered_ = true;
+			return;
+		}
+	}
+
+	// immediate mode, the children paint themselves
+	layoutEvent();
+	paintEvent(r);
+}
+
+void Widget::layoutTree()
+{
+	layoutEvent();
+	for (auto item : childItems()) {
+		Widget* child = dynamic_cast<Widget*>(item.get());
+		if (child && child->isVisible()) child->layoutTree();
+	}
+}
+
+void Widget::paintTree(tgl::Renderer2D* r)
+{
+	paintEvent(r);
+	for (auto item : childItems()) {
+		Widget* child = dynamic_cast<Widget*>(item.get());
+		if (child && child->isVisible()) child->paintTree(r);
+	}
+}
+
+void Widget::treeRect(int& x, int& y, int& w, int& h) const
+{
+	paintRect(x, y, w, h);
+	if (w <= 0 || h <= 0) {
+		w = h = 0;
+	}
+
+	for (auto item : childItems()) {
+		const Widget* child = dynamic_cast<const Widget*>(item.get());
+		if (!child || !child->isVisible()) continue;
+
+		int cx, cy, cw, ch;
+		child->treeRect(cx, cy, cw, ch);
+		if (cw <= 0 || ch <= 0) continue;
+
+		if (w <= 0 || h <= 0) {
+			x = cx; y = cy; w = cw; h = ch;
+		} else {
+			const int x2 = std::max(x + w, cx + cw);
+			const int y2 = std::max(y + h, cy + ch);
+			x = std::min(x, cx);
+			y = std::min(y, cy);
+			w = x2 - x;
+			h = y2 - y;
+		}
+	}
+}
+
 }
 }
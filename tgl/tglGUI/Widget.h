@@ -21,10 +21,12 @@ public:
 	Widget();
 	virtual ~Widget();
 
-	void setEnabled(bool on) { enabled_ = on; }
+	void setEnabled(bool on);
 
 	bool isEnabled() const { return enabled_; }
 
+	virtual void setVisible(bool visible);
+
 	void setSize(int width, int height);
 	void setPos(int x, int y);
 
@@ -34,10 +36,46 @@ public:
 	int x() const { return x_; }
 	int y() const { return y_; }
 
+	// position on the view
+	int globalX() const;
+	int globalY() const;
+
+	// area painted by this widget on the view (children are not included)
+	virtual void paintRect(int& x, int& y, int& w, int& h) const;
+
+	// 2D hit test by paintRect()
+	virtual bool boundingRect2D(int& x, int& y, int& w, int& h) const;
+
+	Widget* parentWidget() const;
+	Widget* topLevelWidget();
+
+	// retained mode (default on)
+	// a top level widget paints itself and its children into a texture,
+	// which is painted again only after update() and drawn as one quad otherwise
+	void setRetained(bool on);
+	bool isRetained() const { return retained_; }
+
+	// request repaint. call it when a subclass changes what paintEvent() draws
+	void update();
+
 	virtual void addWidget(WidgetPtr widget);
 	virtual void removeWidget(WidgetPtr widget);
 
 protected:
+	// draws the cached texture, or calls layoutEvent() and paintEvent()
+	virtual void render2DScene(tgl::Renderer2D* r);
+	virtual void renderPicking2DScene(tgl::Renderer2D* r) { paintEvent(r); }
+
+	// places the children. called every frame before painting
+	virtual void layoutEvent() {}
+
+	// paints this widget. the children paint themselves
+	virtual void paintEvent(tgl::Renderer2D* /* r */) {}
+
+	void layoutTree();
+	void paintTree(tgl::Renderer2D* r);
+	void treeRect(int& x, int& y, int& w, int& h) const;
+
 	bool enabled_;
 
 	int width_;
@@ -45,6 +83,10 @@ protected:
 
 	int x_;
 	int y_;
+
+	bool retained_;
+	bool dirty_;
+	bool layered_;		// drawn from the texture in this frame
 };
 
 }
@@ -2,6 +2,8 @@
  * RotateHandle.cpp
  */
 
+#include <cmath>
+#include <vector>
 #include "tglCore/GraphicsView.h"
 #include "tglUtil/Intersection.h"
 #include "tglUtil/EigenUtil.h"
@@ -10,13 +12,434 @@
 namespace tgl {
 namespace handle {
 
+namespace
+{
+
+const double ringRadius = 0.8;		// scale 1.0 の時の半径
+const double ringThickness = 0.04;	// picking tolerance of the ring tube
+const double ballRadius = 0.7;
+
+// unit circle on the xy plane, built once and shared by every ring
+const std::vector<double>& unitCircle()
+{
+	static const std::vector<double> circle = [](){
+		const int n = 64;
+		std::vector<double> v;
+		v.reserve(n * 3);
+		for (int i = 0; i < n; ++i) {
+			double a = 2.0 * M_PI * i / n;
+			v.push_back(std::cos(a));
+			v.push_back(std::sin(a));
+			v.push_back(0.0);
+		}
+		return v;
+	}();
+	return circle;
+}
+
+void drawRingMesh(const Eigen::Vector3d& pos, const Eigen::Matrix3d& R, double radius)
+{
+	const std::vector<double>& circle = unitCircle();
+
+	Eigen::Matrix4d M(Eigen::Matrix4d::Identity());
+	M.block<3,3>(0,0) = radius * R;
+	M.block<3,1>(0,3) = pos;
+
+	glPushMatrix();
+	glMultMatrixd(M.data());
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_DOUBLE, 0, circle.data());
+	glDrawArrays(GL_LINE_LOOP, 0, circle.size() / 3);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glPopMatrix();
+}
+
+}
+
 RotateHandle::RotateHandle() {
+	se3_ = std::make_shared<SE3>();
+
+	scale_ = 1.0;
+	autoScale_ = true;
+
+	pickingPosition_.setZero();
+	pickingAttitude_.setIdentity();
+
+	xHandle_ = Rotate1DHandlePtr(new Rotate1DHandle);
+	yHandle_ = Rotate1DHandlePtr(new Rotate1DHandle);
+	zHandle_ = Rotate1DHandlePtr(new Rotate1DHandle);
+
+	xHandle_->setAxis(1,0,0);
+	yHandle_->setAxis(0,1,0);
+	zHandle_->setAxis(0,0,1);
+
+	xHandle_->setColor(1,0,0);
+	yHandle_->setColor(0,0,1);
+	zHandle_->setColor(0,1,0);
 
+	// set hover color
+	xHandle_->setHoverColor(0.0,0.8,1);
+	yHandle_->setHoverColor(0.0,0.8,1);
+	zHandle_->setHoverColor(0.0,0.8,1);
+
+	// set trackball
+	xyzHandle_ = Rotate3DHandlePtr(new Rotate3DHandle);
+
+	addChild(xyzHandle_);
+	addChild(xHandle_);
+	addChild(yHandle_);
+	addChild(zHandle_);
+
+	// set signal slot
+	xHandle_->sigRotationChanged().connect(boost::bind(&RotateHandle::slotRotationChanged, this, _1));
+	yHandle_->sigRotationChanged().connect(boost::bind(&RotateHandle::slotRotationChanged, this, _1));
+	zHandle_->sigRotationChanged().connect(boost::bind(&RotateHandle::slotRotationChanged, this, _1));
+	xyzHandle_->sigRotationChanged().connect(boost::bind(&RotateHandle::slotRotationChanged, this, _1));
+
+	// set se3
+	xHandle_->set(se3_);
+	yHandle_->set(se3_);
+	zHandle_->set(se3_);
+	xyzHandle_->set(se3_);
 }
 
 RotateHandle::~RotateHandle() {
 
 }
 
+void RotateHandle::set(SE3GroupPtr group) {
+	set(group ? group->pivot() : std::make_shared<SE3>());
+	group_ = group;
+}
+
+void RotateHandle::set(SE3Ptr se3) {
+	group_ = nullptr;
+	se3_ = se3;
+	xHandle_->set(se3);
+	yHandle_->set(se3);
+	zHandle_->set(se3);
+	xyzHandle_->set(se3);
+
+	update();
+}
+
+void RotateHandle::setScale(double scale) {
+	scale_ = scale;
+	xHandle_->setScale(scale);
+	yHandle_->setScale(scale);
+	zHandle_->setScale(scale);
+	xyzHandle_->setScale(scale);
+
+	update();
+}
+
+void RotateHandle::setImmediateNotification(bool on) {
+	xHandle_->setImmediateNotification(on);
+	yHandle_->setImmediateNotification(on);
+	zHandle_->setImmediateNotification(on);
+	xyzHandle_->setImmediateNotification(on);
+}
+
+void RotateHandle::setAutoScale(bool on) {
+	autoScale_ = on;
+	update();
+}
+
+void RotateHandle::renderScene(tgl::Renderer3D* /*r*/)
+{
+	// one change signal per frame for the whole group
+	if (group_) group_->flush();
+
+	// the shared se3 may be moved by others
+	if (se3_->position() != pickingPosition_ || se3_->attitude() != pickingAttitude_) {
+		pickingPosition_ = se3_->position();
+		pickingAttitude_ = se3_->attitude();
+		graphicsWindow()->invalidatePicking();
+	}
+
+	// set auto scale
+	if (autoScale_) {
+		Eigen::Vector3d dist(se3_->position() - this->graphicsWindow()->camera()->position());
+		double d = dist.norm();
+		if (d < 0.0001) d = 0.0001;
+		double scale = scale_ * 0.16*d;
+
+		double w = this->viewHeight() / 480.0;	// h : 480の時基準
+		double windowScale = 1.0 / w;
+		scale *= windowScale;
+
+		xHandle_->setScale(scale);
+		yHandle_->setScale(scale);
+		zHandle_->setScale(scale);
+		xyzHandle_->setScale(scale);
+	}
+}
+
+// Rotate1DHandle
+Rotate1DHandle::Rotate1DHandle()
+{
+	se3_ = std::make_shared<SE3>();
+	scale_ = 1.0;
+
+	color_ = {{1, 0, 0, 1}};
+	hoverColor_ = {{0.0, 0.8, 1, 1}};
+	draggingColor_ = {{0.0, 0.8, 1, 1}};
+
+	axis_ << 0,0,1;
+	R_.setIdentity();
+
+	hoverd_ = false;
+	dragged_ = false;
+
+	preV_.setZero();
+
+	setAcceptHoverEvents(true);
+	setAcceptMouseEvents(true);
+	setRayPicking(RayPicking::Overlay);
+	setSelectPicking2D(false);		// nothing is drawn in 2D
+
+	// emitted once per frame
+	changeNotifier_.setCallback([this](){
+		if (se3_) sigRotationChanged_(se3_->attitude());
+	});
+	addChangeNotifier(&changeNotifier_);
+}
+
+Rotate1DHandle::~Rotate1DHandle()
+{
+
+}
+
+void Rotate1DHandle::set(SE3Ptr se3)
+{
+	se3_ = se3;
+}
+
+void Rotate1DHandle::setAxis(double x, double y, double z)
+{
+	axis_ << x, y, z;
+	axis_.normalize();
+
+	Eigen::Vector3d u(axis_.unitOrthogonal());
+	R_.col(0) = u;
+	R_.col(1) = axis_.cross(u);
+	R_.col(2) = axis_;
+}
+
+bool Rotate1DHandle::intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const
+{
+	if (!se3_) return false;
+	return calcIntersectionRayAndTorus(distance, origin, dir, se3_->position(), axis_, scale_ * ringRadius, scale_ * ringThickness);
+}
+
+// Hover event
+void Rotate1DHandle::hoverEnterEvent(tgl::GraphicsItemHoverEvent* /*e*/)
+{
+	hoverd_ = true;
+}
+
+void Rotate1DHandle::hoverLeaveEvent(tgl::GraphicsItemHoverEvent* /*e*/)
+{
+	hoverd_ = false;
+}
+
+void Rotate1DHandle::renderOverlayScene(tgl::Renderer3D* r)
+{
+	if (!se3_) return;
+
+	const double* c = color_.data();
+	if (dragged_) {
+		c = draggingColor_.data();
+	} else if (hoverd_) {
+		c = hoverColor_.data();
+	}
+
+	r->disableLighting();
+	r->setLineWidth(hoverd_ || dragged_ ? 4 : 2);
+	r->setColor(c[0], c[1], c[2], c[3]);
+	drawRingMesh(se3_->position(), R_, scale_ * ringRadius);
+	r->enableLighting();
+}
+
+bool Rotate1DHandle::planeDirection(int x, int y, Eigen::Vector3d& v) const
+{
+	Eigen::Vector3d origin, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, origin, dir);
+
+	// ring plane seen edge-on
+	double dn = dir.dot(axis_);
+	if (std::abs(dn) < 1.0e-6) return false;
+
+	double t = (se3_->position() - origin).dot(axis_) / dn;
+	Eigen::Vector3d q(origin + t * dir - se3_->position());
+	q -= q.dot(axis_) * axis_;
+	if (q.norm() < 1.0e-9) return false;
+
+	v = q.normalized();
+	return true;
+}
+
+void Rotate1DHandle::mousePressEvent(tgl::GraphicsItemMouseEvent* e)
+{
+	dragged_ = true;
+	if (!se3_) return;
+
+	if (!planeDirection(e->x(), e->y(), preV_)) {
+		preV_.setZero();
+	}
+}
+
+void Rotate1DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
+{
+	if (!se3_) return;
+
+	Eigen::Vector3d v;
+	if (!planeDirection(e->x(), e->y(), v)) return;
+	if (preV_.isZero()) {
+		preV_ = v;
+		return;
+	}
+
+	// signed angle around the axis
+	double angle = std::atan2(axis_.dot(preV_.cross(v)), preV_.dot(v));
+	preV_ = v;
+
+	se3_->setAttitude(Eigen::Matrix3d(rodrigues(axis_, angle) * se3_->attitude()));
+
+	// emit
+	changeNotifier_.notify();
+}
+
+void Rotate1DHandle::mouseReleaseEvent(tgl::GraphicsItemMouseEvent* /*e*/)
+{
+	dragged_ = false;
+}
+
+// Rotate3DHandle
+Rotate3DHandle::Rotate3DHandle()
+{
+	se3_ = std::make_shared<SE3>();
+	scale_ = 1.0;
+	radius_ = ballRadius;
+
+	color_ = {{0.6, 0.6, 0.6, 1}};
+	hoverColor_ = {{0.0, 0.8, 1, 0.15}};
+
+	hoverd_ = false;
+	dragged_ = false;
+
+	preV_.setZero();
+
+	setAcceptHoverEvents(true);
+	setAcceptMouseEvents(true);
+	setRayPicking(RayPicking::Overlay);
+	setSelectPicking2D(false);		// nothing is drawn in 2D
+
+	// emitted once per frame
+	changeNotifier_.setCallback([this](){
+		if (se3_) sigRotationChanged_(se3_->attitude());
+	});
+	addChangeNotifier(&changeNotifier_);
+}
+
+Rotate3DHandle::~Rotate3DHandle()
+{
+
+}
+
+void Rotate3DHandle::set(SE3Ptr se3)
+{
+	se3_ = se3;
+}
+
+bool Rotate3DHandle::intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const
+{
+	if (!se3_) return false;
+	return calcIntersectionRayAndSphere(distance, origin, dir, se3_->position(), radius());
+}
+
+// Hover event
+void Rotate3DHandle::hoverEnterEvent(tgl::GraphicsItemHoverEvent* /*e*/)
+{
+	hoverd_ = true;
+}
+
+void Rotate3DHandle::hoverLeaveEvent(tgl::GraphicsItemHoverEvent* /*e*/)
+{
+	hoverd_ = false;
+}
+
+void Rotate3DHandle::renderOverlayScene(tgl::Renderer3D* r)
+{
+	if (!se3_) return;
+
+	// silhouette facing the camera
+	const Eigen::Matrix3d& cR = graphicsWindow()->camera()->rotation();
+
+	r->disableLighting();
+	r->setLineWidth(1);
+	r->setColor(color_[0], color_[1], color_[2], color_[3]);
+	drawRingMesh(se3_->position(), cR, radius());
+
+	if (hoverd_ || dragged_) {
+		Eigen::Matrix3d tR = cR.transpose();
+		glDepthMask(GL_FALSE);		// do not hide the rings behind
+		r->setColor(hoverColor_[0], hoverColor_[1], hoverColor_[2], hoverColor_[3]);
+		r->drawCircle(se3_->position().data(), tR.data(), radius());
+		glDepthMask(GL_TRUE);
+	}
+	r->enableLighting();
+}
+
+Eigen::Vector3d Rotate3DHandle::ballDirection(int x, int y) const
+{
+	Eigen::Vector3d origin, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, origin, dir);
+	dir.normalize();
+
+	const Eigen::Vector3d& c = se3_->position();
+
+	double t;
+	if (calcIntersectionRayAndSphere(t, origin, dir, c, radius())) {
+		return Eigen::Vector3d(origin + t * dir - c).normalized();
+	}
+
+	// outside of the ball
+	Eigen::Vector3d w(origin + (c - origin).dot(dir) * dir - c);
+	return w.normalized();
+}
+
+void Rotate3DHandle::mousePressEvent(tgl::GraphicsItemMouseEvent* e)
+{
+	dragged_ = true;
+	if (!se3_) return;
+
+	preV_ = ballDirection(e->x(), e->y());
+}
+
+void Rotate3DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
+{
+	if (!se3_) return;
+
+	Eigen::Vector3d v = ballDirection(e->x(), e->y());
+
+	Eigen::Vector3d axis(preV_.cross(v));
+	double s = axis.norm();
+	if (s < 1.0e-9) return;
+
+	double angle = std::atan2(s, preV_.dot(v));
+	preV_ = v;
+
+	se3_->setAttitude(Eigen::Matrix3d(rodrigues(Eigen::Vector3d(axis / s), angle) * se3_->attitude()));
+
+	// emit
+	changeNotifier_.notify();
+}
+
+void Rotate3DHandle::mouseReleaseEvent(tgl::GraphicsItemMouseEvent* /*e*/)
+{
+	dragged_ = false;
+}
+
 } /* namespace handle */
 } /* namespace tgl */
@@ -10,14 +10,189 @@
 #include <boost/signals2.hpp>
 #include "tglCore/GraphicsItem.h"
 #include "tglUtil/SE3.h"
+#include "tglUtil/SE3Group.h"
+#include "tglUtil/ChangeNotifier.h"
 
 namespace tgl {
 namespace handle {
 
+class Rotate1DHandle;
+class Rotate3DHandle;
+class RotateHandle;
+
+typedef std::shared_ptr<Rotate1DHandle> Rotate1DHandlePtr;
+typedef std::shared_ptr<Rotate3DHandle> Rotate3DHandlePtr;
+typedef std::shared_ptr<RotateHandle> RotateHandlePtr;
+
+// rings around the x, y, z axes and a free trackball inside them.
+// picked analytically, no GL_SELECT pass
 class RotateHandle : public GraphicsItem {
 public:
 	RotateHandle();
 	virtual ~RotateHandle();
+
+	void set(SE3Ptr se3);
+	// moves all members about the pivot of the group, sigChanged of the group is flushed every frame
+	void set(SE3GroupPtr group);
+	void setScale(double scale);
+	void setAutoScale(bool on);
+	void setImmediateNotification(bool on);
+
+	const SE3Ptr se3() const { return se3_; }
+
+	boost::signals2::signal<void ()>& sigStateChanged() { return sigStateChanged_; }
+
+protected:
+
+	virtual void renderScene(tgl::Renderer3D* r);
+
+	Rotate1DHandlePtr xHandle_;
+	Rotate1DHandlePtr yHandle_;
+	Rotate1DHandlePtr zHandle_;
+
+	Rotate3DHandlePtr xyzHandle_;
+
+	SE3Ptr se3_;
+	SE3GroupPtr group_;
+	double scale_;
+	bool autoScale_;
+
+	Eigen::Vector3d pickingPosition_;	// pose when picking was last invalidated
+	Eigen::Matrix3d pickingAttitude_;
+
+	boost::signals2::signal<void ()> sigStateChanged_;
+
+	void slotRotationChanged(Eigen::Matrix3d) {
+		// emit
+		sigStateChanged_();
+	}
+};
+
+// ring around one axis. dragging along the ring rotates around the axis
+class Rotate1DHandle : public GraphicsItem {
+public:
+	Rotate1DHandle();
+	virtual ~Rotate1DHandle();
+
+	void set(SE3Ptr se3);
+	void setScale(double scale) { scale_ = scale; }
+
+	void setAxis(double x, double y, double z);
+
+	const SE3Ptr se3() const { return se3_; }
+
+	void setColor(double r, double g, double b, double a = 1.0) {
+		color_ = {{r, g, b, a}};
+	}
+
+	void setDragingColor(double r, double g, double b, double a = 1.0) {
+		draggingColor_ = {{r, g, b, a}};
+	}
+
+	void setHoverColor(double r, double g, double b, double a = 1.0) {
+		hoverColor_ = {{r, g, b, a}};
+	}
+
+	boost::signals2::signal<void (Eigen::Matrix3d)>& sigRotationChanged() { return sigRotationChanged_; }
+
+	// sigRotationChanged is emitted once per frame on the render thread, or on every change if immediate
+	void setImmediateNotification(bool on) { changeNotifier_.setImmediate(on); }
+
+	// ray-torus
+	virtual bool intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const;
+
+protected:
+
+	// Hover event
+	virtual void hoverEnterEvent(tgl::GraphicsItemHoverEvent* e);
+	virtual void hoverLeaveEvent(tgl::GraphicsItemHoverEvent* e);
+
+	virtual void renderOverlayScene(tgl::Renderer3D* r);
+
+	virtual void mousePressEvent(tgl::GraphicsItemMouseEvent* e);
+	virtual void mouseMoveEvent(tgl::GraphicsItemMouseEvent* e);
+	virtual void mouseReleaseEvent(tgl::GraphicsItemMouseEvent* e);
+
+	// direction from the center to the cursor on the ring plane
+	bool planeDirection(int x, int y, Eigen::Vector3d& v) const;
+
+	SE3Ptr se3_;
+	double scale_;
+
+	std::array<double, 4> color_;
+	std::array<double, 4> hoverColor_;
+	std::array<double, 4> draggingColor_;
+
+	Eigen::Vector3d axis_;
+	Eigen::Matrix3d R_;		// ring frame, z = axis
+
+	bool hoverd_;
+	bool dragged_;
+
+	Eigen::Vector3d preV_;
+
+	boost::signals2::signal<void (Eigen::Matrix3d)> sigRotationChanged_;
+	ChangeNotifier changeNotifier_;
+};
+
+// trackball inside the rings. free rotation
+class Rotate3DHandle : public GraphicsItem {
+public:
+	Rotate3DHandle();
+	virtual ~Rotate3DHandle();
+
+	void set(SE3Ptr se3);
+	void setScale(double scale) { scale_ = scale; }
+
+	const SE3Ptr se3() const { return se3_; }
+
+	void setColor(double r, double g, double b, double a = 1.0) {
+		color_ = {{r, g, b, a}};
+	}
+
+	void setHoverColor(double r, double g, double b, double a = 1.0) {
+		hoverColor_ = {{r, g, b, a}};
+	}
+
+	boost::signals2::signal<void (Eigen::Matrix3d)>& sigRotationChanged() { return sigRotationChanged_; }
+
+	// sigRotationChanged is emitted once per frame on the render thread, or on every change if immediate
+	void setImmediateNotification(bool on) { changeNotifier_.setImmediate(on); }
+
+	// ray-sphere
+	virtual bool intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const;
+
+protected:
+
+	// Hover event
+	virtual void hoverEnterEvent(tgl::GraphicsItemHoverEvent* e);
+	virtual void hoverLeaveEvent(tgl::GraphicsItemHoverEvent* e);
+
+	virtual void renderOverlayScene(tgl::Renderer3D* r);
+
+	virtual void mousePressEvent(tgl::GraphicsItemMouseEvent* e);
+	virtual void mouseMoveEvent(tgl::GraphicsItemMouseEvent* e);
+	virtual void mouseReleaseEvent(tgl::GraphicsItemMouseEvent* e);
+
+	// cursor on the ball, the nearest point of the silhouette if the ray misses
+	Eigen::Vector3d ballDirection(int x, int y) const;
+
+	double radius() const { return scale_ * radius_; }
+
+	SE3Ptr se3_;
+	double scale_;
+	double radius_;
+
+	std::array<double, 4> color_;
+	std::array<double, 4> hoverColor_;
+
+	bool hoverd_;
+	bool dragged_;
+
+	Eigen::Vector3d preV_;
+
+	boost::signals2::signal<void (Eigen::Matrix3d)> sigRotationChanged_;
+	ChangeNotifier changeNotifier_;
 };
 
 } /* namespace handle */
@@ -20,6 +20,9 @@ TranslateHandle::TranslateHandle() {
 	scale_ = 1.0;
 	autoScale_ = true;
 
+	pickingPosition_.setZero();
+	pickingAttitude_.setIdentity();
+
 	xHandle_ = Tranbslate1DHandlePtr(new Translate1DHandle);
 	yHandle_ = Tranbslate1DHandlePtr(new Translate1DHandle);
 	zHandle_ = Tranbslate1DHandlePtr(new Translate1DHandle);
@@ -100,7 +103,13 @@ TranslateHandle::~TranslateHandle()
 
 }
 
+void TranslateHandle::set(SE3GroupPtr group) {
+	set(group ? group->pivot() : std::make_shared<SE3>());
+	group_ = group;
+}
+
 void TranslateHandle::set(SE3Ptr se3) {
+	group_ = nullptr;
 	se3_ = se3;
 	xHandle_->set(se3);
 	yHandle_->set(se3);
@@ -111,6 +120,8 @@ void TranslateHandle::set(SE3Ptr se3) {
 	zxHandle_->set(se3);
 
 	xyzHandle_->set(se3);
+
+	update();
 }
 
 void TranslateHandle::setScale(double scale) {
@@ -124,14 +135,37 @@ void TranslateHandle::setScale(double scale) {
 	zxHandle_->setScale(scale);
 
 	xyzHandle_->setScale(scale);
+
+	update();
+}
+
+void TranslateHandle::setImmediateNotification(bool on) {
+	xHandle_->setImmediateNotification(on);
+	yHandle_->setImmediateNotification(on);
+	zHandle_->setImmediateNotification(on);
+	xyHandle_->setImmediateNotification(on);
+	yzHandle_->setImmediateNotification(on);
+	zxHandle_->setImmediateNotification(on);
+	xyzHandle_->setImmediateNotification(on);
 }
 
 void TranslateHandle::setAutoScale(bool on) {
 	autoScale_ = on;
+	update();
 }
 
 void TranslateHandle::renderScene(tgl::Renderer3D* /*r*/)
 {
+	// one change signal per frame for the whole group
+	if (group_) group_->flush();
+
+	// the shared se3 may be moved by others
+	if (se3_->position() != pickingPosition_ || se3_->attitude() != pickingAttitude_) {
+		pickingPosition_ = se3_->position();
+		pickingAttitude_ = se3_->attitude();
+		graphicsWindow()->invalidatePicking();
+	}
+
 	// set auto scale
 	if (autoScale_) {
 		Eigen::Vector3d dist(se3_->position() - this->graphicsWindow()->camera()->position());
@@ -166,6 +200,17 @@ Translate1DHandle::Translate1DHandle()
 
 	hoverd_ = false;
 	dragged_ = false;
+
+	setAcceptHoverEvents(true);
+	setAcceptMouseEvents(true);
+	setRayPicking(RayPicking::Overlay);
+	setSelectPicking2D(false);		// nothing is drawn in 2D
+
+	// emitted once per frame
+	changeNotifier_.setCallback([this](){
+		if (se3_) sigPositionChanged_(se3_->position());
+	});
+	addChangeNotifier(&changeNotifier_);
 }
 
 Translate1DHandle::~Translate1DHandle()
@@ -203,21 +248,24 @@ void Translate1DHandle::hoverMoveEvent(tgl::GraphicsItemHoverEvent* /*e*/)
 	drawColor_ = hoverColor_.data();
 }
 
-void Translate1DHandle::renderPickingOverlayScene(tgl::Renderer3D* r)
+bool Translate1DHandle::intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const
 {
-	if (!se3_) return;
+	if (!se3_) return false;
 
+	// same shape as renderOverlayScene
 	double b = 0.2;
 	double l = scale_ * b;
 	double ra = l * 0.3;
-	Eigen::Vector3d p;
-	p = se3_->position() + (scale_ * (1.0 - b) * axis_);
-	cp_ = p;
+	Eigen::Vector3d p = se3_->position() + (scale_ * (1.0 - b) * axis_);
 
-	r->setColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
-	Eigen::Matrix3d tR = R_.transpose();
-	r->drawCone(p.data(), tR.data(), l, ra);
+	bool hit = calcIntersectionRayAndCone(distance, origin, dir, p, Eigen::Vector3d(p + l * axis_), ra);
 
+	double t;
+	if (calcIntersectionRayAndCapsule(t, origin, dir, se3_->position(), p, 0.3 * ra) && (!hit || t < distance)) {
+		distance = t;
+		hit = true;
+	}
+	return hit;
 }
 
 void Translate1DHandle::renderOverlayScene(tgl::Renderer3D* r)
@@ -260,8 +308,9 @@ void Translate1DHandle::mousePressEvent(tgl::GraphicsItemMouseEvent* e)
 
 	const Eigen::Vector3d& line1_p1 = se3_->position();
 	const Eigen::Vector3d& line1_p2 = cp_;
-	Eigen::Vector3d line2_p1 = graphicsWindow()->camera()->position();
-	Eigen::Vector3d line2_p2 = graphicsWindow()->camera()->unProject2D(x, y);
+	Eigen::Vector3d line2_p1, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, line2_p1, dir);
+	Eigen::Vector3d line2_p2 = line2_p1 + dir;
 	Eigen::Vector3d np1, np2;
 	if (calcIntersectionLineAndLine(np1, np2, line1_p1, line1_p2, line2_p1, line2_p2)) {
 		dcp_ = cp_ - np1;
@@ -276,8 +325,9 @@ void Translate1DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
 
 	const Eigen::Vector3d& line1_p1 = se3_->position();
 	const Eigen::Vector3d& line1_p2 = cp_;
-	Eigen::Vector3d line2_p1 = graphicsWindow()->camera()->position();
-	Eigen::Vector3d line2_p2 = graphicsWindow()->camera()->unProject2D(x, y);
+	Eigen::Vector3d line2_p1, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, line2_p1, dir);
+	Eigen::Vector3d line2_p2 = line2_p1 + dir;
 	Eigen::Vector3d np1, np2;
 	if (calcIntersectionLineAndLine(np1, np2, line1_p1, line1_p2, line2_p1, line2_p2)) {
 		Eigen::Vector3d dp;
@@ -287,7 +337,7 @@ void Translate1DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
 		se3_->setPosition(Eigen::Vector3d(se3_->position() + dp + dcp_));
 
 		// emit
-		sigPositionChanged_(se3_->position());
+		changeNotifier_.notify();
 	}
 
 }
@@ -312,6 +362,17 @@ Translate2DHandle::Translate2DHandle()
 	dragged_ = false;
 
 	length_ = 0.2;
+
+	setAcceptHoverEvents(true);
+	setAcceptMouseEvents(true);
+	setRayPicking(RayPicking::Overlay);
+	setSelectPicking2D(false);		// nothing is drawn in 2D
+
+	// emitted once per frame
+	changeNotifier_.setCallback([this](){
+		if (se3_) sigPositionChanged_(se3_->position());
+	});
+	addChangeNotifier(&changeNotifier_);
 }
 
 Translate2DHandle::~Translate2DHandle()
@@ -356,6 +417,14 @@ void Translate2DHandle::hoverMoveEvent(tgl::GraphicsItemHoverEvent* /*e*/)
 	drawColor_ = hoverColor_.data();
 }
 
+bool Translate2DHandle::intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const
+{
+	if (!se3_) return false;
+
+	double length = scale_ * length_;
+	return calcIntersectionRayAndQuad(distance, origin, dir, se3_->position(), Eigen::Vector3d(length*axis1_), Eigen::Vector3d(length*axis2_));
+}
+
 void Translate2DHandle::renderOverlayScene(tgl::Renderer3D* r)
 {
 	if (!se3_) return;
@@ -406,8 +475,9 @@ void Translate2DHandle::mousePressEvent(tgl::GraphicsItemMouseEvent* e)
 	p3 = se3_->position() + length*(axis1_ + axis2_);
 //		p3 = p1 + p2;
 
-	Eigen::Vector3d cp(graphicsWindow()->camera()->position());
-	Eigen::Vector3d wp(graphicsWindow()->camera()->unProject2D(x, y));
+	Eigen::Vector3d cp, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, cp, dir);
+	Eigen::Vector3d wp(cp + dir);
 
 	preHp_ = calcIntersectionLineAndPlane(cp, wp, p1, p2, p3);
 	preHp_ -= p0;
@@ -427,8 +497,9 @@ void Translate2DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
 	p2 = se3_->position() + length*axis2_;
 	p3 = se3_->position() + length*(axis1_ + axis2_);
 
-	Eigen::Vector3d cp(graphicsWindow()->camera()->position());
-	Eigen::Vector3d wp(graphicsWindow()->camera()->unProject2D(x, y));
+	Eigen::Vector3d cp, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, cp, dir);
+	Eigen::Vector3d wp(cp + dir);
 
 	Eigen::Vector3d hp;
 	hp = calcIntersectionLineAndPlane(cp, wp, p1, p2, p3);
@@ -439,7 +510,7 @@ void Translate2DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
 	se3_->setPosition(dhp);
 
 	// emit
-	sigPositionChanged_(se3_->position());
+	changeNotifier_.notify();
 }
 
 void Translate2DHandle::mouseReleaseEvent(tgl::GraphicsItemMouseEvent* /*e*/)
@@ -463,6 +534,17 @@ Translate3DHandle::Translate3DHandle()
 	axis2_ << 0,-1,0;
 
 	cR_.setIdentity();
+
+	setAcceptHoverEvents(true);
+	setAcceptMouseEvents(true);
+	setRayPicking(RayPicking::Overlay);
+	setSelectPicking2D(false);		// nothing is drawn in 2D
+
+	// emitted once per frame
+	changeNotifier_.setCallback([this](){
+		if (se3_) sigPositionChanged_(se3_->position());
+	});
+	addChangeNotifier(&changeNotifier_);
 }
 
 Translate3DHandle::~Translate3DHandle()
@@ -492,6 +574,14 @@ void Translate3DHandle::hoverMoveEvent(tgl::GraphicsItemHoverEvent* /*e*/)
 	drawColor_ = hoverColor_.data();
 }
 
+bool Translate3DHandle::intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const
+{
+	if (!se3_) return false;
+
+	double length = scale_ * length_;
+	return calcIntersectionRayAndBox(distance, origin, dir, se3_->position(), Eigen::Matrix3d::Identity(), Eigen::Vector3d(length, length, length));
+}
+
 void Translate3DHandle::renderOverlayScene(tgl::Renderer3D* r)
 {
 	if (!se3_) return;
@@ -518,29 +608,23 @@ void Translate3DHandle::mousePressEvent(tgl::GraphicsItemMouseEvent* e)
 	dragged_ = true;
 	if (!se3_) return;
 
-#if 0	// bug
 	const int x = e->x();
 	const int y = e->y();
 
-	Eigen::Matrix3d cR(graphicsWindow()->camera()->inverseRotation());
-
-	Eigen::Vector3d axis1, axis2;
-	axis1 = cR * axis1_;
-	axis2 = cR * axis2_;
-
-	double length = scale_ * length_;
+	// drag on the plane facing the camera at the press
+	cR_ = graphicsWindow()->camera()->rotation();
 
 	Eigen::Vector3d p1, p2, p3;
-	p1 = se3_->position() + length*axis1;
-	p2 = se3_->position() + length*axis2;
-	p3 = se3_->position() + length*(axis1 + axis2);
+	p1 = se3_->position();
+	p2 = se3_->position() + cR_.col(0);
+	p3 = se3_->position() + cR_.col(1);
 
-	Eigen::Vector3d cp(graphicsWindow()->camera()->position());
-	Eigen::Vector3d wp(graphicsWindow()->camera()->unProject2D(x, y));
+	Eigen::Vector3d cp, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, cp, dir);
+	Eigen::Vector3d wp(cp + dir);
 
 	preHp_ = calcIntersectionLineAndPlane(cp, wp, p1, p2, p3);
 	dhp_ = preHp_ - se3_->position();
-#endif
 }
 
 void Translate3DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
@@ -548,27 +632,17 @@ void Translate3DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
 	dragged_ = true;
 	if (!se3_) return;
 
-#if 0	// bug
-
 	const int x = e->x();
 	const int y = e->y();
 
-	Eigen::Matrix3d cR(graphicsWindow()->camera()->inverseRotation());
-//	Eigen::Matrix3d cR(graphicsWindow()->camera()->rotation());
-
-	Eigen::Vector3d axis1, axis2;
-	axis1 = cR * axis1_;
-	axis2 = cR * axis2_;
-
-	double length = scale_ * length_;
-
 	Eigen::Vector3d p1, p2, p3;
-	p1 = se3_->position() + length*axis1;
-	p2 = se3_->position() + length*axis2;
-	p3 = se3_->position() + length*(axis1 + axis2);
+	p1 = se3_->position();
+	p2 = se3_->position() + cR_.col(0);
+	p3 = se3_->position() + cR_.col(1);
 
-	Eigen::Vector3d cp(graphicsWindow()->camera()->position());
-	Eigen::Vector3d wp(graphicsWindow()->camera()->unProject2D(x, y));
+	Eigen::Vector3d cp, dir;
+	graphicsWindow()->camera()->unProjectRay(x, y, cp, dir);
+	Eigen::Vector3d wp(cp + dir);
 
 	Eigen::Vector3d hp;
 	hp = calcIntersectionLineAndPlane(cp, wp, p1, p2, p3);
@@ -576,8 +650,7 @@ void Translate3DHandle::mouseMoveEvent(tgl::GraphicsItemMouseEvent* e)
 	se3_->setPosition(Eigen::Vector3d(hp - dhp_));
 
 	// emit
-	sigPositionChanged_(se3_->position());
-#endif
+	changeNotifier_.notify();
 }
 
 void Translate3DHandle::mouseReleaseEvent(tgl::GraphicsItemMouseEvent* /*e*/)
@@ -10,6 +10,8 @@
 #include <boost/signals2.hpp>
 #include "tglCore/GraphicsItem.h"
 #include "tglUtil/SE3.h"
+#include "tglUtil/SE3Group.h"
+#include "tglUtil/ChangeNotifier.h"
 
 namespace tgl {
 
@@ -31,8 +33,11 @@ public:
 	virtual ~TranslateHandle();
 
 	void set(SE3Ptr se3);
+	// moves all members about the pivot of the group, sigChanged of the group is flushed every frame
+	void set(SE3GroupPtr group);
 	void setScale(double scale);
 	void setAutoScale(bool on);
+	void setImmediateNotification(bool on);
 
 	const SE3Ptr se3() const { return se3_; }
 
@@ -56,9 +61,13 @@ protected:
 	Tranbslate3DHandlePtr xyzHandle_;
 
 	SE3Ptr se3_;
+	SE3GroupPtr group_;
 	double scale_;
 	bool autoScale_;
 
+	Eigen::Vector3d pickingPosition_;	// pose when picking was last invalidated
+	Eigen::Matrix3d pickingAttitude_;
+
 	boost::signals2::signal<void ()> sigStateChanged_;
 
 	void slotPositionChanged(Eigen::Vector3d) {
@@ -102,6 +111,12 @@ public:
 
 	boost::signals2::signal<void (Eigen::Vector3d)>& sigPositionChanged() { return sigPositionChanged_; }
 
+	// sigPositionChanged is emitted once per frame on the render thread, or on every change if immediate
+	void setImmediateNotification(bool on) { changeNotifier_.setImmediate(on); }
+
+	// shaft capsule and cone
+	virtual bool intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const;
+
 protected:
 
 	// Hover event
@@ -109,7 +124,6 @@ protected:
 	virtual void hoverLeaveEvent(tgl::GraphicsItemHoverEvent* e);
 	virtual void hoverMoveEvent(tgl::GraphicsItemHoverEvent* e);
 
-	virtual void renderPickingOverlayScene(tgl::Renderer3D* r);
 	virtual void renderOverlayScene(tgl::Renderer3D* r);
 
 	virtual void mousePressEvent(tgl::GraphicsItemMouseEvent* e);
@@ -138,6 +152,7 @@ protected:
 	Eigen::Vector3d dcp_;
 
 	boost::signals2::signal<void (Eigen::Vector3d)> sigPositionChanged_;
+	ChangeNotifier changeNotifier_;
 };
 
 class Translate2DHandle : public GraphicsItem
@@ -177,6 +192,12 @@ public:
 
 	boost::signals2::signal<void (Eigen::Vector3d)>& sigPositionChanged() { return sigPositionChanged_; }
 
+	// sigPositionChanged is emitted once per frame on the render thread, or on every change if immediate
+	void setImmediateNotification(bool on) { changeNotifier_.setImmediate(on); }
+
+	// plane quad
+	virtual bool intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const;
+
 protected:
 
 	// Hover event
@@ -213,6 +234,7 @@ protected:
 	Eigen::Vector3d preHp_;
 
 	boost::signals2::signal<void (Eigen::Vector3d)> sigPositionChanged_;
+	ChangeNotifier changeNotifier_;
 
 };
 
@@ -245,6 +267,12 @@ public:
 
 	boost::signals2::signal<void (Eigen::Vector3d)>& sigPositionChanged() { return sigPositionChanged_; }
 
+	// sigPositionChanged is emitted once per frame on the render thread, or on every change if immediate
+	void setImmediateNotification(bool on) { changeNotifier_.setImmediate(on); }
+
+	// center box
+	virtual bool intersectRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, double& distance) const;
+
 protected:
 
 	// Hover event
@@ -281,6 +309,7 @@ protected:
 	Eigen::Vector3d dhp_;
 
 	boost::signals2::signal<void (Eigen::Vector3d)> sigPositionChanged_;
+	ChangeNotifier changeNotifier_;
 
 };
 
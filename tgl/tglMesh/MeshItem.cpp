@@ -0,0 +1,95 @@
+/*
+ * MeshItem.cpp
+ */
+
+#include <algorithm>
+#include "tglCore/Renderer3D.h"
+#include "MeshItem.h"
+
+namespace tgl {
+namespace mesh {
+
+MeshItem::MeshItem()
+{
+	scale_ = 1.0;
+	color_ = {{0.7, 0.7, 0.7, 1.0}};
+	lodLevel_ = 0;
+}
+
+MeshItem::MeshItem(MeshResourcePtr resource)
+	: MeshItem()
+{
+	resource_ = resource;
+}
+
+MeshItem::~MeshItem()
+{
+
+}
+
+TriangleMeshPtr MeshItem::selectMesh(tgl::Renderer3D* r, bool picking)
+{
+	MeshLodPtr lod = resource_->lod();
+	if (!lod) return resource_->mesh();
+
+	if (!picking) {
+		// bounding sphere on the screen
+		const Eigen::Vector3d center = scale_ * lod->center();
+		r->pushMatrix();
+		r->translate(center.data());
+		const double pixels = r->projectedRadius(scale_ * lod->radius());
+		r->popMatrix();
+		lodLevel_ = lod->selectLevel(pixels, lodLevel_);
+	}
+	return lod->level(std::min(lodLevel_, lod->numLevels() - 1));
+}
+
+void MeshItem::renderScene(tgl::Renderer3D* r)
+{
+	if (!resource_) return;
+
+	static const double pos[3] = {0, 0, 0};
+	static const double R[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+	resource_->touch();	// loads it again if evicted
+	TriangleMeshPtr mesh = selectMesh(r, false);
+	if (mesh) {
+		r->setColor(color_[0], color_[1], color_[2], color_[3]);
+		r->drawMesh(mesh, pos, R, scale_);
+	} else if (resource_->isPending()) {
+		renderPlaceholder(r);
+	}
+}
+
+void MeshItem::renderPickingScene(tgl::Renderer3D* r)
+{
+	if (!resource_) return;
+
+	static const double pos[3] = {0, 0, 0};
+	static const double R[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+	TriangleMeshPtr mesh = selectMesh(r, true);
+	if (mesh) {
+		r->drawMesh(mesh, pos, R, scale_);
+	} else if (resource_->isPending()) {
+		renderPlaceholder(r);
+	}
+}
+
+void MeshItem::renderPlaceholder(tgl::Renderer3D* r)
+{
+	if (!resource_->hasPlaceholderBox()) return;
+
+	const Eigen::Vector3d center = 0.5 * scale_ * (resource_->placeholderBoxMin() + resource_->placeholderBoxMax());
+	const Eigen::Vector3d sides = scale_ * (resource_->placeholderBoxMax() - resource_->placeholderBoxMin());
+	static const double R[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+	const Renderer3D::DrawMode mode = r->drawMode();
+	r->setDrawMode(Renderer3D::Wire);
+	r->setColor(color_[0], color_[1], color_[2], color_[3]);
+	r->drawBox(center.data(), R, sides.data());
+	r->setDrawMode(mode);
+}
+
+} /* namespace mesh */
+} /* namespace tgl */
@@ -0,0 +1,55 @@
+/*
+ * MeshItem.h
+ */
+
+#ifndef TGL_MESH_MESHITEM_H_
+#define TGL_MESH_MESHITEM_H_
+
+#include <memory>
+#include <array>
+#include "tglCore/GraphicsItem.h"
+#include "MeshResource.h"
+
+namespace tgl {
+namespace mesh {
+
+class MeshItem;
+typedef std::shared_ptr<MeshItem> MeshItemPtr;
+
+// Item drawing a MeshResource at its local transform.
+// a wire box is drawn in place of the mesh while it is loading: the placeholder box of the
+// resource if set. nothing is drawn for a failed resource.
+// drawing marks the resource used, an evicted resource is loaded again.
+// with levels of detail, the level is picked by the size on the screen of every draw
+class MeshItem : public GraphicsItem {
+public:
+	MeshItem();
+	explicit MeshItem(MeshResourcePtr resource);
+	virtual ~MeshItem();
+
+	void setResource(MeshResourcePtr resource) { resource_ = resource; }
+	const MeshResourcePtr& resource() const { return resource_; }
+
+	void setScale(double scale) { scale_ = scale; }
+	double scale() const { return scale_; }
+
+	// used by meshes without vertex colors and by the placeholder
+	void setColor(double r, double g, double b, double a = 1.0) { color_ = {{r, g, b, a}}; }
+
+protected:
+	virtual void renderScene(tgl::Renderer3D* r);
+	virtual void renderPickingScene(tgl::Renderer3D* r);	// at the level drawn last
+
+	TriangleMeshPtr selectMesh(tgl::Renderer3D* r, bool picking);
+	void renderPlaceholder(tgl::Renderer3D* r);
+
+	MeshResourcePtr resource_;
+	double scale_;
+	std::array<double, 4> color_;
+	size_t lodLevel_;
+};
+
+} /* namespace mesh */
+} /* namespace tgl */
+
+#endif /* TGL_MESH_MESHITEM_H_ */
@@ -0,0 +1,994 @@
+/*
+ * MeshLoader.cpp
+ */
+
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <Eigen/Geometry>
+#include "tglUtil/ThreadPool.h"
+#include "MeshOptimizer.h"
+#include "MeshLoader.h"
+
+namespace tgl {
+namespace mesh {
+
+namespace {
+
+// text formats are parsed in chunks of at least this size
+const size_t chunkBytes = 1 << 20;
+
+// ----- file -----
+// read only memory map of a whole file
+class MappedFile {
+public:
+	explicit MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return;
+
+		struct stat st;
+		if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+			void* ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (ptr != MAP_FAILED) {
+				data_ = static_cast<const char*>(ptr);
+				size_ = st.st_size;
+				::madvise(ptr, size_, MADV_WILLNEED);
+			}
+		}
+		::close(fd);
+	}
+
+	~MappedFile() {
+		if (data_) ::munmap(const_cast<char*>(data_), size_);
+	}
+
+	const char* data() const { return data_; }
+	size_t size() const { return size_; }
+
+private:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* data_;
+	size_t size_;
+};
+
+TriangleMeshPtr fail(std::string* error, const std::string& message)
+{
+	std::cerr << "error : MeshLoader " << message << std::endl;
+	if (error) *error = message;
+	return nullptr;
+}
+
+// ----- text -----
+// the buffers are not null terminated, every read checks end
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline void skipSpace(const char*& p, const char* end)
+{
+	while (p < end && isSpace(*p)) ++p;
+}
+
+inline void nextLine(const char*& p, const char* end)
+{
+	const void* nl = std::memchr(p, '\n', end - p);
+	p = nl ? static_cast<const char*>(nl) + 1 : end;
+}
+
+inline bool startsWith(const char* p, const char* end, const char* word)
+{
+	const size_t n = std::strlen(word);
+	return static_cast<size_t>(end - p) >= n && std::memcmp(p, word, n) == 0 &&
+			(static_cast<size_t>(end - p) == n || isSpace(p[n]) || p[n] == '\n');
+}
+
+bool parseInt(const char*& p, const char* end, long long& value)
+{
+	skipSpace(p, end);
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+	if (p >= end || *p < '0' || *p > '9') return false;
+
+	long long v = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		v = v * 10 + (*p - '0');
+		++p;
+	}
+	value = negative ? -v : v;
+	return true;
+}
+
+// locale independent, without strtod
+bool parseFloat(const char*& p, const char* end, double& value)
+{
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	skipSpace(p, end);
+	const char* start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			++digits;
+		} else {
+			++exponent;
+		}
+		++p;
+	}
+	if (p < end && *p == '.') {
+		++p;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				++digits;
+				--exponent;
+			}
+			++p;
+		}
+	}
+	if (p == start || (p == start + 1 && (*start == '-' || *start == '+' || *start == '.'))) {
+		// inf, nan and other words
+		p = start;
+		return false;
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* e = p + 1;
+		long long ex;
+		if (parseInt(e, end, ex)) {
+			exponent += static_cast<int>(std::max(-400LL, std::min(400LL, ex)));
+			p = e;
+		}
+	}
+
+	double v = static_cast<double>(mantissa);
+	if (exponent < 0) {
+		v = (-exponent <= 22) ? v / powers[-exponent] : v * std::pow(10.0, exponent);
+	} else if (exponent > 0) {
+		v = (exponent <= 22) ? v * powers[exponent] : v * std::pow(10.0, exponent);
+	}
+	value = negative ? -v : v;
+	return true;
+}
+
+inline bool parseFloat(const char*& p, const char* end, float& value)
+{
+	double v;
+	if (!parseFloat(p, end, v)) return false;
+	value = static_cast<float>(v);
+	return true;
+}
+
+// [begin, end) cut into about numChunks ranges at line starts
+std::vector<const char*> splitLines(const char* begin, const char* end, size_t numChunks)
+{
+	std::vector<const char*> bounds(1, begin);
+	const size_t size = end - begin;
+	numChunks = std::max<size_t>(1, std::min(numChunks, size / chunkBytes + 1));
+	for (size_t i = 1; i < numChunks; ++i) {
+		const char* p = std::max(bounds.back(), begin + size * i / numChunks);
+		if (p > begin && p[-1] != '\n') nextLine(p, end);
+		if (p > bounds.back() && p < end) bounds.push_back(p);
+	}
+	bounds.push_back(end);
+	return bounds;
+}
+
+// ----- merge -----
+inline uint64_t mix(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+struct PositionKey {
+	uint32_t bits[3];
+	bool operator==(const PositionKey& k) const {
+		return bits[0] == k.bits[0] && bits[1] == k.bits[1] && bits[2] == k.bits[2];
+	}
+};
+
+struct PositionKeyHash {
+	size_t operator()(const PositionKey& k) const {
+		return mix((static_cast<uint64_t>(k.bits[0]) << 32 | k.bits[1]) ^ mix(k.bits[2]));
+	}
+};
+
+struct PairKeyHash {
+	size_t operator()(uint64_t k) const { return mix(k); }
+};
+
+// first[i] : index of the first key equal to keys[i].
+// keys are split over the threads by hash, each thread fills its own hash map
+template <typename Key, typename Hash>
+std::vector<uint32_t> findFirstEqual(const std::vector<Key>& keys, ThreadPool& pool)
+{
+	const size_t n = keys.size();
+	std::vector<uint8_t> parts(n);
+	const size_t numParts = std::min<size_t>(255, pool.numThreads() + 1);
+	pool.parallelFor(n, 1 << 16, [&](size_t begin, size_t end) {
+		Hash hash;
+		for (size_t i = begin; i < end; ++i) {
+			parts[i] = static_cast<uint8_t>((hash(keys[i]) >> 56) % numParts);	// high bits, the map uses low bits
+		}
+	});
+
+	std::vector<uint32_t> first(n);
+	pool.parallelFor(numParts, 1, [&](size_t begin, size_t end) {
+		for (size_t part = begin; part < end; ++part) {
+			std::unordered_map<Key, uint32_t, Hash> map;
+			map.reserve(n / numParts + 1);
+			for (size_t i = 0; i < n; ++i) {
+				if (parts[i] != part) continue;
+				first[i] = map.emplace(keys[i], static_cast<uint32_t>(i)).first->second;
+			}
+		}
+	});
+	return first;
+}
+
+// merged vertex of each key in order of first appearance. returns the number of vertices
+template <typename Key, typename Hash>
+size_t mergeKeys(const std::vector<Key>& keys, ThreadPool& pool, std::vector<uint32_t>& indices, std::vector<uint32_t>& sources)
+{
+	const std::vector<uint32_t> first = findFirstEqual<Key, Hash>(keys, pool);
+
+	const size_t n = keys.size();
+	std::vector<uint32_t> merged(n);
+	sources.clear();
+	for (size_t i = 0; i < n; ++i) {
+		if (first[i] == i) {
+			merged[i] = static_cast<uint32_t>(sources.size());
+			sources.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	indices.resize(n);
+	pool.parallelFor(n, 1 << 16, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			indices[i] = merged[first[i]];
+		}
+	});
+	return sources.size();
+}
+
+// ----- STL -----
+// x,y,z of 3 vertices per triangle. facet normals per triangle, may be empty
+TriangleMeshPtr meshFromTriangles(std::vector<float>& corners, std::vector<float>& facetNormals, const MeshLoadOptions& options, ThreadPool& pool)
+{
+	TriangleMeshPtr mesh = std::make_shared<TriangleMesh>();
+	const size_t numCorners = corners.size() / 3;
+
+	if (!options.mergeVertices) {
+		std::vector<float> normals;
+		if (options.computeNormals) {
+			normals.resize(corners.size());
+			pool.parallelFor(numCorners / 3, 1 << 14, [&](size_t begin, size_t end) {
+				for (size_t t = begin; t < end; ++t) {
+					Eigen::Map<const Eigen::Vector3f> a(&corners[9*t]), b(&corners[9*t+3]), c(&corners[9*t+6]);
+					Eigen::Vector3f n(Eigen::Vector3f::Zero());
+					if (!facetNormals.empty()) n = Eigen::Map<const Eigen::Vector3f>(&facetNormals[3*t]);
+					if (n.squaredNorm() < 1.0e-12f) n = (b - a).cross(c - a);	// missing in the file
+					const float norm = n.norm();
+					if (norm > 0.0f) n /= norm;
+					for (int k = 0; k < 3; ++k) {
+						std::copy(n.data(), n.data() + 3, &normals[9*t+3*k]);
+					}
+				}
+			});
+		}
+
+		std::vector<uint32_t> indices(numCorners);
+		for (size_t i = 0; i < numCorners; ++i) indices[i] = static_cast<uint32_t>(i);
+
+		mesh->setVertices(std::move(corners), std::move(normals));
+		mesh->setIndices(std::move(indices));
+		return mesh;
+	}
+
+	std::vector<PositionKey> keys(numCorners);
+	pool.parallelFor(numCorners, 1 << 16, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			for (int k = 0; k < 3; ++k) {
+				const float v = corners[3*i+k] == 0.0f ? 0.0f : corners[3*i+k];	// -0 is 0
+				std::memcpy(&keys[i].bits[k], &v, sizeof(float));
+			}
+		}
+	});
+
+	std::vector<uint32_t> indices, sources;
+	const size_t numVertices = mergeKeys<PositionKey, PositionKeyHash>(keys, pool, indices, sources);
+	std::vector<PositionKey>().swap(keys);
+
+	std::vector<float> positions(3 * numVertices);
+	pool.parallelFor(numVertices, 1 << 16, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			std::memcpy(&positions[3*i], &corners[3*sources[i]], 3 * sizeof(float));
+		}
+	});
+
+	mesh->setVertices(std::move(positions));
+	mesh->setIndices(std::move(indices));
+	if (options.computeNormals) mesh->computeNormals();
+	return mesh;
+}
+
+// ----- PLY -----
+enum class PlyType { None, Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+PlyType plyType(const std::string& name)
+{
+	if (name == "char" || name == "int8") return PlyType::Int8;
+	if (name == "uchar" || name == "uint8") return PlyType::UInt8;
+	if (name == "short" || name == "int16") return PlyType::Int16;
+	if (name == "ushort" || name == "uint16") return PlyType::UInt16;
+	if (name == "int" || name == "int32") return PlyType::Int32;
+	if (name == "uint" || name == "uint32") return PlyType::UInt32;
+	if (name == "float" || name == "float32") return PlyType::Float32;
+	if (name == "double" || name == "float64") return PlyType::Float64;
+	return PlyType::None;
+}
+
+size_t plySize(PlyType type)
+{
+	switch (type) {
+		case PlyType::Int8: case PlyType::UInt8: return 1;
+		case PlyType::Int16: case PlyType::UInt16: return 2;
+		case PlyType::Int32: case PlyType::UInt32: case PlyType::Float32: return 4;
+		case PlyType::Float64: return 8;
+		default: return 0;
+	}
+}
+
+template <typename T>
+inline T readRaw(const char* p, bool swap)
+{
+	char bytes[sizeof(T)];
+	std::memcpy(bytes, p, sizeof(T));
+	if (swap) std::reverse(bytes, bytes + sizeof(T));
+	T v;
+	std::memcpy(&v, bytes, sizeof(T));
+	return v;
+}
+
+double readPly(const char* p, PlyType type, bool swap)
+{
+	switch (type) {
+		case PlyType::Int8: return static_cast<int8_t>(*p);
+		case PlyType::UInt8: return static_cast<uint8_t>(*p);
+		case PlyType::Int16: return readRaw<int16_t>(p, swap);
+		case PlyType::UInt16: return readRaw<uint16_t>(p, swap);
+		case PlyType::Int32: return readRaw<int32_t>(p, swap);
+		case PlyType::UInt32: return readRaw<uint32_t>(p, swap);
+		case PlyType::Float32: return readRaw<float>(p, swap);
+		case PlyType::Float64: return readRaw<double>(p, swap);
+		default: return 0.0;
+	}
+}
+
+struct PlyProperty {
+	std::string name;
+	PlyType type;
+	PlyType countType;	// None if not a list
+	size_t offset;		// in a fixed size binary record
+};
+
+struct PlyElement {
+	std::string name;
+	size_t count;
+	std::vector<PlyProperty> properties;
+	size_t stride;		// 0 if the record has a list
+
+	int find(const std::string& name) const {
+		for (size_t i = 0; i < properties.size(); ++i) {
+			if (properties[i].name == name) return static_cast<int>(i);
+		}
+		return -1;
+	}
+};
+
+// property indices of the vertex element
+struct PlyVertexLayout {
+	explicit PlyVertexLayout(const PlyElement& e) {
+		const char* names[] = {"x", "y", "z", "nx", "ny", "nz", "red", "green", "blue", "alpha"};
+		for (int i = 0; i < 10; ++i) index[i] = e.find(names[i]);
+		for (int i = 6; i < 10; ++i) {
+			// colors in 0..255 unless float
+			scale[i - 6] = (index[i] >= 0 && (e.properties[index[i]].type == PlyType::Float32 ||
+					e.properties[index[i]].type == PlyType::Float64)) ? 1.0f : 1.0f / 255.0f;
+		}
+	}
+	bool hasPositions() const { return index[0] >= 0 && index[1] >= 0 && index[2] >= 0; }
+	bool hasNormals() const { return index[3] >= 0 && index[4] >= 0 && index[5] >= 0; }
+	bool hasColors() const { return index[6] >= 0 && index[7] >= 0 && index[8] >= 0; }
+
+	int index[10];
+	float scale[4];
+};
+
+// one vertex from its property values
+inline void storePlyVertex(const PlyVertexLayout& layout, const double* values, size_t i,
+		std::vector<float>& positions, std::vector<float>& normals, std::vector<float>& colors)
+{
+	for (int k = 0; k < 3; ++k) positions[3*i+k] = static_cast<float>(values[layout.index[k]]);
+	if (!normals.empty()) {
+		for (int k = 0; k < 3; ++k) normals[3*i+k] = static_cast<float>(values[layout.index[3+k]]);
+	}
+	if (!colors.empty()) {
+		for (int k = 0; k < 3; ++k) colors[4*i+k] = static_cast<float>(values[layout.index[6+k]]) * layout.scale[k];
+		colors[4*i+3] = layout.index[9] >= 0 ? static_cast<float>(values[layout.index[9]]) * layout.scale[3] : 1.0f;
+	}
+}
+
+inline void appendFan(const long long* v, size_t n, size_t numVertices, std::vector<uint32_t>& indices, bool& valid)
+{
+	for (size_t k = 0; k < n; ++k) {
+		if (v[k] < 0 || static_cast<size_t>(v[k]) >= numVertices) {
+			valid = false;
+			return;
+		}
+	}
+	for (size_t k = 2; k < n; ++k) {
+		indices.push_back(static_cast<uint32_t>(v[0]));
+		indices.push_back(static_cast<uint32_t>(v[k-1]));
+		indices.push_back(static_cast<uint32_t>(v[k]));
+	}
+}
+
+// ----- OBJ -----
+// encoded corner index : 0 based absolute, or relative to the first vertex of the chunk (negative)
+const long long relativeBase = 1LL << 40;
+const long long noIndex = -(1LL << 62);
+
+struct ObjChunk {
+	ObjChunk() : hasColors(false), valid(true) {}
+	std::vector<float> positions;
+	std::vector<float> colors;		// r,g,b per position, 1 if none
+	std::vector<float> normals;
+	std::vector<long long> corners;	// position, normal per corner, 3 corners per triangle
+	bool hasColors;
+	bool valid;
+};
+
+inline long long encodeObjIndex(long long index, size_t countSoFar)
+{
+	if (index > 0) return index - 1;
+	if (index < 0) return static_cast<long long>(countSoFar) + index - relativeBase;
+	return noIndex;	// 0 is not valid in OBJ
+}
+
+inline long long decodeObjIndex(long long code, size_t chunkOffset)
+{
+	if (code == noIndex || code >= 0) return code;
+	return code + relativeBase + static_cast<long long>(chunkOffset);
+}
+
+void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+{
+	std::vector<long long> face;
+	while (p < end) {
+		const char* line = p;
+		skipSpace(line, end);
+		nextLine(p, end);
+		const char* lineEnd = p;
+
+		if (line + 2 > lineEnd) continue;
+		if (line[0] == 'v' && isSpace(line[1])) {
+			const char* q = line + 2;
+			float v[6];
+			int n = 0;
+			while (n < 6 && parseFloat(q, lineEnd, v[n])) ++n;
+			if (n < 3) { chunk.valid = false; continue; }
+			chunk.positions.insert(chunk.positions.end(), v, v + 3);
+			if (n == 6) {
+				chunk.colors.insert(chunk.colors.end(), v + 3, v + 6);
+				chunk.hasColors = true;
+			} else {
+				chunk.colors.insert(chunk.colors.end(), 3, 1.0f);
+			}
+		} else if (line[0] == 'v' && line[1] == 'n' && line + 2 < lineEnd && isSpace(line[2])) {
+			const char* q = line + 3;
+			float v[3];
+			if (!parseFloat(q, lineEnd, v[0]) || !parseFloat(q, lineEnd, v[1]) || !parseFloat(q, lineEnd, v[2])) {
+				chunk.valid = false;
+				continue;
+			}
+			chunk.normals.insert(chunk.normals.end(), v, v + 3);
+		} else if (line[0] == 'f' && isSpace(line[1])) {
+			const char* q = line + 2;
+			face.clear();
+			long long index;
+			while (parseInt(q, lineEnd, index)) {
+				long long normal = 0;
+				if (q < lineEnd && *q == '/') {
+					++q;
+					long long texcoord;
+					if (q < lineEnd && *q != '/') parseInt(q, lineEnd, texcoord);
+					if (q < lineEnd && *q == '/') {
+						++q;
+						parseInt(q, lineEnd, normal);
+					}
+				}
+				face.push_back(encodeObjIndex(index, chunk.positions.size() / 3));
+				face.push_back(encodeObjIndex(normal, chunk.normals.size() / 3));
+			}
+			const size_t n = face.size() / 2;
+			for (size_t k = 2; k < n; ++k) {
+				chunk.corners.insert(chunk.corners.end(), &face[0], &face[2]);
+				chunk.corners.insert(chunk.corners.end(), &face[2*(k-1)], &face[2*k]);
+				chunk.corners.insert(chunk.corners.end(), &face[2*k], &face[2*k+2]);
+			}
+		}
+	}
+}
+
+}
+
+MeshFormat MeshLoader::formatOf(const std::string& path)
+{
+	const size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos) return MeshFormat::Unknown;
+
+	std::string ext = path.substr(dot + 1);
+	std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+	if (ext == "stl") return MeshFormat::STL;
+	if (ext == "ply") return MeshFormat::PLY;
+	if (ext == "obj") return MeshFormat::OBJ;
+	return MeshFormat::Unknown;
+}
+
+TriangleMeshPtr MeshLoader::load(const std::string& path, const MeshLoadOptions& options, std::string* error)
+{
+	const MeshFormat format = formatOf(path);
+	if (format == MeshFormat::Unknown) return fail(error, "unknown format : " + path);
+
+	MappedFile file(path);
+	if (!file.data()) return fail(error, "can not open : " + path);
+
+	TriangleMeshPtr mesh;
+	switch (format) {
+		case MeshFormat::STL: mesh = loadSTL(file.data(), file.size(), options, error); break;
+		case MeshFormat::PLY: mesh = loadPLY(file.data(), file.size(), options, error); break;
+		case MeshFormat::OBJ: mesh = loadOBJ(file.data(), file.size(), options, error); break;
+		default: break;
+	}
+
+	if (mesh && options.optimize) MeshOptimizer::optimize(*mesh);
+	if (mesh && options.compactVertices) mesh->setVertexFormat(TriangleMesh::VertexFormat::Compact);
+	return mesh;
+}
+
+TriangleMeshPtr MeshLoader::loadSTL(const char* data, size_t size, const MeshLoadOptions& options, std::string* error)
+{
+	ThreadPool& pool = ThreadPool::instance();
+
+	uint32_t numTriangles = 0;
+	if (size >= 84) std::memcpy(&numTriangles, data + 80, 4);
+	const bool sizeMatches = size >= 84 && (size - 84) / 50 == numTriangles;
+	const bool ascii = !sizeMatches && startsWith(data, data + size, "solid");
+
+	std::vector<float> corners;
+	std::vector<float> facetNormals;
+
+	if (!ascii) {
+		if (size < 84 || size - 84 < static_cast<size_t>(numTriangles) * 50) return fail(error, "STL is truncated");
+
+		// 12 floats and 2 bytes per triangle, little endian
+		corners.resize(static_cast<size_t>(numTriangles) * 9);
+		facetNormals.resize(static_cast<size_t>(numTriangles) * 3);
+		const char* records = data + 84;
+		pool.parallelFor(numTriangles, 1 << 14, [&](size_t begin, size_t end) {
+			for (size_t t = begin; t < end; ++t) {
+				const char* r = records + 50 * t;
+				std::memcpy(&facetNormals[3*t], r, 12);
+				std::memcpy(&corners[9*t], r + 12, 36);
+			}
+		});
+	} else {
+		// "vertex x y z" lines, in chunks
+		const std::vector<const char*> bounds = splitLines(data, data + size, pool.numThreads() + 1);
+		std::vector<std::vector<float>> chunks(bounds.size() - 1);
+		pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t c = begin; c < end; ++c) {
+				const char* p = bounds[c];
+				while (p < bounds[c+1]) {
+					const char* line = p;
+					skipSpace(line, bounds[c+1]);
+					nextLine(p, bounds[c+1]);
+					if (!startsWith(line, p, "vertex")) continue;
+					line += 6;
+					float v[3];
+					if (parseFloat(line, p, v[0]) && parseFloat(line, p, v[1]) && parseFloat(line, p, v[2])) {
+						chunks[c].insert(chunks[c].end(), v, v + 3);
+					}
+				}
+			}
+		});
+
+		size_t total = 0;
+		for (const auto& chunk : chunks) total += chunk.size();
+		if (total % 9 != 0) return fail(error, "ASCII STL has a facet without 3 vertices");
+		corners.reserve(total);
+		for (auto& chunk : chunks) {
+			corners.insert(corners.end(), chunk.begin(), chunk.end());
+			std::vector<float>().swap(chunk);
+		}
+	}
+
+	if (corners.empty()) return fail(error, "STL has no triangle");
+	return meshFromTriangles(corners, facetNormals, options, pool);
+}
+
+TriangleMeshPtr MeshLoader::loadPLY(const char* data, size_t size, const MeshLoadOptions& options, std::string* error)
+{
+	ThreadPool& pool = ThreadPool::instance();
+	const char* const end = data + size;
+
+	// header
+	const char* p = data;
+	if (!startsWith(p, end, "ply")) return fail(error, "not a PLY file");
+
+	enum class Encoding { Ascii, LittleEndian, BigEndian } encoding = Encoding::Ascii;
+	std::vector<PlyElement> elements;
+	bool headerEnded = false;
+	while (p < end && !headerEnded) {
+		const char* line = p;
+		nextLine(p, end);
+		const std::string text(line, p - line);
+
+		std::vector<std::string> words;
+		size_t i = 0;
+		while (i < text.size()) {
+			while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+			size_t j = i;
+			while (j < text.size() && !std::isspace(static_cast<unsigned char>(text[j]))) ++j;
+			if (j > i) words.push_back(text.substr(i, j - i));
+			i = j;
+		}
+		if (words.empty()) continue;
+
+		if (words[0] == "format" && words.size() >= 2) {
+			if (words[1] == "ascii") encoding = Encoding::Ascii;
+			else if (words[1] == "binary_little_endian") encoding = Encoding::LittleEndian;
+			else if (words[1] == "binary_big_endian") encoding = Encoding::BigEndian;
+			else return fail(error, "unknown PLY format " + words[1]);
+		} else if (words[0] == "element" && words.size() >= 3) {
+			PlyElement element;
+			element.name = words[1];
+			element.count = std::strtoull(words[2].c_str(), nullptr, 10);
+			element.stride = 0;
+			elements.push_back(element);
+		} else if (words[0] == "property" && !elements.empty()) {
+			PlyProperty property;
+			property.offset = 0;
+			if (words.size() >= 5 && words[1] == "list") {
+				property.countType = plyType(words[2]);
+				property.type = plyType(words[3]);
+				property.name = words[4];
+				if (property.countType == PlyType::None) return fail(error, "unknown PLY type " + words[2]);
+			} else if (words.size() >= 3) {
+				property.countType = PlyType::None;
+				property.type = plyType(words[1]);
+				property.name = words[2];
+			} else {
+				return fail(error, "broken PLY property");
+			}
+			if (property.type == PlyType::None) return fail(error, "unknown PLY type in " + text);
+			elements.back().properties.push_back(property);
+		} else if (words[0] == "end_header") {
+			headerEnded = true;
+		}
+	}
+	if (!headerEnded) return fail(error, "PLY header has no end_header");
+
+	for (auto& element : elements) {
+		size_t offset = 0;
+		for (auto& property : element.properties) {
+			if (property.countType != PlyType::None) {
+				offset = 0;
+				break;
+			}
+			property.offset = offset;
+			offset += plySize(property.type);
+		}
+		element.stride = offset;
+	}
+
+	const bool swap = encoding == Encoding::BigEndian;	// hosts are little endian
+
+	std::vector<float> positions, normals, colors;
+	std::vector<uint32_t> indices;
+	size_t numVertices = 0;
+	bool hasVertices = false;
+
+	for (const PlyElement& element : elements) {
+		const bool isVertex = element.name == "vertex";
+		const bool isFace = element.name == "face";
+		const int faceIndex = isFace ? std::max(element.find("vertex_indices"), element.find("vertex_index")) : -1;
+
+		if (isVertex) {
+			PlyVertexLayout layout(element);
+			if (!layout.hasPositions()) return fail(error, "PLY vertex has no x, y, z");
+			numVertices = element.count;
+			hasVertices = true;
+			positions.resize(3 * numVertices);
+			if (layout.hasNormals()) normals.resize(3 * numVertices);
+			if (layout.hasColors()) colors.resize(4 * numVertices);
+
+			const size_t numProperties = element.properties.size();
+			if (encoding != Encoding::Ascii) {
+				if (element.stride == 0) return fail(error, "PLY vertex with a list is not supported");
+				if (static_cast<size_t>(end - p) / element.stride < element.count) return fail(error, "PLY is truncated");
+				const char* records = p;
+				pool.parallelFor(numVertices, 1 << 14, [&](size_t begin, size_t last) {
+					std::vector<double> values(numProperties);
+					for (size_t v = begin; v < last; ++v) {
+						const char* r = records + v * element.stride;
+						for (size_t k = 0; k < numProperties; ++k) {
+							values[k] = readPly(r + element.properties[k].offset, element.properties[k].type, swap);
+						}
+						storePlyVertex(layout, values.data(), v, positions, normals, colors);
+					}
+				});
+				p += element.count * element.stride;
+			} else {
+				// one vertex per line. find the lines of the element, then parse them in chunks
+				const char* begin = p;
+				for (size_t v = 0; v < element.count && p < end; ++v) nextLine(p, end);
+				const std::vector<const char*> bounds = splitLines(begin, p, pool.numThreads() + 1);
+
+				std::vector<size_t> firstVertex(bounds.size(), 0);
+				for (size_t c = 0; c + 1 < bounds.size(); ++c) {
+					firstVertex[c+1] = firstVertex[c] + std::count(bounds[c], bounds[c+1], '\n');
+				}
+				std::atomic<bool> valid(firstVertex.back() + (p > begin && p[-1] != '\n' ? 1 : 0) == numVertices);
+				pool.parallelFor(bounds.size() - 1, 1, [&](size_t first, size_t last) {
+					std::vector<double> values(numProperties);
+					for (size_t c = first; c < last; ++c) {
+						const char* q = bounds[c];
+						for (size_t v = firstVertex[c]; q < bounds[c+1]; ++v) {
+							const char* line = q;
+							nextLine(q, bounds[c+1]);
+							for (size_t k = 0; k < numProperties; ++k) {
+								if (!parseFloat(line, q, values[k])) valid = false;
+							}
+							if (v < numVertices) storePlyVertex(layout, values.data(), v, positions, normals, colors);
+						}
+					}
+				});
+				if (!valid) return fail(error, "broken PLY vertex");
+			}
+		} else if (isFace && faceIndex >= 0) {
+			const PlyProperty& list = element.properties[faceIndex];
+			bool valid = true;
+			if (encoding != Encoding::Ascii) {
+				// variable length records, one pass
+				indices.reserve(element.count * 3);
+				const size_t countSize = plySize(list.countType);
+				const size_t indexSize = plySize(list.type);
+				std::vector<long long> v;
+				for (size_t f = 0; f < element.count && valid; ++f) {
+					for (size_t k = 0; k < element.properties.size(); ++k) {
+						const PlyProperty& property = element.properties[k];
+						if (property.countType == PlyType::None) {
+							if (static_cast<size_t>(end - p) < plySize(property.type)) { valid = false; break; }
+							p += plySize(property.type);
+							continue;
+						}
+						if (static_cast<size_t>(end - p) < countSize) { valid = false; break; }
+						const size_t n = static_cast<size_t>(readPly(p, property.countType, swap));
+						p += countSize;
+						if (static_cast<size_t>(end - p) / indexSize < n) { valid = false; break; }
+						if (static_cast<int>(k) == faceIndex) {
+							v.resize(n);
+							for (size_t i = 0; i < n; ++i) {
+								v[i] = static_cast<long long>(readPly(p + i * indexSize, property.type, swap));
+							}
+							appendFan(v.data(), n, numVertices, indices, valid);
+						}
+						p += n * plySize(property.type);
+					}
+				}
+			} else {
+				const char* begin = p;
+				for (size_t f = 0; f < element.count && p < end; ++f) nextLine(p, end);
+				const std::vector<const char*> bounds = splitLines(begin, p, pool.numThreads() + 1);
+
+				std::vector<std::vector<uint32_t>> chunks(bounds.size() - 1);
+				std::vector<char> chunkValid(chunks.size(), 1);
+				pool.parallelFor(chunks.size(), 1, [&](size_t first, size_t last) {
+					std::vector<long long> v;
+					for (size_t c = first; c < last; ++c) {
+						bool ok = true;
+						const char* q = bounds[c];
+						while (q < bounds[c+1] && ok) {
+							const char* line = q;
+							nextLine(q, bounds[c+1]);
+							for (size_t k = 0; k < element.properties.size() && ok; ++k) {
+								const PlyProperty& property = element.properties[k];
+								double value;
+								if (property.countType == PlyType::None) {
+									ok = parseFloat(line, q, value);
+									continue;
+								}
+								long long n;
+								if (!parseInt(line, q, n) || n < 0) { ok = false; break; }
+								v.resize(n);
+								for (long long i = 0; i < n && ok; ++i) {
+									ok = parseFloat(line, q, value);
+									v[i] = static_cast<long long>(value);
+								}
+								if (ok && static_cast<int>(k) == faceIndex) appendFan(v.data(), n, numVertices, chunks[c], ok);
+							}
+						}
+						chunkValid[c] = ok;
+					}
+				});
+				for (size_t c = 0; c < chunks.size(); ++c) {
+					valid = valid && chunkValid[c];
+					indices.insert(indices.end(), chunks[c].begin(), chunks[c].end());
+				}
+			}
+			if (!valid) return fail(error, "broken PLY face");
+		} else {
+			// skip
+			if (encoding == Encoding::Ascii) {
+				for (size_t i = 0; i < element.count && p < end; ++i) nextLine(p, end);
+			} else if (element.stride > 0) {
+				if (static_cast<size_t>(end - p) / element.stride < element.count) return fail(error, "PLY is truncated");
+				p += element.count * element.stride;
+			} else {
+				for (size_t i = 0; i < element.count; ++i) {
+					for (const PlyProperty& property : element.properties) {
+						if (property.countType == PlyType::None) {
+							p += plySize(property.type);
+						} else {
+							if (p + plySize(property.countType) > end) return fail(error, "PLY is truncated");
+							const size_t n = static_cast<size_t>(readPly(p, property.countType, swap));
+							p += plySize(property.countType) + n * plySize(property.type);
+						}
+						if (p > end) return fail(error, "PLY is truncated");
+					}
+				}
+			}
+		}
+	}
+
+	if (!hasVertices) return fail(error, "PLY has no vertex element");
+
+	TriangleMeshPtr mesh = std::make_shared<TriangleMesh>();
+	mesh->setVertices(std::move(positions), std::move(normals), std::move(colors));
+	mesh->setIndices(std::move(indices));
+	if (!mesh->hasNormals() && options.computeNormals) mesh->computeNormals();
+	return mesh;
+}
+
+TriangleMeshPtr MeshLoader::loadOBJ(const char* data, size_t size, const MeshLoadOptions& options, std::string* error)
+{
+	ThreadPool& pool = ThreadPool::instance();
+
+	const std::vector<const char*> bounds = splitLines(data, data + size, pool.numThreads() + 1);
+	std::vector<ObjChunk> chunks(bounds.size() - 1);
+	pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; ++c) {
+			parseObjChunk(bounds[c], bounds[c+1], chunks[c]);
+		}
+	});
+
+	// offsets of the chunks, then relative indices are resolved
+	std::vector<size_t> positionOffset(chunks.size() + 1, 0), normalOffset(chunks.size() + 1, 0), cornerOffset(chunks.size() + 1, 0);
+	bool hasColors = false;
+	for (size_t c = 0; c < chunks.size(); ++c) {
+		if (!chunks[c].valid) return fail(error, "broken OBJ vertex");
+		positionOffset[c+1] = positionOffset[c] + chunks[c].positions.size() / 3;
+		normalOffset[c+1] = normalOffset[c] + chunks[c].normals.size() / 3;
+		cornerOffset[c+1] = cornerOffset[c] + chunks[c].corners.size() / 2;
+		hasColors = hasColors || chunks[c].hasColors;
+	}
+	const size_t numPositions = positionOffset.back();
+	const size_t numNormals = normalOffset.back();
+	const size_t numCorners = cornerOffset.back();
+	if (numCorners == 0) return fail(error, "OBJ has no face");
+
+	std::vector<uint32_t> cornerPositions(numCorners), cornerNormals(numCorners);
+	std::atomic<bool> valid(true);
+	std::atomic<bool> allNormals(numNormals > 0);
+	std::vector<float> allPositions(3 * numPositions), allColors(hasColors ? 3 * numPositions : 0), allNormalValues(3 * numNormals);
+	pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; ++c) {
+			ObjChunk& chunk = chunks[c];
+			std::copy(chunk.positions.begin(), chunk.positions.end(), allPositions.begin() + 3 * positionOffset[c]);
+			if (hasColors) std::copy(chunk.colors.begin(), chunk.colors.end(), allColors.begin() + 3 * positionOffset[c]);
+			std::copy(chunk.normals.begin(), chunk.normals.end(), allNormalValues.begin() + 3 * normalOffset[c]);
+
+			for (size_t i = 0; i < chunk.corners.size() / 2; ++i) {
+				const long long v = decodeObjIndex(chunk.corners[2*i], positionOffset[c]);
+				const long long n = decodeObjIndex(chunk.corners[2*i+1], normalOffset[c]);
+				if (v < 0 || static_cast<size_t>(v) >= numPositions) valid = false;
+				if (n < 0 || static_cast<size_t>(n) >= numNormals) allNormals = false;
+				cornerPositions[cornerOffset[c] + i] = static_cast<uint32_t>(std::max(0LL, v));
+				cornerNormals[cornerOffset[c] + i] = static_cast<uint32_t>(std::max(0LL, n));
+			}
+			std::vector<float>().swap(chunk.positions);
+			std::vector<long long>().swap(chunk.corners);
+		}
+	});
+	if (!valid) return fail(error, "OBJ face refers to a missing vertex");
+
+	TriangleMeshPtr mesh = std::make_shared<TriangleMesh>();
+	std::vector<float> colors;
+	if (!allNormals) {
+		// positions are shared as they are, normals are computed
+		if (hasColors) {
+			colors.resize(4 * numPositions);
+			for (size_t i = 0; i < numPositions; ++i) {
+				std::copy(&allColors[3*i], &allColors[3*i+3], &colors[4*i]);
+				colors[4*i+3] = 1.0f;
+			}
+		}
+		mesh->setVertices(std::move(allPositions), std::vector<float>(), std::move(colors));
+		mesh->setIndices(std::move(cornerPositions));
+		if (options.computeNormals) mesh->computeNormals();
+		return mesh;
+	}
+
+	// one vertex per position and normal pair
+	std::vector<uint64_t> keys(numCorners);
+	pool.parallelFor(numCorners, 1 << 16, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			keys[i] = static_cast<uint64_t>(cornerPositions[i]) << 32 | cornerNormals[i];
+		}
+	});
+
+	std::vector<uint32_t> indices, sources;
+	const size_t numVertices = mergeKeys<uint64_t, PairKeyHash>(keys, pool, indices, sources);
+
+	std::vector<float> positions(3 * numVertices), normals(3 * numVertices);
+	if (hasColors) colors.resize(4 * numVertices);
+	pool.parallelFor(numVertices, 1 << 16, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			const uint32_t v = cornerPositions[sources[i]];
+			const uint32_t n = cornerNormals[sources[i]];
+			std::copy(&allPositions[3*v], &allPositions[3*v+3], &positions[3*i]);
+			std::copy(&allNormalValues[3*n], &allNormalValues[3*n+3], &normals[3*i]);
+			if (hasColors) {
+				std::copy(&allColors[3*v], &allColors[3*v+3], &colors[4*i]);
+				colors[4*i+3] = 1.0f;
+			}
+		}
+	});
+
+	mesh->setVertices(std::move(positions), std::move(normals), std::move(colors));
+	mesh->setIndices(std::move(indices));
+	return mesh;
+}
+
+} /* namespace mesh */
+} /* namespace tgl */
@@ -0,0 +1,61 @@
+/*
+ * MeshLoader.h
+ */
+
+#ifndef TGL_MESH_MESHLOADER_H_
+#define TGL_MESH_MESHLOADER_H_
+
+#include <string>
+#include <vector>
+#include "tglCore/TriangleMesh.h"
+
+namespace tgl {
+namespace mesh {
+
+enum class MeshFormat {
+	Unknown,
+	STL,	// binary or ASCII
+	PLY,	// ASCII, binary little / big endian
+	OBJ,	// v, vn, f. polygons are triangulated as fans
+};
+
+struct MeshLoadOptions {
+	MeshLoadOptions() : mergeVertices(true), computeNormals(true), optimize(true), compactVertices(false) {}
+
+	// STL has 3 vertices per triangle. merge equal positions into one vertex (smooth shading).
+	// false keeps them, with the facet normals (flat shading)
+	bool mergeVertices;
+	// area weighted vertex normals if the file has none
+	bool computeNormals;
+	// triangles and vertices reordered by MeshOptimizer after loading a file
+	bool optimize;
+	// TriangleMesh::VertexFormat::Compact buffers, 14 bytes a vertex instead of 40.
+	// positions are quantized to 1 / 65535 of the bounding box
+	bool compactVertices;
+	// levels of detail built by MeshResource after loading, as ratios of the triangles
+	// (MeshLod::defaultRatios()). none by default
+	std::vector<double> lodRatios;
+};
+
+// Loaders of STL, PLY and OBJ files into TriangleMesh.
+// the file is memory mapped and parsed in parallel chunks on ThreadPool::instance(),
+// straight into the float / index arrays of the mesh.
+// equal vertices (STL positions, OBJ position and normal pairs) are merged with hash maps,
+// partitioned by hash over the threads.
+// returns nullptr on error, with the reason printed to std::cerr and stored in error if given
+class MeshLoader {
+public:
+	static MeshFormat formatOf(const std::string& path);	// by extension
+
+	static TriangleMeshPtr load(const std::string& path, const MeshLoadOptions& options = MeshLoadOptions(), std::string* error = nullptr);
+
+	// file contents in memory, not optimized
+	static TriangleMeshPtr loadSTL(const char* data, size_t size, const MeshLoadOptions& options = MeshLoadOptions(), std::string* error = nullptr);
+	static TriangleMeshPtr loadPLY(const char* data, size_t size, const MeshLoadOptions& options = MeshLoadOptions(), std::string* error = nullptr);
+	static TriangleMeshPtr loadOBJ(const char* data, size_t size, const MeshLoadOptions& options = MeshLoadOptions(), std::string* error = nullptr);
+};
+
+} /* namespace mesh */
+} /* namespace tgl */
+
+#endif /* TGL_MESH_MESHLOADER_H_ */
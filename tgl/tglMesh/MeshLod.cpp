@@ -0,0 +1,75 @@
+/*
+ * MeshLod.cpp
+ */
+
+#include <cmath>
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "MeshLod.h"
+
+namespace tgl {
+namespace mesh {
+
+std::vector<double> MeshLod::defaultRatios()
+{
+	return std::vector<double>{0.25, 0.0625};
+}
+
+MeshLodPtr MeshLod::create(TriangleMeshPtr mesh, const std::vector<double>& ratios)
+{
+	if (!mesh || mesh->numTriangles() == 0) return nullptr;
+
+	// each level from the previous one, cheaper than from the full mesh
+	std::vector<TriangleMeshPtr> levels(1, mesh);
+	for (double ratio : ratios) {
+		const size_t target = static_cast<size_t>(mesh->numTriangles() * ratio);
+		const TriangleMeshPtr& finer = levels.back();
+		if (target == 0 || target >= finer->numTriangles()) break;
+
+		TriangleMeshPtr level = MeshSimplifier::simplify(*finer, target);
+		if (!level || level->numTriangles() >= finer->numTriangles()) break;	// nothing to collapse
+		MeshOptimizer::optimize(*level);
+		level->setVertexFormat(mesh->vertexFormat());
+		levels.push_back(level);
+	}
+	return std::make_shared<MeshLod>(std::move(levels));
+}
+
+MeshLod::MeshLod(std::vector<TriangleMeshPtr> levels)
+	: levels_(std::move(levels))
+{
+	hysteresis_ = 0.15;
+
+	const TriangleMesh& mesh = *levels_.front();
+	center_ = 0.5 * (mesh.boundingBoxMin() + mesh.boundingBoxMax());
+	radius_ = 0.5 * (mesh.boundingBoxMax() - mesh.boundingBoxMin()).norm();
+
+	// triangles of the finer level over the pixels of the disc
+	const double trianglesPerPixel = 0.25;
+	thresholds_.assign(levels_.size(), 0.0);
+	for (size_t i = 1; i < levels_.size(); ++i) {
+		thresholds_[i] = std::sqrt(levels_[i-1]->numTriangles() / (M_PI * trianglesPerPixel));
+	}
+}
+
+size_t MeshLod::selectLevel(double pixels, size_t current) const
+{
+	const size_t n = std::min(levels_.size(), thresholds_.size());
+	size_t level = current < n ? current : 0;
+
+	while (level + 1 < n && pixels < thresholds_[level+1] * (1.0 - hysteresis_)) ++level;
+	while (level > 0 && pixels > thresholds_[level] * (1.0 + hysteresis_)) --level;
+	return level;
+}
+
+size_t MeshLod::bufferBytes() const
+{
+	size_t bytes = 0;
+	for (const auto& level : levels_) {
+		bytes += level->bufferBytes();
+	}
+	return bytes;
+}
+
+} /* namespace mesh */
+} /* namespace tgl */
@@ -0,0 +1,66 @@
+/*
+ * MeshLod.h
+ */
+
+#ifndef TGL_MESH_MESHLOD_H_
+#define TGL_MESH_MESHLOD_H_
+
+#include <memory>
+#include <vector>
+#include <Eigen/Core>
+#include "tglCore/TriangleMesh.h"
+
+namespace tgl {
+namespace mesh {
+
+class MeshLod;
+typedef std::shared_ptr<MeshLod> MeshLodPtr;
+
+// Levels of detail of a mesh, simplified by MeshSimplifier.
+// level 0 is the mesh itself. a level is picked by the radius of the bounding sphere on the
+// screen, with hysteresis so an object near a threshold does not switch every frame.
+// built ahead of time or on a worker thread (MeshLoadOptions::lodRatios), shared by any number of items.
+// the simplified levels are reordered by MeshOptimizer
+class MeshLod {
+public:
+	// ratios of the triangles of the levels after the first, 0.25 and 0.0625 by default
+	static std::vector<double> defaultRatios();
+	static MeshLodPtr create(TriangleMeshPtr mesh, const std::vector<double>& ratios = defaultRatios());
+
+	explicit MeshLod(std::vector<TriangleMeshPtr> levels);
+
+	size_t numLevels() const { return levels_.size(); }
+	const TriangleMeshPtr& level(size_t i) const { return levels_[i]; }
+	const std::vector<TriangleMeshPtr>& levels() const { return levels_; }
+
+	// bounding sphere of level 0
+	const Eigen::Vector3d& center() const { return center_; }
+	double radius() const { return radius_; }
+
+	// level i is used below the radius thresholds[i] in pixels (thresholds[0] is not used).
+	// by default a level is used when the finer one would have more than a triangle per 4 pixels
+	void setThresholds(const std::vector<double>& pixels) { thresholds_ = pixels; }
+	const std::vector<double>& thresholds() const { return thresholds_; }
+
+	// fraction of a threshold, 0.15 by default
+	void setHysteresis(double h) { hysteresis_ = h; }
+	double hysteresis() const { return hysteresis_; }
+
+	// level for the radius on the screen. current is the level the caller used last
+	size_t selectLevel(double pixels, size_t current) const;
+
+	// bytes of the buffers of all levels
+	size_t bufferBytes() const;
+
+private:
+	std::vector<TriangleMeshPtr> levels_;
+	std::vector<double> thresholds_;
+	double hysteresis_;
+	Eigen::Vector3d center_;
+	double radius_;
+};
+
+} /* namespace mesh */
+} /* namespace tgl */
+
+#endif /* TGL_MESH_MESHLOD_H_ */
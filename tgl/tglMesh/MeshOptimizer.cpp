@@ -0,0 +1,286 @@
+/*
+ * MeshOptimizer.cpp
+ */
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <Eigen/Geometry>
+#include "MeshOptimizer.h"
+
+namespace tgl {
+namespace mesh {
+
+namespace {
+
+// ----- vertex cache order -----
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+const int ForsythCacheSize = 32;
+
+class VertexScore {
+public:
+	VertexScore() {
+		for (int i = 0; i < ForsythCacheSize; ++i) {
+			if (i < 3) {
+				cache_[i] = 0.75f;		// used by the last triangle
+			} else {
+				const float s = 1.0f - static_cast<float>(i - 3) / (ForsythCacheSize - 3);
+				cache_[i] = std::pow(s, 1.5f);
+			}
+		}
+		for (int i = 0; i < 64; ++i) {
+			valence_[i] = i == 0 ? 0.0f : 2.0f / std::sqrt(static_cast<float>(i));
+		}
+	}
+
+	float operator()(int cachePosition, uint32_t remaining) const {
+		if (remaining == 0) return -1.0f;
+		float score = cachePosition >= 0 ? cache_[cachePosition] : 0.0f;
+		score += remaining < 64 ? valence_[remaining] : 2.0f / std::sqrt(static_cast<float>(remaining));
+		return score;
+	}
+
+private:
+	float cache_[ForsythCacheSize];
+	float valence_[64];
+};
+
+std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, size_t numVertices)
+{
+	static const VertexScore score;
+	const size_t numTriangles = indices.size() / 3;
+
+	// triangles of each vertex
+	std::vector<uint32_t> offsets(numVertices + 1, 0);
+	for (uint32_t v : indices) ++offsets[v + 1];
+	for (size_t i = 0; i < numVertices; ++i) offsets[i + 1] += offsets[i];
+	std::vector<uint32_t> remaining(numVertices);
+	for (size_t i = 0; i < numVertices; ++i) remaining[i] = offsets[i + 1] - offsets[i];
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t t = 0; t < numTriangles; ++t) {
+			for (int k = 0; k < 3; ++k) adjacency[fill[indices[t*3+k]]++] = static_cast<uint32_t>(t);
+		}
+	}
+
+	std::vector<int> cachePosition(numVertices, -1);
+	std::vector<float> vertexScore(numVertices);
+	for (size_t i = 0; i < numVertices; ++i) vertexScore[i] = score(-1, remaining[i]);
+
+	std::vector<char> emitted(numTriangles, 0);
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	std::vector<uint32_t> cache, next;
+	cache.reserve(ForsythCacheSize + 3);
+	next.reserve(ForsythCacheSize + 3);
+
+	size_t cursor = 0;	// next triangle in input order, when the cache has nothing
+	int64_t best = -1;
+	for (size_t n = 0; n < numTriangles; ++n) {
+		if (best < 0) {
+			while (emitted[cursor]) ++cursor;
+			best = static_cast<int64_t>(cursor);
+		}
+
+		const uint32_t t = static_cast<uint32_t>(best);
+		emitted[t] = 1;
+		const uint32_t* tri = &indices[t*3];
+		result.insert(result.end(), tri, tri + 3);
+
+		// the triangle goes to the front of the LRU cache
+		next.assign(tri, tri + 3);
+		for (uint32_t v : cache) {
+			if (v != tri[0] && v != tri[1] && v != tri[2]) next.push_back(v);
+		}
+		for (size_t i = ForsythCacheSize; i < next.size(); ++i) {
+			cachePosition[next[i]] = -1;	// pushed out
+			vertexScore[next[i]] = score(-1, remaining[next[i]]);
+		}
+		if (next.size() > static_cast<size_t>(ForsythCacheSize)) next.resize(ForsythCacheSize);
+		cache.swap(next);
+
+		for (int k = 0; k < 3; ++k) {
+			const uint32_t v = tri[k];
+			uint32_t* begin = &adjacency[offsets[v]];
+			uint32_t* end = begin + remaining[v];
+			*std::find(begin, end, t) = end[-1];
+			--remaining[v];
+		}
+
+		// scores of the cached vertices and their triangles, the best one is next
+		for (size_t i = 0; i < cache.size(); ++i) {
+			cachePosition[cache[i]] = static_cast<int>(i);
+		}
+		for (uint32_t v : cache) {
+			vertexScore[v] = score(cachePosition[v], remaining[v]);
+		}
+
+		best = -1;
+		float bestScore = -1.0f;
+		for (uint32_t v : cache) {
+			for (uint32_t i = offsets[v]; i < offsets[v] + remaining[v]; ++i) {
+				const uint32_t u = adjacency[i];
+				const float s = vertexScore[indices[u*3]] + vertexScore[indices[u*3+1]] + vertexScore[indices[u*3+2]];
+				if (s > bestScore) {
+					bestScore = s;
+					best = u;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+// ----- overdraw -----
+// the cache order is cut where a triangle misses all its vertices (the order jumps),
+// the pieces are sorted by how much they face outwards from the center of the mesh
+void sortClusters(std::vector<uint32_t>& indices, const std::vector<float>& positions, int cacheSize)
+{
+	const size_t numTriangles = indices.size() / 3;
+	if (numTriangles == 0) return;
+
+	std::vector<size_t> starts;
+	{
+		std::vector<uint32_t> fifo(cacheSize, UINT32_MAX);
+		size_t head = 0;
+		for (size_t t = 0; t < numTriangles; ++t) {
+			int misses = 0;
+			for (int k = 0; k < 3; ++k) {
+				const uint32_t v = indices[t*3+k];
+				if (std::find(fifo.begin(), fifo.end(), v) == fifo.end()) {
+					fifo[head] = v;
+					head = (head + 1) % cacheSize;
+					++misses;
+				}
+			}
+			if (t == 0 || misses == 3) starts.push_back(t);
+		}
+	}
+	starts.push_back(numTriangles);
+
+	auto position = [&](uint32_t v) { return Eigen::Vector3d(positions[v*3], positions[v*3+1], positions[v*3+2]); };
+
+	Eigen::Vector3d meshCenter = Eigen::Vector3d::Zero();
+	double meshArea = 0.0;
+	struct Cluster { size_t begin, end; double key; };
+	std::vector<Cluster> clusters;
+	std::vector<Eigen::Vector3d> centers, normals;
+
+	for (size_t c = 0; c + 1 < starts.size(); ++c) {
+		Eigen::Vector3d center = Eigen::Vector3d::Zero(), normal = Eigen::Vector3d::Zero();
+		double area = 0.0;
+		for (size_t t = starts[c]; t < starts[c+1]; ++t) {
+			const Eigen::Vector3d p0 = position(indices[t*3]), p1 = position(indices[t*3+1]), p2 = position(indices[t*3+2]);
+			const Eigen::Vector3d n = (p1 - p0).cross(p2 - p0);
+			const double a = n.norm();
+			center += a * (p0 + p1 + p2) / 3.0;
+			normal += n;
+			area += a;
+		}
+		meshCenter += center;
+		meshArea += area;
+		centers.push_back(area > 0.0 ? Eigen::Vector3d(center / area) : position(indices[starts[c]*3]));
+		normals.push_back(normal.norm() > 0.0 ? normal.normalized() : Eigen::Vector3d(normal));
+		clusters.push_back(Cluster{starts[c], starts[c+1], 0.0});
+	}
+	if (meshArea > 0.0) meshCenter /= meshArea;
+
+	for (size_t c = 0; c < clusters.size(); ++c) {
+		clusters[c].key = (centers[c] - meshCenter).dot(normals[c]);
+	}
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(indices.size());
+	for (const Cluster& c : clusters) {
+		sorted.insert(sorted.end(), indices.begin() + c.begin*3, indices.begin() + c.end*3);
+	}
+	indices.swap(sorted);
+}
+
+// ----- vertex fetch -----
+template <typename T>
+std::vector<T> remapAttribute(const std::vector<T>& values, const std::vector<uint32_t>& order, int components)
+{
+	if (values.empty()) return values;
+
+	std::vector<T> result(order.size() * components);
+	for (size_t i = 0; i < order.size(); ++i) {
+		std::copy(&values[order[i]*components], &values[order[i]*components] + components, &result[i*components]);
+	}
+	return result;
+}
+
+}
+
+void MeshOptimizer::optimize(TriangleMesh& mesh, const MeshOptimizeOptions& options, MeshOptimizeReport* report)
+{
+	if (report) report->before = analyze(mesh, options.cacheSize);
+	if (mesh.indices().empty()) {	// points only, nothing to reorder
+		if (report) report->after = report->before;
+		return;
+	}
+
+	std::vector<uint32_t> indices = mesh.indices();
+	if (options.vertexCache) {
+		indices = optimizeVertexCache(indices, mesh.numVertices());
+	}
+	if (options.overdraw) {
+		sortClusters(indices, mesh.positions(), std::max(options.cacheSize, 3));
+	}
+
+	if (options.vertexFetch) {
+		// first use order, vertices of no triangle are kept after them
+		std::vector<uint32_t> remap(mesh.numVertices(), UINT32_MAX);
+		std::vector<uint32_t> order;
+		order.reserve(mesh.numVertices());
+		for (uint32_t& v : indices) {
+			if (remap[v] == UINT32_MAX) {
+				remap[v] = static_cast<uint32_t>(order.size());
+				order.push_back(v);
+			}
+			v = remap[v];
+		}
+		for (uint32_t v = 0; v < remap.size(); ++v) {
+			if (remap[v] == UINT32_MAX) order.push_back(v);
+		}
+
+		mesh.setVertices(remapAttribute(mesh.positions(), order, 3), remapAttribute(mesh.normals(), order, 3), remapAttribute(mesh.colors(), order, 4));
+	}
+	mesh.setIndices(std::move(indices));
+
+	if (report) report->after = analyze(mesh, options.cacheSize);
+}
+
+MeshCacheStats MeshOptimizer::analyze(const TriangleMesh& mesh, int cacheSize)
+{
+	MeshCacheStats stats;
+	const std::vector<uint32_t>& indices = mesh.indices();
+	if (indices.empty()) return stats;
+
+	cacheSize = std::max(cacheSize, 3);
+	std::vector<uint32_t> fifo(cacheSize, UINT32_MAX);
+	std::vector<char> used(mesh.numVertices(), 0);
+	size_t head = 0, misses = 0, numUsed = 0;
+	for (uint32_t v : indices) {
+		if (std::find(fifo.begin(), fifo.end(), v) == fifo.end()) {
+			fifo[head] = v;
+			head = (head + 1) % cacheSize;
+			++misses;
+		}
+		if (!used[v]) {
+			used[v] = 1;
+			++numUsed;
+		}
+	}
+
+	stats.acmr = static_cast<double>(misses) / (indices.size() / 3);
+	stats.atvr = static_cast<double>(misses) / numUsed;
+	return stats;
+}
+
+} /* namespace mesh */
+} /* namespace tgl */
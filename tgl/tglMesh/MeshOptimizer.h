@@ -0,0 +1,53 @@
+/*
+ * MeshOptimizer.h
+ */
+
+#ifndef TGL_MESH_MESHOPTIMIZER_H_
+#define TGL_MESH_MESHOPTIMIZER_H_
+
+#include "tglCore/TriangleMesh.h"
+
+namespace tgl {
+namespace mesh {
+
+struct MeshOptimizeOptions {
+	MeshOptimizeOptions() : vertexCache(true), overdraw(false), vertexFetch(true), cacheSize(16) {}
+
+	// triangle order for the post transform vertex cache (Forsyth)
+	bool vertexCache;
+	// clusters of the cache order drawn outside facing first, fewer hidden pixels shaded.
+	// costs a few cache misses at the cluster borders
+	bool overdraw;
+	// vertices renumbered in the order of first use, the attribute reads become sequential
+	bool vertexFetch;
+	// FIFO cache of the statistics
+	int cacheSize;
+};
+
+struct MeshCacheStats {
+	MeshCacheStats() : acmr(0.0), atvr(0.0) {}
+
+	double acmr;	// cache misses per triangle, 0.5 at best, 3 at worst
+	double atvr;	// cache misses per vertex, 1 at best
+};
+
+struct MeshOptimizeReport {
+	MeshCacheStats before;
+	MeshCacheStats after;
+};
+
+// Reordering of the triangles and the vertices of a mesh, the shape is unchanged.
+// helps GPUs and even more software rasterizers (llvmpipe), both shading each
+// vertex once per cache miss and reading the arrays through the CPU caches
+class MeshOptimizer {
+public:
+	static void optimize(TriangleMesh& mesh, const MeshOptimizeOptions& options = MeshOptimizeOptions(), MeshOptimizeReport* report = nullptr);
+
+	// FIFO post transform cache simulation
+	static MeshCacheStats analyze(const TriangleMesh& mesh, int cacheSize = 16);
+};
+
+} /* namespace mesh */
+} /* namespace tgl */
+
+#endif /* TGL_MESH_MESHOPTIMIZER_H_ */
@@ -0,0 +1,76 @@
+/*
+ * MeshResource.cpp
+ */
+
+#include "MeshResource.h"
+
+namespace tgl {
+namespace mesh {
+
+MeshResourcePtr MeshResource::create(const std::string& path, const MeshLoadOptions& options)
+{
+	MeshResourcePtr resource = std::make_shared<MeshResource>(path, options);
+	ResourceLoader::instance().load(resource);
+	return resource;
+}
+
+MeshResource::MeshResource(const std::string& path, const MeshLoadOptions& options)
+	: Resource(path, "mesh"), options_(options)
+{
+	hasPlaceholderBox_ = false;
+	placeholderBoxMin_.setZero();
+	placeholderBoxMax_.setZero();
+}
+
+MeshResource::~MeshResource()
+{
+
+}
+
+void MeshResource::setPlaceholderBox(const Eigen::Vector3d& min, const Eigen::Vector3d& max)
+{
+	placeholderBoxMin_ = min;
+	placeholderBoxMax_ = max;
+	hasPlaceholderBox_ = true;
+}
+
+bool MeshResource::loadData(std::string& error)
+{
+	TriangleMeshPtr mesh = MeshLoader::load(path(), options_, &error);
+	if (mesh && !options_.lodRatios.empty()) {
+		std::atomic_store(&lod_, MeshLod::create(mesh, options_.lodRatios));
+	}
+	std::atomic_store(&mesh_, mesh);
+	return mesh != nullptr;
+}
+
+size_t MeshResource::uploadData(const void* context)
+{
+	// other contexts of a shared mesh upload on their first draw
+	const std::vector<TriangleMeshPtr> meshes = lod_ ? lod_->levels() : std::vector<TriangleMeshPtr>(1, mesh_);
+	for (const auto& mesh : meshes) {
+		if (mesh->bindBuffers(context)) {
+			mesh->unbindBuffers();
+		}
+	}
+	return uploadBytes();
+}
+
+size_t MeshResource::uploadBytes() const
+{
+	if (lod_) return lod_->bufferBytes();
+	return mesh_ ? mesh_->bufferBytes() : 0;
+}
+
+bool MeshResource::releaseData()
+{
+	std::atomic_store(&lod_, MeshLodPtr());
+	TriangleMeshPtr mesh = std::atomic_exchange(&mesh_, TriangleMeshPtr());
+	if (mesh && !hasPlaceholderBox_) {
+		setPlaceholderBox(mesh->boundingBoxMin(), mesh->boundingBoxMax());
+	}
+	return true;	// the buffers are deleted on the next frame, if no item holds the mesh
+}
+
+} /* namespace mesh */
+} /* namespace tgl */
@@ -0,0 +1,63 @@
+/*
+ * MeshResource.h
+ */
+
+#ifndef TGL_MESH_MESHRESOURCE_H_
+#define TGL_MESH_MESHRESOURCE_H_
+
+#include <memory>
+#include <string>
+#include <Eigen/Core>
+#include "tglCore/ResourceLoader.h"
+#include "tglCore/TriangleMesh.h"
+#include "MeshLoader.h"
+#include "MeshLod.h"
+
+namespace tgl {
+namespace mesh {
+
+class MeshResource;
+typedef std::shared_ptr<MeshResource> MeshResourcePtr;
+
+// Mesh file loaded by ResourceLoader.
+// parsed on a worker thread with MeshLoader, the buffers are uploaded on a render thread
+// within the upload budget. mesh() is nullptr until then.
+// evicted over the memory budget, the box of the mesh becomes the placeholder until it is loaded again
+class MeshResource : public Resource {
+public:
+	// starts loading
+	static MeshResourcePtr create(const std::string& path, const MeshLoadOptions& options = MeshLoadOptions());
+
+	MeshResource(const std::string& path, const MeshLoadOptions& options = MeshLoadOptions());
+	virtual ~MeshResource();
+
+	TriangleMeshPtr mesh() const { return isReady() ? std::atomic_load(&mesh_) : nullptr; }
+	// with MeshLoadOptions::lodRatios, level 0 is mesh()
+	MeshLodPtr lod() const { return isReady() ? std::atomic_load(&lod_) : nullptr; }
+
+	// box drawn until the mesh is ready, if known in advance (from a scene file)
+	void setPlaceholderBox(const Eigen::Vector3d& min, const Eigen::Vector3d& max);
+	bool hasPlaceholderBox() const { return hasPlaceholderBox_; }
+	const Eigen::Vector3d& placeholderBoxMin() const { return placeholderBoxMin_; }
+	const Eigen::Vector3d& placeholderBoxMax() const { return placeholderBoxMax_; }
+
+protected:
+	virtual bool loadData(std::string& error);
+	virtual size_t uploadData(const void* context);
+	virtual size_t uploadBytes() const;
+	virtual bool releaseData();
+
+private:
+	MeshLoadOptions options_;
+	TriangleMeshPtr mesh_;		// written by the worker, published by the Ready state. atomic access
+	MeshLodPtr lod_;
+
+	bool hasPlaceholderBox_;
+	Eigen::Vector3d placeholderBoxMin_;
+	Eigen::Vector3d placeholderBoxMax_;
+};
+
+} /* namespace mesh */
+} /* namespace tgl */
+
+#endif /* TGL_MESH_MESHRESOURCE_H_ */
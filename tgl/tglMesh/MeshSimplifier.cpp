@@ -0,0 +1,305 @@
+/*
+ * MeshSimplifier.cpp
+ */
+
+#include <queue>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <Eigen/Geometry>
+#include "MeshSimplifier.h"
+
+namespace tgl {
+namespace mesh {
+
+namespace {
+
+// symmetric 4x4 : aa ab ac ad bb bc bd cc cd dd
+struct Quadric {
+	double q[10];
+
+	Quadric() { std::fill(q, q + 10, 0.0); }
+
+	void addPlane(const Eigen::Vector3d& n, double d, double w) {
+		const double a = n.x(), b = n.y(), c = n.z();
+		q[0] += w*a*a; q[1] += w*a*b; q[2] += w*a*c; q[3] += w*a*d;
+		q[4] += w*b*b; q[5] += w*b*c; q[6] += w*b*d;
+		q[7] += w*c*c; q[8] += w*c*d;
+		q[9] += w*d*d;
+	}
+
+	Quadric& operator+=(const Quadric& o) {
+		for (int i = 0; i < 10; ++i) q[i] += o.q[i];
+		return *this;
+	}
+
+	double error(const Eigen::Vector3d& v) const {
+		const double x = v.x(), y = v.y(), z = v.z();
+		return q[0]*x*x + 2*q[1]*x*y + 2*q[2]*x*z + 2*q[3]*x
+			+ q[4]*y*y + 2*q[5]*y*z + 2*q[6]*y
+			+ q[7]*z*z + 2*q[8]*z
+			+ q[9];
+	}
+};
+
+struct Collapse {
+	double cost;
+	uint32_t keep, remove;
+	uint32_t keepStamp, removeStamp;
+
+	bool operator<(const Collapse& o) const { return cost > o.cost; }	// min heap
+};
+
+const double BorderWeight = 10.0;
+const double MinFaceCosine = 0.2;
+
+class Simplifier {
+public:
+	explicit Simplifier(const TriangleMesh& mesh);
+	void run(size_t targetTriangles, double maxError);
+	TriangleMeshPtr result(const TriangleMesh& mesh) const;
+
+private:
+	void pushEdge(uint32_t a, uint32_t b);
+	bool collapse(uint32_t keep, uint32_t remove);
+	void neighbors(uint32_t v, std::vector<uint32_t>& out) const;
+
+	std::vector<Eigen::Vector3d> positions_;
+	std::vector<uint32_t> faces_;					// 3 per triangle
+	std::vector<char> faceAlive_;
+	std::vector<Eigen::Vector3d> faceNormals_;		// of the input, unit
+	std::vector<std::vector<uint32_t>> vertexFaces_;
+	std::vector<Quadric> quadrics_;
+	std::vector<uint32_t> stamps_;
+	std::vector<char> vertexAlive_;
+	std::priority_queue<Collapse> heap_;
+	size_t numFaces_;
+
+	std::vector<uint32_t> ring1_, ring2_;		// scratch
+};
+
+Simplifier::Simplifier(const TriangleMesh& mesh)
+{
+	const size_t n = mesh.numVertices();
+	const float* p = mesh.positions().data();
+	positions_.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		positions_[i] = Eigen::Vector3d(p[i*3], p[i*3+1], p[i*3+2]);
+	}
+
+	faces_ = mesh.indices();
+	faceAlive_.assign(mesh.numTriangles(), 1);
+	faceNormals_.assign(mesh.numTriangles(), Eigen::Vector3d::Zero());
+	numFaces_ = mesh.numTriangles();
+	vertexFaces_.resize(n);
+	quadrics_.resize(n);
+	stamps_.assign(n, 0);
+	vertexAlive_.assign(n, 1);
+
+	// planes of the triangles, weighted by area. edges counted to find the borders
+	std::unordered_map<uint64_t, int> edgeCount;
+	edgeCount.reserve(faces_.size());
+	for (size_t f = 0; f < numFaces_; ++f) {
+		const uint32_t* v = &faces_[f*3];
+		for (int k = 0; k < 3; ++k) {
+			vertexFaces_[v[k]].push_back(static_cast<uint32_t>(f));
+			const uint32_t a = std::min(v[k], v[(k+1)%3]), b = std::max(v[k], v[(k+1)%3]);
+			++edgeCount[(static_cast<uint64_t>(a) << 32) | b];
+		}
+
+		Eigen::Vector3d normal = (positions_[v[1]] - positions_[v[0]]).cross(positions_[v[2]] - positions_[v[0]]);
+		const double area2 = normal.norm();
+		if (area2 <= 0.0) continue;
+		normal /= area2;
+		faceNormals_[f] = normal;
+		const double d = -normal.dot(positions_[v[0]]);
+		for (int k = 0; k < 3; ++k) {
+			quadrics_[v[k]].addPlane(normal, d, 0.5 * area2);
+		}
+	}
+
+	// planes through the border edges, perpendicular to their triangle
+	for (size_t f = 0; f < numFaces_; ++f) {
+		const uint32_t* v = &faces_[f*3];
+		for (int k = 0; k < 3; ++k) {
+			const uint32_t a = v[k], b = v[(k+1)%3];
+			const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+			if (edgeCount[key] != 1) continue;
+
+			const Eigen::Vector3d edge = positions_[b] - positions_[a];
+			const Eigen::Vector3d faceNormal = edge.cross(positions_[v[(k+2)%3]] - positions_[a]);
+			Eigen::Vector3d normal = edge.cross(faceNormal);
+			const double length = normal.norm();
+			if (length <= 0.0) continue;
+			normal /= length;
+			const double d = -normal.dot(positions_[a]);
+			const double w = BorderWeight * edge.squaredNorm();
+			quadrics_[a].addPlane(normal, d, w);
+			quadrics_[b].addPlane(normal, d, w);
+		}
+	}
+
+	for (const auto& entry : edgeCount) {
+		pushEdge(static_cast<uint32_t>(entry.first >> 32), static_cast<uint32_t>(entry.first & 0xffffffff));
+	}
+}
+
+void Simplifier::pushEdge(uint32_t a, uint32_t b)
+{
+	Quadric q = quadrics_[a];
+	q += quadrics_[b];
+	const double ea = q.error(positions_[a]);
+	const double eb = q.error(positions_[b]);
+
+	Collapse c;
+	if (ea <= eb) {
+		c.cost = ea; c.keep = a; c.remove = b;
+	} else {
+		c.cost = eb; c.keep = b; c.remove = a;
+	}
+	c.keepStamp = stamps_[c.keep];
+	c.removeStamp = stamps_[c.remove];
+	heap_.push(c);
+}
+
+void Simplifier::neighbors(uint32_t v, std::vector<uint32_t>& out) const
+{
+	out.clear();
+	for (uint32_t f : vertexFaces_[v]) {
+		for (int k = 0; k < 3; ++k) {
+			const uint32_t u = faces_[f*3+k];
+			if (u != v) out.push_back(u);
+		}
+	}
+	std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+bool Simplifier::collapse(uint32_t keep, uint32_t remove)
+{
+	// link condition : the vertices around both are the ones of the shared triangles
+	size_t shared = 0;
+	for (uint32_t f : vertexFaces_[remove]) {
+		const uint32_t* v = &faces_[f*3];
+		if (v[0] == keep || v[1] == keep || v[2] == keep) ++shared;
+	}
+	if (shared == 0) return false;
+
+	neighbors(keep, ring1_);
+	neighbors(remove, ring2_);
+	size_t common = 0;
+	for (size_t i = 0, j = 0; i < ring1_.size() && j < ring2_.size(); ) {
+		if (ring1_[i] < ring2_[j]) ++i;
+		else if (ring2_[j] < ring1_[i]) ++j;
+		else { ++common; ++i; ++j; }
+	}
+	if (common != shared) return false;
+
+	// no triangle folded over, against its normal in the input : small turns add up
+	const Eigen::Vector3d& target = positions_[keep];
+	for (uint32_t f : vertexFaces_[remove]) {
+		const uint32_t* v = &faces_[f*3];
+		if (v[0] == keep || v[1] == keep || v[2] == keep) continue;
+
+		Eigen::Vector3d q[3];
+		for (int k = 0; k < 3; ++k) {
+			q[k] = v[k] == remove ? target : positions_[v[k]];
+		}
+		const Eigen::Vector3d after = (q[1] - q[0]).cross(q[2] - q[0]);
+		const double area2 = after.norm();
+		if (area2 <= 0.0 || faceNormals_[f].dot(after) < MinFaceCosine * area2) return false;
+	}
+
+	// apply
+	for (uint32_t f : vertexFaces_[remove]) {
+		uint32_t* v = &faces_[f*3];
+		if (v[0] == keep || v[1] == keep || v[2] == keep) {
+			faceAlive_[f] = 0;
+			--numFaces_;
+			continue;
+		}
+		for (int k = 0; k < 3; ++k) {
+			if (v[k] == remove) v[k] = keep;
+		}
+		vertexFaces_[keep].push_back(f);
+	}
+	vertexFaces_[remove].clear();
+	vertexAlive_[remove] = 0;
+
+	// drop the dead triangles from the vertices around
+	for (uint32_t u : ring2_) {
+		std::vector<uint32_t>& faces = vertexFaces_[u];
+		faces.erase(std::remove_if(faces.begin(), faces.end(), [this](uint32_t f) { return !faceAlive_[f]; }), faces.end());
+	}
+	std::vector<uint32_t>& faces = vertexFaces_[keep];
+	faces.erase(std::remove_if(faces.begin(), faces.end(), [this](uint32_t f) { return !faceAlive_[f]; }), faces.end());
+
+	quadrics_[keep] += quadrics_[remove];
+	++stamps_[keep];
+	++stamps_[remove];
+
+	neighbors(keep, ring1_);
+	for (uint32_t u : ring1_) {
+		pushEdge(keep, u);
+	}
+	return true;
+}
+
+void Simplifier::run(size_t targetTriangles, double maxError)
+{
+	while (numFaces_ > targetTriangles && !heap_.empty()) {
+		const Collapse c = heap_.top();
+		heap_.pop();
+
+		if (!vertexAlive_[c.keep] || !vertexAlive_[c.remove]) continue;
+		if (stamps_[c.keep] != c.keepStamp || stamps_[c.remove] != c.removeStamp) continue;
+		if (c.cost > maxError) break;
+
+		collapse(c.keep, c.remove);
+	}
+}
+
+TriangleMeshPtr Simplifier::result(const TriangleMesh& mesh) const
+{
+	const size_t n = positions_.size();
+	const bool hasNormals = mesh.hasNormals();
+	const bool hasColors = mesh.hasColors();
+
+	std::vector<uint32_t> remap(n, UINT32_MAX);
+	std::vector<float> positions, normals, colors;
+	std::vector<uint32_t> indices;
+	indices.reserve(numFaces_ * 3);
+
+	for (size_t f = 0; f < faceAlive_.size(); ++f) {
+		if (!faceAlive_[f]) continue;
+		for (int k = 0; k < 3; ++k) {
+			const uint32_t v = faces_[f*3+k];
+			if (remap[v] == UINT32_MAX) {
+				remap[v] = static_cast<uint32_t>(positions.size() / 3);
+				positions.insert(positions.end(), &mesh.positions()[v*3], &mesh.positions()[v*3] + 3);
+				if (hasNormals) normals.insert(normals.end(), &mesh.normals()[v*3], &mesh.normals()[v*3] + 3);
+				if (hasColors) colors.insert(colors.end(), &mesh.colors()[v*4], &mesh.colors()[v*4] + 4);
+			}
+			indices.push_back(remap[v]);
+		}
+	}
+
+	TriangleMeshPtr result = std::make_shared<TriangleMesh>();
+	result->setVertices(std::move(positions), std::move(normals), std::move(colors));
+	result->setIndices(std::move(indices));
+	return result;
+}
+
+}
+
+TriangleMeshPtr MeshSimplifier::simplify(const TriangleMesh& mesh, size_t targetTriangles, double maxError)
+{
+	if (mesh.numTriangles() == 0) return nullptr;
+
+	Simplifier simplifier(mesh);
+	simplifier.run(targetTriangles, maxError);
+	return simplifier.result(mesh);
+}
+
+} /* namespace mesh */
+} /* namespace tgl */
@@ -0,0 +1,30 @@
+/*
+ * MeshSimplifier.h
+ */
+
+#ifndef TGL_MESH_MESHSIMPLIFIER_H_
+#define TGL_MESH_MESHSIMPLIFIER_H_
+
+#include <limits>
+#include "tglCore/TriangleMesh.h"
+
+namespace tgl {
+namespace mesh {
+
+// Quadric error edge collapse (Garland and Heckbert).
+// an edge collapses into one of its vertices, so the result is a subset of the vertices
+// with their normals and colors. collapses folding a triangle over or pinching the surface
+// are rejected, open borders are kept by penalty planes.
+// vertices must be shared by their triangles (MeshLoadOptions::mergeVertices),
+// split vertices (seams of normals) act as borders
+class MeshSimplifier {
+public:
+	// until the number of triangles or the error (squared distance weighted by area) is reached.
+	// returns nullptr for an empty mesh
+	static TriangleMeshPtr simplify(const TriangleMesh& mesh, size_t targetTriangles, double maxError = std::numeric_limits<double>::max());
+};
+
+} /* namespace mesh */
+} /* namespace tgl */
+
+#endif /* TGL_MESH_MESHSIMPLIFIER_H_ */
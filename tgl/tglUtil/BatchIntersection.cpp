@@ -0,0 +1,503 @@
+/*
+ * BatchIntersection.cpp
+ */
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "BatchIntersection.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TGL_BATCH_SSE2
+#endif
+
+namespace tgl
+{
+
+// ----- arrays -----
+void SphereArray::push_back(const Eigen::Vector3d& c, double radius)
+{
+	cx.push_back(c(0)); cy.push_back(c(1)); cz.push_back(c(2));
+	r.push_back(radius);
+}
+
+void SphereArray::clear()
+{
+	cx.clear(); cy.clear(); cz.clear(); r.clear();
+}
+
+void AABBArray::push_back(const Eigen::Vector3d& min, const Eigen::Vector3d& max)
+{
+	minx.push_back(min(0)); miny.push_back(min(1)); minz.push_back(min(2));
+	maxx.push_back(max(0)); maxy.push_back(max(1)); maxz.push_back(max(2));
+}
+
+void AABBArray::clear()
+{
+	minx.clear(); miny.clear(); minz.clear();
+	maxx.clear(); maxy.clear(); maxz.clear();
+}
+
+void OBBArray::push_back(const Eigen::Vector3d& c, const Eigen::Matrix3d& R, const Eigen::Vector3d& sides)
+{
+	cx.push_back(c(0)); cy.push_back(c(1)); cz.push_back(c(2));
+	r00.push_back(R(0,0)); r10.push_back(R(1,0)); r20.push_back(R(2,0));
+	r01.push_back(R(0,1)); r11.push_back(R(1,1)); r21.push_back(R(2,1));
+	r02.push_back(R(0,2)); r12.push_back(R(1,2)); r22.push_back(R(2,2));
+	hx.push_back(0.5 * sides(0)); hy.push_back(0.5 * sides(1)); hz.push_back(0.5 * sides(2));
+}
+
+void OBBArray::clear()
+{
+	cx.clear(); cy.clear(); cz.clear();
+	r00.clear(); r10.clear(); r20.clear();
+	r01.clear(); r11.clear(); r21.clear();
+	r02.clear(); r12.clear(); r22.clear();
+	hx.clear(); hy.clear(); hz.clear();
+}
+
+void SegmentArray::push_back(const Eigen::Vector3d& p1, const Eigen::Vector3d& p2, double radius)
+{
+	p1x.push_back(p1(0)); p1y.push_back(p1(1)); p1z.push_back(p1(2));
+	p2x.push_back(p2(0)); p2y.push_back(p2(1)); p2z.push_back(p2(2));
+	r.push_back(radius);
+}
+
+void SegmentArray::clear()
+{
+	p1x.clear(); p1y.clear(); p1z.clear();
+	p2x.clear(); p2y.clear(); p2z.clear();
+	r.clear();
+}
+
+void TriangleArray::push_back(const Eigen::Vector3d& v0, const Eigen::Vector3d& v1, const Eigen::Vector3d& v2)
+{
+	v0x.push_back(v0(0)); v0y.push_back(v0(1)); v0z.push_back(v0(2));
+	e1x.push_back(v1(0) - v0(0)); e1y.push_back(v1(1) - v0(1)); e1z.push_back(v1(2) - v0(2));
+	e2x.push_back(v2(0) - v0(0)); e2y.push_back(v2(1) - v0(1)); e2z.push_back(v2(2) - v0(2));
+}
+
+void TriangleArray::clear()
+{
+	v0x.clear(); v0y.clear(); v0z.clear();
+	e1x.clear(); e1y.clear(); e1z.clear();
+	e2x.clear(); e2y.clear(); e2z.clear();
+}
+
+namespace
+{
+
+// ----- lanes -----
+// the kernels are written once against these types
+
+struct ScalarMask { bool v; };
+
+struct ScalarPack {
+	enum { width = 1 };
+	typedef ScalarMask Mask;
+	double v;
+
+	static ScalarPack set(double x) { ScalarPack p = {x}; return p; }
+	static ScalarPack load(const double* ptr) { return set(*ptr); }
+	static ScalarPack index(size_t i) { return set(double(i)); }
+	void store(double* ptr) const { *ptr = v; }
+};
+
+inline ScalarPack operator+(ScalarPack a, ScalarPack b) { return ScalarPack::set(a.v + b.v); }
+inline ScalarPack operator-(ScalarPack a, ScalarPack b) { return ScalarPack::set(a.v - b.v); }
+inline ScalarPack operator*(ScalarPack a, ScalarPack b) { return ScalarPack::set(a.v * b.v); }
+inline ScalarPack operator/(ScalarPack a, ScalarPack b) { return ScalarPack::set(a.v / b.v); }
+inline ScalarPack vmin(ScalarPack a, ScalarPack b) { return ScalarPack::set(std::min(a.v, b.v)); }
+inline ScalarPack vmax(ScalarPack a, ScalarPack b) { return ScalarPack::set(std::max(a.v, b.v)); }
+inline ScalarPack vsqrt(ScalarPack a) { return ScalarPack::set(std::sqrt(a.v)); }
+inline ScalarPack vabs(ScalarPack a) { return ScalarPack::set(std::abs(a.v)); }
+inline ScalarMask operator<(ScalarPack a, ScalarPack b) { ScalarMask m = {a.v < b.v}; return m; }
+inline ScalarMask operator<=(ScalarPack a, ScalarPack b) { ScalarMask m = {a.v <= b.v}; return m; }
+inline ScalarMask operator>(ScalarPack a, ScalarPack b) { ScalarMask m = {a.v > b.v}; return m; }
+inline ScalarMask operator>=(ScalarPack a, ScalarPack b) { ScalarMask m = {a.v >= b.v}; return m; }
+inline ScalarMask operator&(ScalarMask a, ScalarMask b) { ScalarMask m = {a.v && b.v}; return m; }
+inline ScalarMask operator|(ScalarMask a, ScalarMask b) { ScalarMask m = {a.v || b.v}; return m; }
+inline ScalarMask vnot(ScalarMask a) { ScalarMask m = {!a.v}; return m; }
+inline ScalarPack select(ScalarMask m, ScalarPack a, ScalarPack b) { return m.v ? a : b; }
+inline bool any(ScalarMask m) { return m.v; }
+
+#if defined(__AVX__)
+
+struct AVXMask { __m256d v; };
+
+struct AVXPack {
+	enum { width = 4 };
+	typedef AVXMask Mask;
+	__m256d v;
+
+	static AVXPack make(__m256d x) { AVXPack p; p.v = x; return p; }
+	static AVXPack set(double x) { return make(_mm256_set1_pd(x)); }
+	static AVXPack load(const double* ptr) { return make(_mm256_loadu_pd(ptr)); }
+	static AVXPack index(size_t i) { double d = double(i); return make(_mm256_set_pd(d + 3, d + 2, d + 1, d)); }
+	void store(double* ptr) const { _mm256_storeu_pd(ptr, v); }
+};
+
+inline AVXMask avxMask(__m256d x) { AVXMask m; m.v = x; return m; }
+inline AVXPack operator+(AVXPack a, AVXPack b) { return AVXPack::make(_mm256_add_pd(a.v, b.v)); }
+inline AVXPack operator-(AVXPack a, AVXPack b) { return AVXPack::make(_mm256_sub_pd(a.v, b.v)); }
+inline AVXPack operator*(AVXPack a, AVXPack b) { return AVXPack::make(_mm256_mul_pd(a.v, b.v)); }
+inline AVXPack operator/(AVXPack a, AVXPack b) { return AVXPack::make(_mm256_div_pd(a.v, b.v)); }
+inline AVXPack vmin(AVXPack a, AVXPack b) { return AVXPack::make(_mm256_min_pd(a.v, b.v)); }
+inline AVXPack vmax(AVXPack a, AVXPack b) { return AVXPack::make(_mm256_max_pd(a.v, b.v)); }
+inline AVXPack vsqrt(AVXPack a) { return AVXPack::make(_mm256_sqrt_pd(a.v)); }
+inline AVXPack vabs(AVXPack a) { return AVXPack::make(_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)); }
+inline AVXMask operator<(AVXPack a, AVXPack b) { return avxMask(_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)); }
+inline AVXMask operator<=(AVXPack a, AVXPack b) { return avxMask(_mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ)); }
+inline AVXMask operator>(AVXPack a, AVXPack b) { return avxMask(_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)); }
+inline AVXMask operator>=(AVXPack a, AVXPack b) { return avxMask(_mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ)); }
+inline AVXMask operator&(AVXMask a, AVXMask b) { return avxMask(_mm256_and_pd(a.v, b.v)); }
+inline AVXMask operator|(AVXMask a, AVXMask b) { return avxMask(_mm256_or_pd(a.v, b.v)); }
+inline AVXMask vnot(AVXMask a) { return avxMask(_mm256_xor_pd(a.v, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)))); }
+inline AVXPack select(AVXMask m, AVXPack a, AVXPack b) { return AVXPack::make(_mm256_blendv_pd(b.v, a.v, m.v)); }
+inline bool any(AVXMask m) { return _mm256_movemask_pd(m.v) != 0; }
+
+typedef AVXPack WidePack;
+
+#elif defined(TGL_BATCH_SSE2)
+
+struct SSEMask { __m128d v; };
+
+struct SSEPack {
+	enum { width = 2 };
+	typedef SSEMask Mask;
+	__m128d v;
+
+	static SSEPack make(__m128d x) { SSEPack p; p.v = x; return p; }
+	static SSEPack set(double x) { return make(_mm_set1_pd(x)); }
+	static SSEPack load(const double* ptr) { return make(_mm_loadu_pd(ptr)); }
+	static SSEPack index(size_t i) { double d = double(i); return make(_mm_set_pd(d + 1, d)); }
+	void store(double* ptr) const { _mm_storeu_pd(ptr, v); }
+};
+
+inline SSEMask sseMask(__m128d x) { SSEMask m; m.v = x; return m; }
+inline SSEPack operator+(SSEPack a, SSEPack b) { return SSEPack::make(_mm_add_pd(a.v, b.v)); }
+inline SSEPack operator-(SSEPack a, SSEPack b) { return SSEPack::make(_mm_sub_pd(a.v, b.v)); }
+inline SSEPack operator*(SSEPack a, SSEPack b) { return SSEPack::make(_mm_mul_pd(a.v, b.v)); }
+inline SSEPack operator/(SSEPack a, SSEPack b) { return SSEPack::make(_mm_div_pd(a.v, b.v)); }
+inline SSEPack vmin(SSEPack a, SSEPack b) { return SSEPack::make(_mm_min_pd(a.v, b.v)); }
+inline SSEPack vmax(SSEPack a, SSEPack b) { return SSEPack::make(_mm_max_pd(a.v, b.v)); }
+inline SSEPack vsqrt(SSEPack a) { return SSEPack::make(_mm_sqrt_pd(a.v)); }
+inline SSEPack vabs(SSEPack a) { return SSEPack::make(_mm_andnot_pd(_mm_set1_pd(-0.0), a.v)); }
+inline SSEMask operator<(SSEPack a, SSEPack b) { return sseMask(_mm_cmplt_pd(a.v, b.v)); }
+inline SSEMask operator<=(SSEPack a, SSEPack b) { return sseMask(_mm_cmple_pd(a.v, b.v)); }
+inline SSEMask operator>(SSEPack a, SSEPack b) { return sseMask(_mm_cmpgt_pd(a.v, b.v)); }
+inline SSEMask operator>=(SSEPack a, SSEPack b) { return sseMask(_mm_cmpge_pd(a.v, b.v)); }
+inline SSEMask operator&(SSEMask a, SSEMask b) { return sseMask(_mm_and_pd(a.v, b.v)); }
+inline SSEMask operator|(SSEMask a, SSEMask b) { return sseMask(_mm_or_pd(a.v, b.v)); }
+inline SSEMask vnot(SSEMask a) { return sseMask(_mm_xor_pd(a.v, _mm_castsi128_pd(_mm_set1_epi32(-1)))); }
+inline SSEPack select(SSEMask m, SSEPack a, SSEPack b) { return SSEPack::make(_mm_or_pd(_mm_and_pd(m.v, a.v), _mm_andnot_pd(m.v, b.v))); }
+inline bool any(SSEMask m) { return _mm_movemask_pd(m.v) != 0; }
+
+typedef SSEPack WidePack;
+
+#endif
+
+// ray broadcast to all lanes
+template <typename P>
+struct RayPack {
+	RayPack(const Eigen::Vector3d& o, const Eigen::Vector3d& d)
+		: ox(P::set(o(0))), oy(P::set(o(1))), oz(P::set(o(2))),
+		  dx(P::set(d(0))), dy(P::set(d(1))), dz(P::set(d(2))),
+		  dd(P::set(d.dot(d))), zero(P::set(0.0)), one(P::set(1.0)) {}
+
+	P ox, oy, oz;
+	P dx, dy, dz;
+	P dd;
+	P zero, one;
+};
+
+template <typename P>
+inline P dot(P ax, P ay, P az, P bx, P by, P bz) { return ax*bx + ay*by + az*bz; }
+
+template <typename P>
+inline void keepNearest(typename P::Mask& m, P& t, typename P::Mask m2, P t2)
+{
+	typename P::Mask take = m2 & (vnot(m) | (t2 < t));
+	t = select(take, t2, t);
+	m = m | m2;
+}
+
+template <typename P>
+inline typename P::Mask sphereHit(const RayPack<P>& ray, P cx, P cy, P cz, P r, P& t)
+{
+	P mx = ray.ox - cx, my = ray.oy - cy, mz = ray.oz - cz;
+	P b = dot(mx, my, mz, ray.dx, ray.dy, ray.dz);
+	P c = dot(mx, my, mz, mx, my, mz) - r*r;
+	P disc = b*b - ray.dd*c;
+	P sq = vsqrt(vmax(disc, ray.zero));
+	P t1 = (ray.zero - b - sq) / ray.dd;
+	P t2 = (ray.zero - b + sq) / ray.dd;
+	t = select(t1 >= ray.zero, t1, t2);
+	return (disc >= ray.zero) & (t >= ray.zero);
+}
+
+// slabs of a box centered at the origin of the (lo, ld) frame
+template <typename P>
+inline typename P::Mask slabHit(const RayPack<P>& ray, P lox, P loy, P loz, P ldx, P ldy, P ldz,
+		P minx, P miny, P minz, P maxx, P maxy, P maxz, P& t)
+{
+	P t1 = (minx - lox) / ldx, t2 = (maxx - lox) / ldx;
+	P tn = vmin(t1, t2), tf = vmax(t1, t2);
+	t1 = (miny - loy) / ldy; t2 = (maxy - loy) / ldy;
+	tn = vmax(tn, vmin(t1, t2)); tf = vmin(tf, vmax(t1, t2));
+	t1 = (minz - loz) / ldz; t2 = (maxz - loz) / ldz;
+	tn = vmax(tn, vmin(t1, t2)); tf = vmin(tf, vmax(t1, t2));
+
+	t = select(tn >= ray.zero, tn, tf);
+	return (tn <= tf) & (tf >= ray.zero);
+}
+
+// side of the infinite cylinder around p1-p2, limited to the segment
+template <typename P>
+struct SegmentLanes {
+	SegmentLanes(const RayPack<P>& ray, const SegmentArray& a, size_t i)
+	{
+		p1x = P::load(&a.p1x[i]); p1y = P::load(&a.p1y[i]); p1z = P::load(&a.p1z[i]);
+		p2x = P::load(&a.p2x[i]); p2y = P::load(&a.p2y[i]); p2z = P::load(&a.p2z[i]);
+		r = P::load(&a.r[i]);
+		bax = p2x - p1x; bay = p2y - p1y; baz = p2z - p1z;
+		P oax = ray.ox - p1x, oay = ray.oy - p1y, oaz = ray.oz - p1z;
+		baba = dot(bax, bay, baz, bax, bay, baz);
+		bad = dot(bax, bay, baz, ray.dx, ray.dy, ray.dz);
+		baoa = dot(bax, bay, baz, oax, oay, oaz);
+
+		P kd = bad / baba, ko = baoa / baba;
+		P dpx = ray.dx - kd*bax, dpy = ray.dy - kd*bay, dpz = ray.dz - kd*baz;
+		P opx = oax - ko*bax, opy = oay - ko*bay, opz = oaz - ko*baz;
+		qa = dot(dpx, dpy, dpz, dpx, dpy, dpz);
+		qb = dot(opx, opy, opz, dpx, dpy, dpz);
+		qc = dot(opx, opy, opz, opx, opy, opz) - r*r;
+	}
+
+	typename P::Mask bodyHit(const RayPack<P>& ray, P& t) const
+	{
+		P disc = qb*qb - qa*qc;
+		typename P::Mask valid = (qa > P::set(1.0e-12)) & (disc >= ray.zero);
+		P sq = vsqrt(vmax(disc, ray.zero));
+		P t1 = (ray.zero - qb - sq) / qa;
+		P t2 = (ray.zero - qb + sq) / qa;
+		P y1 = baoa + t1*bad, y2 = baoa + t2*bad;
+		typename P::Mask ok1 = valid & (t1 >= ray.zero) & (y1 >= ray.zero) & (y1 <= baba);
+		typename P::Mask ok2 = valid & (t2 >= ray.zero) & (y2 >= ray.zero) & (y2 <= baba);
+		t = select(ok1, t1, t2);
+		return ok1 | ok2;
+	}
+
+	// disk at p with the normal of the axis
+	typename P::Mask capHit(const RayPack<P>& ray, P px, P py, P pz, P& t) const
+	{
+		t = dot(px - ray.ox, py - ray.oy, pz - ray.oz, bax, bay, baz) / bad;
+		P qx = ray.ox + t*ray.dx - px, qy = ray.oy + t*ray.dy - py, qz = ray.oz + t*ray.dz - pz;
+		return (vabs(bad) > P::set(1.0e-12)) & (t >= ray.zero) & (dot(qx, qy, qz, qx, qy, qz) <= r*r);
+	}
+
+	P p1x, p1y, p1z, p2x, p2y, p2z, r;
+	P bax, bay, baz, baba, bad, baoa;
+	P qa, qb, qc;
+};
+
+// ----- kernels -----
+struct SphereKernel {
+	const SphereArray& a;
+	size_t size() const { return a.size(); }
+
+	template <typename P>
+	typename P::Mask operator()(const RayPack<P>& ray, size_t i, P& t) const {
+		return sphereHit(ray, P::load(&a.cx[i]), P::load(&a.cy[i]), P::load(&a.cz[i]), P::load(&a.r[i]), t);
+	}
+};
+
+struct AABBKernel {
+	const AABBArray& a;
+	size_t size() const { return a.size(); }
+
+	template <typename P>
+	typename P::Mask operator()(const RayPack<P>& ray, size_t i, P& t) const {
+		return slabHit(ray, ray.ox, ray.oy, ray.oz, ray.dx, ray.dy, ray.dz,
+				P::load(&a.minx[i]), P::load(&a.miny[i]), P::load(&a.minz[i]),
+				P::load(&a.maxx[i]), P::load(&a.maxy[i]), P::load(&a.maxz[i]), t);
+	}
+};
+
+struct OBBKernel {
+	const OBBArray& a;
+	size_t size() const { return a.size(); }
+
+	template <typename P>
+	typename P::Mask operator()(const RayPack<P>& ray, size_t i, P& t) const {
+		P ox = ray.ox - P::load(&a.cx[i]), oy = ray.oy - P::load(&a.cy[i]), oz = ray.oz - P::load(&a.cz[i]);
+
+		// R^T (o - c), R^T d
+		P r00 = P::load(&a.r00[i]), r10 = P::load(&a.r10[i]), r20 = P::load(&a.r20[i]);
+		P r01 = P::load(&a.r01[i]), r11 = P::load(&a.r11[i]), r21 = P::load(&a.r21[i]);
+		P r02 = P::load(&a.r02[i]), r12 = P::load(&a.r12[i]), r22 = P::load(&a.r22[i]);
+		P lox = dot(r00, r10, r20, ox, oy, oz), ldx = dot(r00, r10, r20, ray.dx, ray.dy, ray.dz);
+		P loy = dot(r01, r11, r21, ox, oy, oz), ldy = dot(r01, r11, r21, ray.dx, ray.dy, ray.dz);
+		P loz = dot(r02, r12, r22, ox, oy, oz), ldz = dot(r02, r12, r22, ray.dx, ray.dy, ray.dz);
+
+		P hx = P::load(&a.hx[i]), hy = P::load(&a.hy[i]), hz = P::load(&a.hz[i]);
+		return slabHit(ray, lox, loy, loz, ldx, ldy, ldz,
+				ray.zero - hx, ray.zero - hy, ray.zero - hz, hx, hy, hz, t);
+	}
+};
+
+struct CapsuleKernel {
+	const SegmentArray& a;
+	size_t size() const { return a.size(); }
+
+	template <typename P>
+	typename P::Mask operator()(const RayPack<P>& ray, size_t i, P& t) const {
+		SegmentLanes<P> s(ray, a, i);
+		typename P::Mask m = s.bodyHit(ray, t);
+		P t2;
+		keepNearest(m, t, sphereHit(ray, s.p1x, s.p1y, s.p1z, s.r, t2), t2);
+		keepNearest(m, t, sphereHit(ray, s.p2x, s.p2y, s.p2z, s.r, t2), t2);
+		return m;
+	}
+};
+
+struct CylinderKernel {
+	const SegmentArray& a;
+	size_t size() const { return a.size(); }
+
+	template <typename P>
+	typename P::Mask operator()(const RayPack<P>& ray, size_t i, P& t) const {
+		SegmentLanes<P> s(ray, a, i);
+		typename P::Mask m = s.bodyHit(ray, t);
+		P t2;
+		keepNearest(m, t, s.capHit(ray, s.p1x, s.p1y, s.p1z, t2), t2);
+		keepNearest(m, t, s.capHit(ray, s.p2x, s.p2y, s.p2z, t2), t2);
+		return m;
+	}
+};
+
+// Moller-Trumbore
+struct TriangleKernel {
+	const TriangleArray& a;
+	size_t size() const { return a.size(); }
+
+	template <typename P>
+	typename P::Mask operator()(const RayPack<P>& ray, size_t i, P& t) const {
+		P e1x = P::load(&a.e1x[i]), e1y = P::load(&a.e1y[i]), e1z = P::load(&a.e1z[i]);
+		P e2x = P::load(&a.e2x[i]), e2y = P::load(&a.e2y[i]), e2z = P::load(&a.e2z[i]);
+
+		P px = ray.dy*e2z - ray.dz*e2y, py = ray.dz*e2x - ray.dx*e2z, pz = ray.dx*e2y - ray.dy*e2x;
+		P det = dot(e1x, e1y, e1z, px, py, pz);
+		P inv = ray.one / det;
+
+		P tx = ray.ox - P::load(&a.v0x[i]), ty = ray.oy - P::load(&a.v0y[i]), tz = ray.oz - P::load(&a.v0z[i]);
+		P u = dot(tx, ty, tz, px, py, pz) * inv;
+
+		P qx = ty*e1z - tz*e1y, qy = tz*e1x - tx*e1z, qz = tx*e1y - ty*e1x;
+		P v = dot(ray.dx, ray.dy, ray.dz, qx, qy, qz) * inv;
+		t = dot(e2x, e2y, e2z, qx, qy, qz) * inv;
+
+		return (vabs(det) > P::set(1.0e-15)) & (u >= ray.zero) & (v >= ray.zero) & (u + v <= ray.one) & (t >= ray.zero);
+	}
+};
+
+// nearest hit of the lanes from begin, whole packs only. returns the first index not tested
+template <typename P, typename Kernel>
+size_t nearestHit(const Kernel& kernel, size_t begin, const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, RayHit& hit)
+{
+	const size_t n = kernel.size();
+	if (begin + P::width > n) return begin;
+
+	RayPack<P> ray(origin, dir);
+	P bestT = P::set(std::numeric_limits<double>::infinity());
+	P bestI = P::set(-1.0);
+
+	size_t i = begin;
+	for (; i + P::width <= n; i += P::width) {
+		P t;
+		typename P::Mask m = kernel(ray, i, t);
+		if (!any(m)) continue;
+		m = m & (t < bestT);
+		bestT = select(m, t, bestT);
+		bestI = select(m, P::index(i), bestI);
+	}
+
+	double ts[P::width], is[P::width];
+	bestT.store(ts);
+	bestI.store(is);
+	for (int k = 0; k < P::width; ++k) {
+		if (is[k] < 0.0) continue;
+		const int index = static_cast<int>(is[k]);
+		if (!hit.hit() || ts[k] < hit.t || (ts[k] == hit.t && index < hit.index)) {
+			hit.index = index;
+			hit.t = ts[k];
+		}
+	}
+	return i;
+}
+
+template <typename Kernel>
+RayHit run(const Kernel& kernel, const Eigen::Vector3d& origin, const Eigen::Vector3d& dir)
+{
+	RayHit hit;
+	size_t i = 0;
+#if defined(__AVX__) || defined(TGL_BATCH_SSE2)
+	i = nearestHit<WidePack>(kernel, i, origin, dir, hit);
+#endif
+	nearestHit<ScalarPack>(kernel, i, origin, dir, hit);	// the rest
+	return hit;
+}
+
+}
+
+RayHit calcIntersectionRayAndSpheres(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const SphereArray& spheres)
+{
+	SphereKernel kernel = {spheres};
+	return run(kernel, origin, dir);
+}
+
+RayHit calcIntersectionRayAndAABBs(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const AABBArray& boxes)
+{
+	AABBKernel kernel = {boxes};
+	return run(kernel, origin, dir);
+}
+
+RayHit calcIntersectionRayAndOBBs(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const OBBArray& boxes)
+{
+	OBBKernel kernel = {boxes};
+	return run(kernel, origin, dir);
+}
+
+RayHit calcIntersectionRayAndCapsules(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const CapsuleArray& capsules)
+{
+	CapsuleKernel kernel = {capsules};
+	return run(kernel, origin, dir);
+}
+
+RayHit calcIntersectionRayAndCylinders(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const CylinderArray& cylinders)
+{
+	CylinderKernel kernel = {cylinders};
+	return run(kernel, origin, dir);
+}
+
+RayHit calcIntersectionRayAndTriangles(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const TriangleArray& triangles)
+{
+	TriangleKernel kernel = {triangles};
+	return run(kernel, origin, dir);
+}
+
+const char* batchIntersectionInstructionSet()
+{
+#if defined(__AVX__)
+	return "AVX";
+#elif defined(TGL_BATCH_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * BatchIntersection.h
+ */
+
+#ifndef TGL_UTIL_BATCHINTERSECTION_H_
+#define TGL_UTIL_BATCHINTERSECTION_H_
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace tgl
+{
+
+// One ray against many primitives stored as structure of arrays.
+// the kernels use AVX (4 lanes) or SSE2 (2 lanes) when the compiler targets them
+// (-mavx / x86-64), otherwise plain scalar code.
+// ray : origin + t * dir (t >= 0)
+
+struct RayHit {
+	RayHit() : index(-1), t(0.0) {}
+	bool hit() const { return index >= 0; }
+
+	int index;	// nearest primitive, -1 if none
+	double t;
+};
+
+struct SphereArray {
+	void push_back(const Eigen::Vector3d& c, double r);
+	void clear();
+	size_t size() const { return r.size(); }
+
+	std::vector<double> cx, cy, cz, r;
+};
+
+struct AABBArray {
+	void push_back(const Eigen::Vector3d& min, const Eigen::Vector3d& max);
+	void clear();
+	size_t size() const { return minx.size(); }
+
+	std::vector<double> minx, miny, minz, maxx, maxy, maxz;
+};
+
+// center, axes (columns of R) and half extents
+struct OBBArray {
+	void push_back(const Eigen::Vector3d& c, const Eigen::Matrix3d& R, const Eigen::Vector3d& sides);
+	void clear();
+	size_t size() const { return cx.size(); }
+
+	std::vector<double> cx, cy, cz;
+	std::vector<double> r00, r10, r20, r01, r11, r21, r02, r12, r22;
+	std::vector<double> hx, hy, hz;
+};
+
+// segment p1-p2 with radius. used for capsules and capped cylinders
+struct SegmentArray {
+	void push_back(const Eigen::Vector3d& p1, const Eigen::Vector3d& p2, double r);
+	void clear();
+	size_t size() const { return r.size(); }
+
+	std::vector<double> p1x, p1y, p1z, p2x, p2y, p2z, r;
+};
+typedef SegmentArray CapsuleArray;
+typedef SegmentArray CylinderArray;
+
+// v0 and the edges v1 - v0, v2 - v0
+struct TriangleArray {
+	void push_back(const Eigen::Vector3d& v0, const Eigen::Vector3d& v1, const Eigen::Vector3d& v2);
+	void clear();
+	size_t size() const { return v0x.size(); }
+
+	std::vector<double> v0x, v0y, v0z, e1x, e1y, e1z, e2x, e2y, e2z;
+};
+
+RayHit calcIntersectionRayAndSpheres(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const SphereArray& spheres);
+RayHit calcIntersectionRayAndAABBs(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const AABBArray& boxes);
+RayHit calcIntersectionRayAndOBBs(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const OBBArray& boxes);
+RayHit calcIntersectionRayAndCapsules(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const CapsuleArray& capsules);
+RayHit calcIntersectionRayAndCylinders(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const CylinderArray& cylinders);
+// both sides
+RayHit calcIntersectionRayAndTriangles(const Eigen::Vector3d& origin, const Eigen::Vector3d& dir, const TriangleArray& triangles);
+
+// "AVX", "SSE2" or "scalar"
+const char* batchIntersectionInstructionSet();
+
+}
+
+#endif /* TGL_UTIL_BATCHINTERSECTION_H_ */
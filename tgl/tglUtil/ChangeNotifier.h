@@ -0,0 +1,58 @@
+/*
+ * ChangeNotifier.h
+ */
+
+#ifndef TGL_UTIL_CHANGENOTIFIER_H_
+#define TGL_UTIL_CHANGENOTIFIER_H_
+
+#include <atomic>
+#include <functional>
+
+namespace tgl {
+
+// Coalesced change notification.
+// notify() only raises a flag, without locks or allocation, from any thread.
+// flush() calls the callback once for any number of notify() since the last flush.
+// in immediate mode notify() calls the callback at once, on the calling thread
+class ChangeNotifier {
+public:
+	typedef std::function<void ()> Callback;
+
+	explicit ChangeNotifier(Callback callback = Callback())
+		: callback_(callback), pending_(false), immediate_(false) {}
+
+	void setCallback(Callback callback) { callback_ = callback; }
+
+	void setImmediate(bool on) { immediate_.store(on, std::memory_order_relaxed); }
+	bool isImmediate() const { return immediate_.load(std::memory_order_relaxed); }
+
+	void notify() {
+		if (isImmediate()) {
+			if (callback_) callback_();
+			return;
+		}
+		pending_.store(true, std::memory_order_release);
+	}
+
+	bool isPending() const { return pending_.load(std::memory_order_acquire); }
+
+	// returns true if the callback was called
+	bool flush() {
+		if (!pending_.load(std::memory_order_relaxed)) return false;
+		if (!pending_.exchange(false, std::memory_order_acq_rel)) return false;
+		if (callback_) callback_();
+		return true;
+	}
+
+private:
+	ChangeNotifier(const ChangeNotifier&) = delete;
+	ChangeNotifier& operator=(const ChangeNotifier&) = delete;
+
+	Callback callback_;
+	std::atomic<bool> pending_;
+	std::atomic<bool> immediate_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_UTIL_CHANGENOTIFIER_H_ */
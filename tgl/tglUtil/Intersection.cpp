@@ -2,6 +2,9 @@
  * Intersection.cpp
  */
 
+#include <cmath>
+#include <limits>
+#include <algorithm>
 #include <Eigen/Geometry>
 #include "Intersection.h"
 
@@ -92,4 +95,191 @@ bool calcIntersectionLineAndSphere(Eigen::Vector3d& intersection_p,
 	}
 }
 
+namespace
+{
+
+// smallest root of a t^2 + 2 b t + c = 0 that satisfies t >= 0 and accept(t)
+template <typename Func>
+bool nearestRoot(double& t, double a, double b, double c, Func accept)
+{
+	if (std::abs(a) < 1.0e-12) return false;
+
+	double disc = b*b - a*c;
+	if (disc < 0.0) return false;
+
+	double sq = std::sqrt(disc);
+	double t1 = (-b - sq) / a;
+	double t2 = (-b + sq) / a;
+	if (t1 > t2) std::swap(t1, t2);
+
+	if (t1 >= 0.0 && accept(t1)) { t = t1; return true; }
+	if (t2 >= 0.0 && accept(t2)) { t = t2; return true; }
+	return false;
+}
+
+void keepNearest(bool& hit, double& t, bool h, double th)
+{
+	if (h && (!hit || th < t)) {
+		t = th;
+		hit = true;
+	}
+}
+
+}
+
+bool calcIntersectionRayAndSphere(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& center, double radius
+		)
+{
+	Eigen::Vector3d m(origin - center);
+	return nearestRoot(t, dir.dot(dir), m.dot(dir), m.dot(m) - radius*radius, [](double){ return true; });
+}
+
+bool calcIntersectionRayAndCapsule(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& p1, const Eigen::Vector3d& p2, double radius
+		)
+{
+	Eigen::Vector3d ba(p2 - p1);
+	Eigen::Vector3d oa(origin - p1);
+	double baba = ba.dot(ba);
+	if (baba < 1.0e-12) return calcIntersectionRayAndSphere(t, origin, dir, p1, radius);
+
+	// body. components perpendicular to the axis
+	Eigen::Vector3d d(dir - (ba.dot(dir) / baba) * ba);
+	Eigen::Vector3d o(oa - (ba.dot(oa) / baba) * ba);
+
+	bool hit = false;
+	double th;
+	bool h = nearestRoot(th, d.dot(d), o.dot(d), o.dot(o) - radius*radius, [&](double tt){
+		double y = ba.dot(oa + tt * dir);
+		return y >= 0.0 && y <= baba;
+	});
+	keepNearest(hit, t, h, th);
+
+	// caps
+	h = calcIntersectionRayAndSphere(th, origin, dir, p1, radius);
+	keepNearest(hit, t, h, th);
+	h = calcIntersectionRayAndSphere(th, origin, dir, p2, radius);
+	keepNearest(hit, t, h, th);
+
+	return hit;
+}
+
+bool calcIntersectionRayAndCone(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& base_p, const Eigen::Vector3d& apex_p, double radius
+		)
+{
+	Eigen::Vector3d v(base_p - apex_p);
+	double height = v.norm();
+	if (height < 1.0e-12) return false;
+	v /= height;
+
+	// side. |(p - apex) x v| = tan * (p - apex).v
+	double cos2 = height*height / (height*height + radius*radius);
+	Eigen::Vector3d co(origin - apex_p);
+	double dv = dir.dot(v);
+	double cov = co.dot(v);
+
+	bool hit = false;
+	double th;
+	bool h = nearestRoot(th, dv*dv - dir.dot(dir)*cos2, dv*cov - dir.dot(co)*cos2, cov*cov - co.dot(co)*cos2, [&](double tt){
+		double y = cov + tt * dv;
+		return y >= 0.0 && y <= height;
+	});
+	keepNearest(hit, t, h, th);
+
+	// base disk
+	if (std::abs(dv) > 1.0e-12) {
+		th = (base_p - origin).dot(v) / dv;
+		h = th >= 0.0 && (origin + th * dir - base_p).squaredNorm() <= radius*radius;
+		keepNearest(hit, t, h, th);
+	}
+
+	return hit;
+}
+
+bool calcIntersectionRayAndQuad(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& corner, const Eigen::Vector3d& edge1, const Eigen::Vector3d& edge2
+		)
+{
+	Eigen::Vector3d n(edge1.cross(edge2));
+	double nn = n.dot(n);
+	double dn = dir.dot(n);
+	if (nn < 1.0e-24 || std::abs(dn) < 1.0e-12) return false;
+
+	double th = (corner - origin).dot(n) / dn;
+	if (th < 0.0) return false;
+
+	// p = u * edge1 + v * edge2
+	Eigen::Vector3d p(origin + th * dir - corner);
+	double u = p.cross(edge2).dot(n) / nn;
+	double v = edge1.cross(p).dot(n) / nn;
+	if (u < 0.0 || u > 1.0 || v < 0.0 || v > 1.0) return false;
+
+	t = th;
+	return true;
+}
+
+bool calcIntersectionRayAndTorus(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& center, const Eigen::Vector3d& normal, double radius, double tube_radius
+		)
+{
+	// bounding sphere
+	double th;
+	if (!calcIntersectionRayAndSphere(th, origin, dir, center, radius + tube_radius)) return false;
+
+	// basis of the ring plane
+	Eigen::Vector3d n(normal.normalized());
+	Eigen::Vector3d u(n.unitOrthogonal());
+	Eigen::Vector3d v(n.cross(u));
+
+	const int segments = 64;
+	bool hit = false;
+	Eigen::Vector3d p1(center + radius * u);
+	for (int i = 1; i <= segments; ++i) {
+		double a = 2.0 * M_PI * i / segments;
+		Eigen::Vector3d p2(center + radius * (std::cos(a) * u + std::sin(a) * v));
+		bool h = calcIntersectionRayAndCapsule(th, origin, dir, p1, p2, tube_radius);
+		keepNearest(hit, t, h, th);
+		p1 = p2;
+	}
+
+	return hit;
+}
+
+bool calcIntersectionRayAndBox(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& center, const Eigen::Matrix3d& R, const Eigen::Vector3d& sides
+		)
+{
+	// slabs in the box frame
+	Eigen::Vector3d o(R.transpose() * (origin - center));
+	Eigen::Vector3d d(R.transpose() * dir);
+
+	double tmin = -std::numeric_limits<double>::max();
+	double tmax = std::numeric_limits<double>::max();
+	for (int i = 0; i < 3; ++i) {
+		double half = 0.5 * sides(i);
+		if (std::abs(d(i)) < 1.0e-12) {
+			if (std::abs(o(i)) > half) return false;
+			continue;
+		}
+		double t1 = (-half - o(i)) / d(i);
+		double t2 = (half - o(i)) / d(i);
+		if (t1 > t2) std::swap(t1, t2);
+		tmin = std::max(tmin, t1);
+		tmax = std::min(tmax, t2);
+		if (tmin > tmax) return false;
+	}
+
+	if (tmax < 0.0) return false;
+	t = tmin >= 0.0 ? tmin : tmax;
+	return true;
+}
+
 }
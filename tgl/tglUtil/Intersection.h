@@ -27,6 +27,43 @@ bool calcIntersectionLineAndSphere(Eigen::Vector3d& intersection_p,
 		const Eigen::Vector3d& sphere_p, double radius
 		);
 
+// ray : origin + t * dir (t >= 0)
+// t : nearest hit. false if the ray misses
+bool calcIntersectionRayAndSphere(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& center, double radius
+		);
+
+// segment p1-p2 with radius
+bool calcIntersectionRayAndCapsule(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& p1, const Eigen::Vector3d& p2, double radius
+		);
+
+// solid cone. base disk at base_p with radius, apex at apex_p
+bool calcIntersectionRayAndCone(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& base_p, const Eigen::Vector3d& apex_p, double radius
+		);
+
+// parallelogram corner, corner + edge1, corner + edge1 + edge2, corner + edge2. both sides
+bool calcIntersectionRayAndQuad(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& corner, const Eigen::Vector3d& edge1, const Eigen::Vector3d& edge2
+		);
+
+// torus (ring) around normal. the tube is approximated by capsules along the ring
+bool calcIntersectionRayAndTorus(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& center, const Eigen::Vector3d& normal, double radius, double tube_radius
+		);
+
+// oriented box, center and full side lengths in the R frame
+bool calcIntersectionRayAndBox(double& t,
+		const Eigen::Vector3d& origin, const Eigen::Vector3d& dir,
+		const Eigen::Vector3d& center, const Eigen::Matrix3d& R, const Eigen::Vector3d& sides
+		);
+
 }
 
 #endif /* INTERSECTION_H_ */
@@ -0,0 +1,140 @@
+/*
+ * RectQuadTree.cpp
+ */
+
+#include <algorithm>
+#include "RectQuadTree.h"
+
+namespace tgl
+{
+
+namespace {
+bool inside(const RectQuadTree::Rect& outer, const RectQuadTree::Rect& inner)
+{
+	return inner.x >= outer.x && inner.y >= outer.y
+			&& inner.x + inner.width <= outer.x + outer.width
+			&& inner.y + inner.height <= outer.y + outer.height;
+}
+}
+
+RectQuadTree::RectQuadTree(int maxDepth, int maxItems)
+	: maxDepth_(maxDepth), maxItems_(maxItems)
+{
+
+}
+
+void RectQuadTree::clear()
+{
+	rects_.clear();
+	nodes_.clear();
+	items_.clear();
+}
+
+void RectQuadTree::build(const std::vector<Rect>& rects)
+{
+	clear();
+	rects_ = rects;
+	if (rects_.empty()) return;
+
+	// root bounds
+	int x1 = rects_[0].x, y1 = rects_[0].y;
+	int x2 = x1 + rects_[0].width, y2 = y1 + rects_[0].height;
+	std::vector<int> items;
+	items.reserve(rects_.size());
+	for (size_t i = 0; i < rects_.size(); ++i) {
+		const Rect& r = rects_[i];
+		x1 = std::min(x1, r.x);
+		y1 = std::min(y1, r.y);
+		x2 = std::max(x2, r.x + r.width);
+		y2 = std::max(y2, r.y + r.height);
+		items.push_back(static_cast<int>(i));
+	}
+
+	Node root;
+	root.bounds.x = x1;
+	root.bounds.y = y1;
+	root.bounds.width = x2 - x1;
+	root.bounds.height = y2 - y1;
+	root.child = -1;
+	root.first = 0;
+	root.count = 0;
+	nodes_.push_back(root);
+
+	items_.reserve(rects_.size());
+	buildNode(0, items, 0);
+}
+
+void RectQuadTree::buildNode(int node, std::vector<int>& items, int depth)
+{
+	const Rect b = nodes_[node].bounds;
+
+	if (static_cast<int>(items.size()) <= maxItems_ || depth >= maxDepth_ || b.width < 2 || b.height < 2) {
+		nodes_[node].first = static_cast<int>(items_.size());
+		nodes_[node].count = static_cast<int>(items.size());
+		items_.insert(items_.end(), items.begin(), items.end());
+		return;
+	}
+
+	const int hw = b.width / 2;
+	const int hh = b.height / 2;
+	const Rect quads[4] = {
+		{b.x,      b.y,      hw,           hh},
+		{b.x + hw, b.y,      b.width - hw, hh},
+		{b.x,      b.y + hh, hw,           b.height - hh},
+		{b.x + hw, b.y + hh, b.width - hw, b.height - hh},
+	};
+
+	std::vector<int> childItems[4];
+	std::vector<int> own;
+	for (int i : items) {
+		int q = 0;
+		while (q < 4 && !inside(quads[q], rects_[i])) ++q;
+		if (q < 4) childItems[q].push_back(i);
+		else own.push_back(i);
+	}
+
+	nodes_[node].first = static_cast<int>(items_.size());
+	nodes_[node].count = static_cast<int>(own.size());
+	items_.insert(items_.end(), own.begin(), own.end());
+
+	const int child = static_cast<int>(nodes_.size());
+	nodes_[node].child = child;
+	for (int q = 0; q < 4; ++q) {
+		Node n;
+		n.bounds = quads[q];
+		n.child = -1;
+		n.first = 0;
+		n.count = 0;
+		nodes_.push_back(n);
+	}
+
+	for (int q = 0; q < 4; ++q) {
+		buildNode(child + q, childItems[q], depth + 1);
+	}
+}
+
+void RectQuadTree::query(int x, int y, std::vector<int>& indices) const
+{
+	indices.clear();
+	if (nodes_.empty() || !nodes_[0].bounds.contains(x, y)) return;
+
+	int node = 0;
+	while (node >= 0) {
+		const Node& n = nodes_[node];
+		for (int i = n.first; i < n.first + n.count; ++i) {
+			if (rects_[items_[i]].contains(x, y)) indices.push_back(items_[i]);
+		}
+
+		if (n.child < 0) break;
+
+		// the children cover the node, exactly one contains the point
+		const int hw = n.bounds.width / 2;
+		const int hh = n.bounds.height / 2;
+		const int q = (x >= n.bounds.x + hw ? 1 : 0) + (y >= n.bounds.y + hh ? 2 : 0);
+		node = n.child + q;
+	}
+
+	std::sort(indices.begin(), indices.end());
+}
+
+}
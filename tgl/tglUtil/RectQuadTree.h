@@ -0,0 +1,59 @@
+/*
+ * RectQuadTree.h
+ */
+
+#ifndef TGL_UTIL_RECTQUADTREE_H_
+#define TGL_UTIL_RECTQUADTREE_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace tgl
+{
+
+// Static quadtree of integer rectangles for point queries.
+// rectangles are identified by their index in build(). a rectangle straddling
+// the split lines stays in the node, so each rectangle is stored once.
+class RectQuadTree
+{
+public:
+	struct Rect {
+		int x, y, width, height;
+
+		bool contains(int px, int py) const {
+			return px >= x && py >= y && px < x + width && py < y + height;
+		}
+	};
+
+	RectQuadTree(int maxDepth = 8, int maxItems = 4);
+
+	void clear();
+	void build(const std::vector<Rect>& rects);
+
+	// indices of the rectangles containing (x, y), in ascending order
+	void query(int x, int y, std::vector<int>& indices) const;
+
+	size_t size() const { return rects_.size(); }
+	bool empty() const { return rects_.empty(); }
+
+private:
+	struct Node {
+		Rect bounds;
+		int child;			// index of the first of 4 children, -1 for a leaf
+		int first;			// range in items_
+		int count;
+	};
+
+	void buildNode(int node, std::vector<int>& items, int depth);
+
+	int maxDepth_;
+	int maxItems_;
+
+	std::vector<Rect> rects_;
+	std::vector<Node> nodes_;
+	std::vector<int> items_;
+};
+
+}
+
+#endif /* TGL_UTIL_RECTQUADTREE_H_ */
@@ -0,0 +1,114 @@
+/*
+ * SE3Group.cpp
+ */
+
+#include "SE3Group.h"
+
+namespace tgl {
+
+// one member, reads and writes the arrays of the group
+class SE3Group::Member : public SE3 {
+public:
+	Member(DataPtr data, size_t index) : data_(data), index_(index) {}
+
+	virtual void setPosition(const Eigen::Vector3d& p) { data_->positions[index_] = p; }
+	virtual void setAttitude(const Eigen::Matrix3d& R) { data_->attitudes[index_] = R; }
+
+	virtual const Eigen::Vector3d& position() const { return data_->positions[index_]; }
+	virtual const Eigen::Matrix3d& attitude() const { return data_->attitudes[index_]; }
+
+private:
+	DataPtr data_;	// keeps the arrays alive after the group
+	size_t index_;
+};
+
+// moving the pivot moves the members
+class SE3Group::Pivot : public SE3 {
+public:
+	Pivot(SE3Group* group) : group_(group) {}
+
+	virtual void setPosition(const Eigen::Vector3d& p) {
+		if (group_) group_->transform(Eigen::Matrix3d::Identity(), p_, p - p_);
+		p_ = p;
+	}
+
+	virtual void setAttitude(const Eigen::Matrix3d& R) {
+		if (group_) group_->transform(R * R_.transpose(), p_, Eigen::Vector3d::Zero());
+		R_ = R;
+	}
+
+	void place(const Eigen::Vector3d& p, const Eigen::Matrix3d& R) {
+		p_ = p;
+		R_ = R;
+	}
+
+	SE3Group* group_;
+};
+
+SE3Group::SE3Group()
+{
+	data_ = std::make_shared<Data>();
+	pivot_ = std::make_shared<Pivot>(this);
+	changeNotifier_.setCallback([this](){ sigChanged_(); });
+}
+
+SE3Group::~SE3Group()
+{
+	pivot_->group_ = nullptr;	// the pivot may outlive the group in a handle
+}
+
+SE3Ptr SE3Group::add(const Eigen::Vector3d& p, const Eigen::Matrix3d& R)
+{
+	data_->positions.push_back(p);
+	data_->attitudes.push_back(R);
+	return std::make_shared<Member>(data_, data_->positions.size() - 1);
+}
+
+void SE3Group::clear()
+{
+	// members handed out keep the old arrays
+	data_ = std::make_shared<Data>();
+}
+
+SE3Ptr SE3Group::pivot() const
+{
+	return pivot_;
+}
+
+void SE3Group::setPivot(const Eigen::Vector3d& p, const Eigen::Matrix3d& R)
+{
+	pivot_->place(p, R);
+}
+
+void SE3Group::centerPivot()
+{
+	Eigen::Vector3d c(Eigen::Vector3d::Zero());
+	if (size() > 0) {
+		Eigen::Map<const Eigen::Matrix3Xd> P(positionData(), 3, size());
+		c = P.rowwise().mean();
+	}
+	pivot_->place(c, Eigen::Matrix3d::Identity());
+}
+
+void SE3Group::transform(const Eigen::Matrix3d& dR, const Eigen::Vector3d& center, const Eigen::Vector3d& dp)
+{
+	const size_t n = size();
+	if (n == 0) return;
+
+	Eigen::Map<Eigen::Matrix3Xd> P(data_->positions[0].data(), 3, n);
+	if (dR.isIdentity(0.0)) {
+		P.colwise() += dp;
+	} else {
+		const Eigen::Vector3d t(center + dp - dR * center);
+		P = dR * P;
+		P.colwise() += t;
+
+		// all attitudes side by side, 3 x 3n
+		Eigen::Map<Eigen::Matrix3Xd> A(data_->attitudes[0].data(), 3, 3 * n);
+		A = dR * A;
+	}
+
+	changeNotifier_.notify();
+}
+
+} /* namespace tgl */
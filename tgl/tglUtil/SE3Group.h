@@ -0,0 +1,73 @@
+/*
+ * SE3Group.h
+ */
+
+#ifndef TGL_UTIL_SE3GROUP_H_
+#define TGL_UTIL_SE3GROUP_H_
+
+#include <memory>
+#include <vector>
+#include <boost/signals2.hpp>
+#include "SE3.h"
+#include "ChangeNotifier.h"
+
+namespace tgl {
+
+class SE3Group;
+typedef std::shared_ptr<SE3Group> SE3GroupPtr;
+
+// Poses of many objects in contiguous arrays, moved together about a pivot.
+// pivot() is an SE3 to give to a handle (TranslateHandle::set, RotateHandle::set).
+// moving the pivot transforms every member in one batched operation, and
+// sigChanged() is emitted once by flush() however many times the pivot moved
+class SE3Group {
+public:
+	SE3Group();
+	virtual ~SE3Group();
+
+	// member SE3 is a view into the arrays of the group
+	SE3Ptr add(const Eigen::Vector3d& p, const Eigen::Matrix3d& R = Eigen::Matrix3d::Identity());
+	void clear();
+	size_t size() const { return data_->positions.size(); }
+
+	const Eigen::Vector3d& position(size_t i) const { return data_->positions[i]; }
+	const Eigen::Matrix3d& attitude(size_t i) const { return data_->attitudes[i]; }
+
+	// contiguous x,y,z / column major 3x3 per member, for renderers and batch consumers
+	const double* positionData() const { return data_->positions.empty() ? nullptr : data_->positions[0].data(); }
+	const double* attitudeData() const { return data_->attitudes.empty() ? nullptr : data_->attitudes[0].data(); }
+
+	SE3Ptr pivot() const;
+	// place the pivot without moving members
+	void setPivot(const Eigen::Vector3d& p, const Eigen::Matrix3d& R = Eigen::Matrix3d::Identity());
+	void centerPivot();	// centroid of the members
+
+	// x' = dR (x - center) + center + dp for every member
+	void transform(const Eigen::Matrix3d& dR, const Eigen::Vector3d& center, const Eigen::Vector3d& dp);
+
+	// emit sigChanged once if members moved since the last flush. call once per frame
+	void flush() { changeNotifier_.flush(); }
+	bool isChanged() const { return changeNotifier_.isPending(); }
+
+	boost::signals2::signal<void ()>& sigChanged() { return sigChanged_; }
+
+private:
+	struct Data {
+		std::vector<Eigen::Vector3d> positions;
+		std::vector<Eigen::Matrix3d> attitudes;
+	};
+	typedef std::shared_ptr<Data> DataPtr;
+
+	class Member;
+	class Pivot;
+
+	DataPtr data_;
+	std::shared_ptr<Pivot> pivot_;
+	ChangeNotifier changeNotifier_;
+
+	boost::signals2::signal<void ()> sigChanged_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_UTIL_SE3GROUP_H_ */
@@ -0,0 +1,153 @@
+/*
+ * ThreadPool.cpp
+ */
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <exception>
+#include "ThreadPool.h"
+
+namespace tgl {
+
+ThreadPool::ThreadPool(int numThreads)
+{
+	stop_ = false;
+
+	if (numThreads <= 0) {
+		numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+	for (int i = 0; i < numThreads; ++i) {
+		threads_.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	condition_.notify_all();
+	for (auto& thread : threads_) {
+		thread.join();
+	}
+}
+
+ThreadPool& ThreadPool::instance()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+std::future<void> ThreadPool::enqueue(Task task)
+{
+	std::packaged_task<void ()> packaged(task);
+	std::future<void> future = packaged.get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push_back(std::move(packaged));
+	}
+	condition_.notify_one();
+	return future;
+}
+
+namespace {
+
+// chunks of one parallelFor() call, shared with the helper tasks which may outlive the call
+struct ParallelForState {
+	std::function<void (size_t, size_t)> func;
+	size_t n;
+	size_t chunk;
+	size_t numChunks;
+	std::atomic<size_t> next;		// next chunk to take, may exceed numChunks
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	size_t finished;		// run or skipped
+	std::exception_ptr error;
+
+	void finish(size_t count)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished += count;
+		if (finished == numChunks) condition.notify_all();
+	}
+
+	// skips the chunks nobody has taken yet
+	void cancel(std::exception_ptr e)
+	{
+		const size_t taken = next.exchange(numChunks);
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!error) error = e;
+		if (taken < numChunks) {
+			finished += numChunks - taken;
+			if (finished == numChunks) condition.notify_all();
+		}
+	}
+
+	// runs chunks until none is left
+	void run()
+	{
+		for (;;) {
+			const size_t i = next.fetch_add(1);
+			if (i >= numChunks) return;
+
+			try {
+				const size_t begin = i * chunk;
+				if (begin < n) func(begin, std::min(n, begin + chunk));
+			} catch (...) {
+				cancel(std::current_exception());
+			}
+			finish(1);
+		}
+	}
+};
+
+}
+
+void ThreadPool::parallelFor(size_t n, size_t grain, std::function<void (size_t, size_t)> func)
+{
+	if (n == 0) return;
+
+	grain = std::max<size_t>(grain, 1);
+	const size_t numChunks = std::min(static_cast<size_t>(numThreads()) + 1, (n + grain - 1) / grain);
+
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->func = func;
+	state->n = n;
+	state->numChunks = numChunks;
+	state->chunk = (n + numChunks - 1) / numChunks;
+	state->next = 0;
+	state->finished = 0;
+
+	// a helper started after the caller took the last chunk returns at once
+	for (size_t i = 1; i < numChunks; ++i) {
+		enqueue([state](){ state->run(); });
+	}
+	state->run();
+
+	// only chunks of this call are waited for
+	{
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->condition.wait(lock, [&](){ return state->finished == state->numChunks; });
+	}
+	if (state->error) std::rethrow_exception(state->error);
+}
+
+void ThreadPool::workerLoop()
+{
+	for (;;) {
+		std::packaged_task<void ()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this](){ return stop_ || !tasks_.empty(); });
+			if (stop_ && tasks_.empty()) return;
+			task = std::move(tasks_.front());
+			tasks_.pop_front();
+		}
+		task();
+	}
+}
+
+} /* namespace tgl */
@@ -0,0 +1,56 @@
+/*
+ * ThreadPool.h
+ */
+
+#ifndef TGL_UTIL_THREADPOOL_H_
+#define TGL_UTIL_THREADPOOL_H_
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace tgl {
+
+// Fixed number of worker threads over one task queue.
+// parallelFor() splits a range into chunks taken by idle workers and by the calling thread,
+// the caller only runs chunks of its own call, so it may be used from inside a task
+class ThreadPool {
+public:
+	typedef std::function<void ()> Task;
+
+	// numThreads <= 0 : hardware concurrency
+	explicit ThreadPool(int numThreads = 0);
+	virtual ~ThreadPool();
+
+	// shared by the library (mesh loading, resource loading)
+	static ThreadPool& instance();
+
+	int numThreads() const { return static_cast<int>(threads_.size()); }
+
+	std::future<void> enqueue(Task task);
+
+	// func(begin, end) over [0, n) in chunks of at least grain, returns when all are done.
+	// the calling thread takes the chunks no worker has started. if func throws, chunks not
+	// yet started are skipped and the first exception is rethrown after the running ones end
+	void parallelFor(size_t n, size_t grain, std::function<void (size_t, size_t)> func);
+
+private:
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void workerLoop();
+
+	std::vector<std::thread> threads_;
+	std::deque<std::packaged_task<void ()>> tasks_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	bool stop_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_UTIL_THREADPOOL_H_ */
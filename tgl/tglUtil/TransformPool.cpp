@@ -0,0 +1,137 @@
+/*
+ * TransformPool.cpp
+ */
+
+#include "TransformPool.h"
+
+namespace tgl {
+
+const uint32_t TransformPool::Handle::invalidSlot;
+const uint32_t TransformPool::invalidIndex;
+
+TransformPool::TransformPool()
+{
+	quaternionEnabled_ = false;
+	generation_ = 0;
+	layoutGeneration_ = 0;
+}
+
+TransformPool::~TransformPool()
+{
+
+}
+
+TransformPool::Handle TransformPool::create(const Eigen::Vector3d& p, const Eigen::Matrix3d& R)
+{
+	uint32_t slot;
+	if (freeSlots_.empty()) {
+		slot = static_cast<uint32_t>(slots_.size());
+		Slot s = {invalidIndex, 0};
+		slots_.push_back(s);
+	} else {
+		slot = freeSlots_.back();
+		freeSlots_.pop_back();
+	}
+
+	const uint32_t index = static_cast<uint32_t>(positions_.size());
+	positions_.push_back(p);
+	attitudes_.push_back(R);
+	if (quaternionEnabled_) quaternions_.push_back(Eigen::Quaterniond(R));
+	modified_.push_back(++generation_);
+	denseToSlot_.push_back(slot);
+	layoutGeneration_ = generation_;
+
+	slots_[slot].index = index;
+
+	Handle h;
+	h.slot = slot;
+	h.generation = slots_[slot].generation;
+	return h;
+}
+
+void TransformPool::destroy(Handle h)
+{
+	if (!isValid(h)) return;
+
+	// move the last pose into the hole
+	const uint32_t index = slots_[h.slot].index;
+	const uint32_t last = static_cast<uint32_t>(positions_.size() - 1);
+	if (index != last) {
+		positions_[index] = positions_[last];
+		attitudes_[index] = attitudes_[last];
+		if (quaternionEnabled_) quaternions_[index] = quaternions_[last];
+		denseToSlot_[index] = denseToSlot_[last];
+		slots_[denseToSlot_[index]].index = index;
+	}
+	positions_.pop_back();
+	attitudes_.pop_back();
+	if (quaternionEnabled_) quaternions_.pop_back();
+	modified_.pop_back();
+	denseToSlot_.pop_back();
+
+	++generation_;
+	if (index != last) modified_[index] = generation_;
+	layoutGeneration_ = generation_;
+
+	slots_[h.slot].index = invalidIndex;
+	++slots_[h.slot].generation;
+	freeSlots_.push_back(h.slot);
+}
+
+void TransformPool::clear()
+{
+	for (uint32_t slot : denseToSlot_) {
+		slots_[slot].index = invalidIndex;
+		++slots_[slot].generation;
+		freeSlots_.push_back(slot);
+	}
+
+	positions_.clear();
+	attitudes_.clear();
+	quaternions_.clear();
+	modified_.clear();
+	denseToSlot_.clear();
+
+	layoutGeneration_ = ++generation_;
+}
+
+void TransformPool::reserve(size_t n)
+{
+	positions_.reserve(n);
+	attitudes_.reserve(n);
+	if (quaternionEnabled_) quaternions_.reserve(n);
+	modified_.reserve(n);
+	denseToSlot_.reserve(n);
+	slots_.reserve(n);
+}
+
+TransformPool::Handle TransformPool::handleAt(size_t index) const
+{
+	Handle h;
+	h.slot = denseToSlot_[index];
+	h.generation = slots_[h.slot].generation;
+	return h;
+}
+
+void TransformPool::setAttitudeAt(size_t index, const Eigen::Matrix3d& R)
+{
+	attitudes_[index] = R;
+	if (quaternionEnabled_) quaternions_[index] = Eigen::Quaterniond(R);
+	modified_[index] = ++generation_;
+}
+
+void TransformPool::setQuaternionEnabled(bool on)
+{
+	if (on == quaternionEnabled_) return;
+	quaternionEnabled_ = on;
+
+	quaternions_.clear();
+	if (on) {
+		quaternions_.reserve(attitudes_.capacity());
+		for (const Eigen::Matrix3d& R : attitudes_) {
+			quaternions_.push_back(Eigen::Quaterniond(R));
+		}
+	}
+}
+
+} /* namespace tgl */
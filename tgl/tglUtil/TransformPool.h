@@ -0,0 +1,134 @@
+/*
+ * TransformPool.h
+ */
+
+#ifndef TGL_UTIL_TRANSFORMPOOL_H_
+#define TGL_UTIL_TRANSFORMPOOL_H_
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include "SE3.h"
+
+namespace tgl {
+
+class TransformPool;
+class PooledSE3;
+typedef std::shared_ptr<TransformPool> TransformPoolPtr;
+typedef std::shared_ptr<PooledSE3> PooledSE3Ptr;
+
+// Poses of many rigid bodies in dense arrays.
+// a handle stays valid until destroy(), while the dense index of a pose may change
+// (the last pose is moved into the hole). stale handles are detected by generation.
+// every write stamps the pose with a new generation, so a consumer that remembers
+// generation() can upload only what changed since
+class TransformPool {
+public:
+	struct Handle {
+		Handle() : slot(invalidSlot), generation(0) {}
+		bool operator==(const Handle& h) const { return slot == h.slot && generation == h.generation; }
+		bool operator!=(const Handle& h) const { return !(*this == h); }
+
+		static const uint32_t invalidSlot = 0xffffffff;
+		uint32_t slot;
+		uint32_t generation;
+	};
+
+	TransformPool();
+	virtual ~TransformPool();
+
+	Handle create(const Eigen::Vector3d& p = Eigen::Vector3d::Zero(), const Eigen::Matrix3d& R = Eigen::Matrix3d::Identity());
+	void destroy(Handle h);
+	bool isValid(Handle h) const {
+		return h.slot < slots_.size() && slots_[h.slot].generation == h.generation && slots_[h.slot].index != invalidIndex;
+	}
+	void clear();
+	void reserve(size_t n);
+	size_t size() const { return positions_.size(); }
+
+	// dense index of a valid handle, and back
+	size_t indexOf(Handle h) const { return slots_[h.slot].index; }
+	Handle handleAt(size_t index) const;
+
+	void setPosition(Handle h, const Eigen::Vector3d& p) { setPositionAt(indexOf(h), p); }
+	void setAttitude(Handle h, const Eigen::Matrix3d& R) { setAttitudeAt(indexOf(h), R); }
+	const Eigen::Vector3d& position(Handle h) const { return positions_[indexOf(h)]; }
+	const Eigen::Matrix3d& attitude(Handle h) const { return attitudes_[indexOf(h)]; }
+
+	void setPositionAt(size_t index, const Eigen::Vector3d& p) {
+		positions_[index] = p;
+		modified_[index] = ++generation_;
+	}
+	void setAttitudeAt(size_t index, const Eigen::Matrix3d& R);
+	const Eigen::Vector3d& positionAt(size_t index) const { return positions_[index]; }
+	const Eigen::Matrix3d& attitudeAt(size_t index) const { return attitudes_[index]; }
+
+	// quaternions kept next to the matrices, for shaders that want 4 floats instead of 9
+	void setQuaternionEnabled(bool on);
+	bool isQuaternionEnabled() const { return quaternionEnabled_; }
+	const Eigen::Quaterniond& quaternionAt(size_t index) const { return quaternions_[index]; }
+
+	// contiguous arrays, in dense order
+	// x,y,z per pose / column major 3x3 per pose / x,y,z,w per pose (if enabled)
+	const double* positionData() const { return positions_.empty() ? nullptr : positions_[0].data(); }
+	const double* attitudeData() const { return attitudes_.empty() ? nullptr : attitudes_[0].data(); }
+	const double* quaternionData() const { return quaternions_.empty() ? nullptr : quaternions_[0].coeffs().data(); }
+
+	// generation of the last write to any pose
+	uint64_t generation() const { return generation_; }
+	// generation of the last create / destroy. the dense order changed, upload all
+	uint64_t layoutGeneration() const { return layoutGeneration_; }
+	bool isModifiedSince(size_t index, uint64_t generation) const { return modified_[index] > generation; }
+	const uint64_t* modifiedData() const { return modified_.empty() ? nullptr : &modified_[0]; }
+
+private:
+	static const uint32_t invalidIndex = 0xffffffff;
+
+	struct Slot {
+		uint32_t index;	// dense index, invalidIndex if free
+		uint32_t generation;
+	};
+
+	std::vector<Eigen::Vector3d> positions_;
+	std::vector<Eigen::Matrix3d> attitudes_;
+	std::vector<Eigen::Quaterniond, Eigen::aligned_allocator<Eigen::Quaterniond> > quaternions_;
+	std::vector<uint64_t> modified_;
+	std::vector<uint32_t> denseToSlot_;
+
+	std::vector<Slot> slots_;
+	std::vector<uint32_t> freeSlots_;
+
+	bool quaternionEnabled_;
+	uint64_t generation_;
+	uint64_t layoutGeneration_;
+};
+
+// SE3 view of one pose in a pool, for handles and other SE3Ptr users
+class PooledSE3 : public SE3 {
+public:
+	PooledSE3(TransformPoolPtr pool, TransformPool::Handle handle) : pool_(pool), handle_(handle) {}
+
+	virtual void setPosition(const Eigen::Vector3d& p) {
+		if (pool_->isValid(handle_)) pool_->setPosition(handle_, p);
+	}
+	virtual void setAttitude(const Eigen::Matrix3d& R) {
+		if (pool_->isValid(handle_)) pool_->setAttitude(handle_, R);
+	}
+
+	// identity once the pose is destroyed
+	virtual const Eigen::Vector3d& position() const { return pool_->isValid(handle_) ? pool_->position(handle_) : p_; }
+	virtual const Eigen::Matrix3d& attitude() const { return pool_->isValid(handle_) ? pool_->attitude(handle_) : R_; }
+
+	const TransformPoolPtr pool() const { return pool_; }
+	TransformPool::Handle handle() const { return handle_; }
+
+private:
+	TransformPoolPtr pool_;
+	TransformPool::Handle handle_;
+};
+
+} /* namespace tgl */
+
+#endif /* TGL_UTIL_TRANSFORMPOOL_H_ */